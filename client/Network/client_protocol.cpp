@@ -9,7 +9,7 @@ Q_LOGGING_CATEGORY(NetClientLog, "net.client")
 
 Protocol_Base::Protocol_Base(Worker* worker, const Authentication_Info &auth_info) :
     Helpz::Net::Protocol{},
-    worker_(worker), auth_info_(auth_info)
+    log_pack_compression_(false), worker_(worker), auth_info_(auth_info)
 {
 }
 
@@ -23,5 +23,15 @@ const Authentication_Info &Protocol_Base::auth_info() const
     return auth_info_;
 }
 
+bool Protocol_Base::log_pack_compression() const
+{
+    return log_pack_compression_;
+}
+
+void Protocol_Base::set_log_pack_compression(bool state)
+{
+    log_pack_compression_ = state;
+}
+
 } // namespace Client
 } // namespace Das
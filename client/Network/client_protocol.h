@@ -25,7 +25,12 @@ public:
 
     const Authentication_Info& auth_info() const;
 
+    // Log packs are sent compressed if server supports it (das/2.7)
+    bool log_pack_compression() const;
+    void set_log_pack_compression(bool state);
+
 private:
+    bool log_pack_compression_;
     Worker *worker_;
     Authentication_Info auth_info_;
 };
@@ -8,6 +8,7 @@
 
 #include <Das/commands.h>
 #include <Das/lib.h>
+#include <Das/blob_store.h>
 
 #include "worker.h"
 #include "client_protocol_latest.h"
@@ -193,6 +194,8 @@ void Protocol::process_message(uint8_t msg_id, uint8_t cmd, QIODevice &data_dev)
     }
 
     case Cmd::LOG_DATA_REQUEST:         Helpz::apply_parse(data_dev, DATASTREAM_VERSION, &Log_Sender::send_data, &log_sender_, msg_id);    break;
+    case Cmd::BLOB_REQUEST:             apply_parse(data_dev, &Protocol::send_blob_chunk, msg_id);          break;
+    case Cmd::BLOB_STORED:              apply_parse(data_dev, &Protocol::blob_stored);                      break;
 
     case Cmd::DEVICE_ITEM_VALUES:
     {
@@ -246,6 +249,21 @@ void Protocol::toggle_stream(uint32_t user_id, uint32_t dev_item_id, bool state)
                               Q_ARG(uint32_t, user_id), Q_ARG(uint32_t, dev_item_id), Q_ARG(bool, state));
 }
 
+void Protocol::send_blob_chunk(const QByteArray& hash, qint64 offset, uint8_t msg_id)
+{
+    qint64 total_size;
+    const QByteArray data = Blob_Store::instance().read(hash, offset, total_size);
+    if (total_size < 0)
+        qCWarning(NetClientLog) << "Blob not found:" << hash.toHex();
+
+    send_answer(Cmd::BLOB_REQUEST, msg_id) << hash << offset << total_size << data;
+}
+
+void Protocol::blob_stored(const QByteArray& hash)
+{
+    Blob_Store::instance().set_acknowledged(hash);
+}
+
 void Protocol::process_item_file(QIODevice& data_dev)
 {
     if (!data_dev.isOpen())
@@ -58,6 +58,8 @@ private:
     void parse_script_command(uint32_t user_id, const QString& script, QIODevice* data_dev);
     void toggle_stream(uint32_t user_id, uint32_t dev_item_id, bool state);
     void process_item_file(QIODevice &data_dev);
+    void send_blob_chunk(const QByteArray& hash, qint64 offset, uint8_t msg_id);
+    void blob_stored(const QByteArray& hash);
 
     void start_authentication();
     void process_authentication(bool authorized, const QUuid &connection_id);
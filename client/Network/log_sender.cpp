@@ -1,6 +1,9 @@
+#include <algorithm>
+
 #include <Helpz/db_builder.h>
 
 #include <Das/commands.h>
+#include <Das/log/log_pack_codec.h>
 
 #include "worker.h"
 
@@ -13,7 +16,6 @@ namespace Client {
 using namespace Helpz::DB;
 
 Log_Sender::Log_Sender(Protocol_Base *protocol) :
-    request_data_size_(200),
     protocol_(protocol)
 {
 }
@@ -25,11 +27,11 @@ void Log_Sender::send_data(Log_Type_Wrapper log_type, uint8_t msg_id)
         protocol_->send_answer(Cmd::LOG_DATA_REQUEST, msg_id) << true;
 
         switch (log_type.value()) {
-        case LOG_VALUE:  send_log_data<Log_Value_Item>(log_type); break;
-        case LOG_EVENT:  send_log_data<Log_Event_Item>(log_type); break;
-        case LOG_PARAM:  send_log_data<Log_Param_Item>(log_type); break;
-        case LOG_STATUS: send_log_data<Log_Status_Item>(log_type); break;
-        case LOG_MODE:   send_log_data<Log_Mode_Item>(log_type); break;
+        case LOG_VALUE:  fill_window<Log_Value_Item>(log_type); break;
+        case LOG_EVENT:  fill_window<Log_Event_Item>(log_type); break;
+        case LOG_PARAM:  fill_window<Log_Param_Item>(log_type); break;
+        case LOG_STATUS: fill_window<Log_Status_Item>(log_type); break;
+        case LOG_MODE:   fill_window<Log_Mode_Item>(log_type); break;
         default:
             break;
         }
@@ -53,13 +55,59 @@ void prepare_pack<Log_Value_Item>(QVector<Log_Value_Item>& log_data)
 }
 
 template<typename T>
-void Log_Sender::send_log_data(const Log_Type_Wrapper& log_type)
+QString get_id_range_suffix(uint32_t first_id, uint32_t last_id)
 {
+    return DB::Helper::get_default_suffix() + " AND " + T::table_column_names().at(T::COL_id)
+            + " BETWEEN " + QString::number(first_id) + " AND " + QString::number(last_id);
+}
+
+QString get_not_in_flight_suffix(const QString& id_name, const std::map<uint32_t, uint32_t>& in_flight)
+{
+    QString suffix;
+    for (const auto& it: in_flight)
+        suffix += " AND " + id_name + " NOT BETWEEN " + QString::number(it.first) + " AND " + QString::number(it.second);
+    return suffix;
+}
+
+template<typename T>
+void Log_Sender::fill_window(const Log_Type_Wrapper& log_type)
+{
+    Type_State& state = state_[log_type.value()];
+    const QString id_name = T::table_column_names().at(T::COL_id);
+
     Base& db = Base::get_thread_local_instance();
-    QVector<T> log_data = db_build_list<T>(db, DB::Helper::get_default_where_suffix() + " LIMIT " + QString::number(request_data_size_));
-    if (!log_data.empty())
+
+    // Rows below cursor which isn't in flight is left after lost answer or rows is added with lower id,
+    // so sending continues from the lowest of them
+    QSqlQuery q = db.exec("SELECT MIN(" + id_name + ") FROM " + db_table_name<T>() + ' ' + DB::Helper::get_default_where_suffix()
+                          + " AND " + id_name + " <= " + QString::number(state.cursor_)
+                          + get_not_in_flight_suffix(id_name, state.in_flight_));
+    if (q.next() && !q.isNull(0))
+        state.cursor_ = q.value(0).toUInt() - 1;
+
+    while (state.in_flight_.size() < static_cast<std::size_t>(state.window_))
     {
+        // Pack must not cross in flight pack, because acknowledged pack is deleted by its id range
+        QString suffix = " AND " + id_name + " > " + QString::number(state.cursor_);
+        auto next_it = state.in_flight_.upper_bound(state.cursor_);
+        if (next_it != state.in_flight_.end())
+            suffix += " AND " + id_name + " < " + QString::number(next_it->first);
+
+        QVector<T> log_data = db_build_list<T>(db, DB::Helper::get_default_where_suffix() + suffix
+                                               + " ORDER BY " + id_name + " LIMIT " + QString::number(state.pack_size_));
+        if (log_data.empty())
+        {
+            if (next_it == state.in_flight_.end())
+                break;
+
+            // Gap before in flight pack is sent, continue after it
+            state.cursor_ = next_it->second;
+            continue;
+        }
+
         prepare_pack(log_data);
+        state.cursor_ = log_data.back().id();
+        state.in_flight_.emplace(log_data.front().id(), log_data.back().id());
         send_log_data(log_type, std::make_shared<QVector<T>>(std::move(log_data)));
     }
 }
@@ -67,26 +115,63 @@ void Log_Sender::send_log_data(const Log_Type_Wrapper& log_type)
 template<typename T>
 void Log_Sender::send_log_data(const Log_Type_Wrapper &log_type, std::shared_ptr<QVector<T>> log_data)
 {
-    protocol_->send(Cmd::LOG_DATA_REQUEST).answer([log_data](QIODevice& /*dev*/)
+    const uint32_t first_id = log_data->front().id();
+    const uint32_t last_id = log_data->back().id();
+
+    Helpz::Net::Protocol_Sender sender = protocol_->send(Cmd::LOG_DATA_REQUEST);
+    sender.answer([this, log_type, first_id, last_id](QIODevice& /*dev*/)
     {
-        QString where = DB::Helper::get_default_suffix() + " AND "
-                + T::table_column_names().at(T::COL_timestamp_msecs) + " IN (";
-        for (const T& item: *log_data)
-            where += QString::number(item.timestamp_msecs()) + ',';
-        where.replace(where.length() - 1, 1, ')');
-
-        Base& db = Base::get_thread_local_instance();
-        db.del(db_table_name<T>(), where);
+        process_ack<T>(log_type, first_id, last_id);
     })
     .timeout([this, log_type, log_data]()
     {
-//            qWarning(Sync_Log) << log_type.to_string() << "log send timeout. request_data_size_:" << request_data_size_;
-        request_data_size_ /= 2;
-        if (request_data_size_ < 5)
-            request_data_size_ = 5;
+        process_timeout<T>(log_type, log_data);
+    }, std::chrono::seconds{23}, std::chrono::seconds{10});
 
-        send_log_data<T>(log_type, log_data);
-    }, std::chrono::seconds{23}, std::chrono::seconds{10}) << log_type << *log_data;
+    sender << log_type;
+    if (protocol_->log_pack_compression())
+        sender << Log_Pack_Codec::encode(*log_data, Helpz::Net::Protocol::DATASTREAM_VERSION);
+    else
+        sender << *log_data;
+}
+
+template<typename T>
+void Log_Sender::process_ack(const Log_Type_Wrapper& log_type, uint32_t first_id, uint32_t last_id)
+{
+    Base& db = Base::get_thread_local_instance();
+    db.del(db_table_name<T>(), get_id_range_suffix<T>(first_id, last_id));
+
+    // Additive increase: window grows by one pack when whole window is acknowledged
+    Type_State& state = state_[log_type.value()];
+    state.in_flight_.erase(first_id);
+    state.window_ = std::min(max_window, state.window_ + 1. / state.window_);
+    state.pack_size_ = std::min(max_pack_size, state.pack_size_ + min_pack_size);
+
+    fill_window<T>(log_type);
+}
+
+template<typename T>
+void Log_Sender::process_timeout(const Log_Type_Wrapper& log_type, std::shared_ptr<QVector<T>> log_data)
+{
+    // Multiplicative decrease
+    Type_State& state = state_[log_type.value()];
+    state.window_ = std::max(1., state.window_ / 2.);
+    state.pack_size_ = std::max(min_pack_size, state.pack_size_ / 2);
+
+    qCWarning(Sync_Log) << log_type.to_string() << "log send timeout. window:" << state.window_ << "pack size:" << state.pack_size_;
+
+    auto it = state.in_flight_.find(log_data->front().id());
+    if (it == state.in_flight_.end())
+        return;
+    state.in_flight_.erase(it);
+
+    // Resend timed out pack split by new pack size
+    for (int pos = 0; pos < log_data->size(); pos += state.pack_size_)
+    {
+        auto part = std::make_shared<QVector<T>>(log_data->mid(pos, state.pack_size_));
+        state.in_flight_.emplace(part->front().id(), part->back().id());
+        send_log_data(log_type, part);
+    }
 }
 
 } // namespace Client
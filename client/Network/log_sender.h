@@ -4,6 +4,7 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <map>
 
 #include <Das/log/log_type.h>
 #include <Das/log/log_pack.h>
@@ -17,21 +18,42 @@ namespace Client {
 
 using namespace Das::Client;
 
+// Sends log rows saved while server was unavailable.
+// Several packs are in flight at once, the window grows by one pack per round trip
+// and is halved on timeout. Acknowledged pack is deleted by its id range,
+// so after reconnect sending continues from the first unacknowledged row.
 class Log_Sender
 {
 public:
+    static constexpr int max_pack_size = 200;
+    static constexpr int min_pack_size = 5;
+    static constexpr double max_window = 16.;
+
     explicit Log_Sender(Protocol_Base* protocol);
 
     void send_data(Log_Type_Wrapper log_type, uint8_t msg_id);
 private:
+    struct Type_State
+    {
+        double window_ = 1.;
+        int pack_size_ = max_pack_size;
+        uint32_t cursor_ = 0; // Last sent id, moved back when not sent rows is found below it
+        std::map<uint32_t, uint32_t> in_flight_; // First id to last id of pack
+    };
 
     template<typename T>
-    void send_log_data(const Log_Type_Wrapper& log_type);
+    void fill_window(const Log_Type_Wrapper& log_type);
 
     template<typename T>
     void send_log_data(const Log_Type_Wrapper& log_type, std::shared_ptr<QVector<T>> log_data);
 
-    int request_data_size_;
+    template<typename T>
+    void process_ack(const Log_Type_Wrapper& log_type, uint32_t first_id, uint32_t last_id);
+
+    template<typename T>
+    void process_timeout(const Log_Type_Wrapper& log_type, std::shared_ptr<QVector<T>> log_data);
+
+    Type_State state_[LOG_COUNT];
     Protocol_Base* protocol_;
 };
 
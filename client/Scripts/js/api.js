@@ -1,5 +1,5 @@
 var api = {
-    version: 204,
+    version: 205,
 
     actDevice: function(group, type, newState, user_id) {
         group.write_to_control(type, newState, api.type.mode.automatic, user_id)
@@ -20,11 +20,13 @@ var api = {
     checker: [],
 
     handlers: {
+        // Item handlers is called queued after the change, once per change in change order
         changed: {
             mode: undefined,
             item: undefined,
             sensor: undefined,
             control: undefined,
+            items: undefined, // args: [{ group, item, user_id, old_value }] - all changes of one burst
             day_part: undefined,
         },
         database: { initialized: undefined },
@@ -102,7 +104,7 @@ api.connect_if_exist = function(signal, obj, func_name)
 api.init_as_group_manager = function(obj, group)
 {
     obj.group = group;
-    obj.param = group.param;
+    obj.param = new Params(group.param); // QJS engine returns param as plain QObject
     obj.item = {};
 
     var items = group.items;
@@ -117,15 +119,15 @@ api.init_as_group_manager = function(obj, group)
 
         var func = obj['on_' + type_name + '_raw_to_display'];
         if (typeof func === 'function')
-            api.mng.connect_item_raw_to_display(item, obj, func); // args: data
+            api.engine.connect_item_raw_to_display(item, obj, func); // args: data
 
         func = obj['on_' + type_name + '_display_to_raw'];
         if (typeof func === 'function')
-            api.mng.connect_item_display_to_raw(item, obj, func); // args: data
+            api.engine.connect_item_display_to_raw(item, obj, func); // args: data
 
         func = obj['is_' + type_name + '_can_change'];
         if (typeof func === 'function')
-            api.mng.connect_item_is_can_change(item, obj, func); // args: raw_data, user_id
+            api.engine.connect_item_is_can_change(item, obj, func); // args: raw_data, user_id
     }
 
     api.connect_if_exist(group.mode_changed , obj, 'on_mode_changed');  // args: user_id, mode_id
@@ -0,0 +1,29 @@
+#include "scripted_scheme.h"
+#include "script_engine_qtscript.h"
+#include "script_engine_qjs.h"
+#include "script_engine.h"
+
+namespace Das {
+
+/*static*/ Script_Engine* Script_Engine::create(const QString& name, Scripted_Scheme* scheme)
+{
+    if (name == "qjs")
+        return new Script_Engine_QJS(scheme);
+
+    if (name != "qtscript")
+        qCWarning(ScriptEngineLog) << "Unknown script engine" << name << "qtscript is used";
+    return new Script_Engine_QtScript(scheme);
+}
+
+Script_Engine::Script_Engine(Scripted_Scheme* scheme) :
+    QObject(scheme),
+    scheme_(scheme)
+{
+}
+
+/*static*/ QString Script_Engine::handler_full_name(const QStringList& path)
+{
+    return "api.handlers." + path.join('.');
+}
+
+} // namespace Das
@@ -0,0 +1,63 @@
+#ifndef DAS_SCRIPT_ENGINE_H
+#define DAS_SCRIPT_ENGINE_H
+
+#include <QObject>
+#include <QVariant>
+#include <QLoggingCategory>
+
+namespace Das {
+
+Q_DECLARE_LOGGING_CATEGORY(ScriptEngineLog)
+Q_DECLARE_LOGGING_CATEGORY(ScriptDetailLog)
+
+class Scripted_Scheme;
+
+// Engine independent access to scripts.
+// Values is passed as QVariant, pointer to QObject is passed to script as wrapper object,
+// QVariantList as array and QVariantMap as object.
+class Script_Engine : public QObject
+{
+    Q_OBJECT
+public:
+    // name is "qtscript" or "qjs"
+    static Script_Engine* create(const QString& name, Scripted_Scheme* scheme);
+
+    static QVariant object(QObject* obj) { return QVariant::fromValue(obj); }
+
+    explicit Script_Engine(Scripted_Scheme* scheme);
+    virtual ~Script_Engine() = default;
+
+    // Drop all evaluated scripts and object wrappers before scripts is loaded again
+    virtual void reset() = 0;
+
+    // Called when sections or devices is added, before handlers get new objects
+    virtual void structure_changed() {}
+
+    virtual void evaluate(const QString& code, const QString& file_name) = 0;
+
+    // False if code is not complete yet
+    virtual bool can_evaluate(const QString& code) const = 0;
+    // Returns result as text for console output
+    virtual QString console(const QString& code, bool& is_error) = 0;
+    virtual QVariant call_function(const QString& name, const QVariantList& args) = 0;
+
+    // Path is relative to "api" object, not existing objects in path is created by setter
+    virtual QVariant api_property(const QStringList& path) const = 0;
+    virtual void set_api_property(const QStringList& path, const QVariant& value) = 0;
+
+    // Handler is function in "api.handlers" object. Found handler is cached by handler_type until reset,
+    // negative handler_type is never cached.
+    virtual bool is_handler(int handler_type, const QStringList& path) = 0;
+    virtual QVariant call_handler(int handler_type, const QStringList& path, const QVariantList& args) = 0;
+
+    virtual QStringList backtrace() const = 0;
+
+protected:
+    static QString handler_full_name(const QStringList& path);
+
+    Scripted_Scheme* scheme_;
+};
+
+} // namespace Das
+
+#endif // DAS_SCRIPT_ENGINE_H
@@ -0,0 +1,572 @@
+#include <QQmlEngine>
+#include <QMetaEnum>
+#include <QTimer>
+#include <QProcess>
+
+#include <Das/device.h>
+
+#include "scripted_scheme.h"
+
+#include "tools/automationhelper.h"
+#include "tools/pidhelper.h"
+#include "tools/severaltimeshelper.h"
+#include "tools/inforegisterhelper.h"
+
+#include "script_engine_qjs.h"
+
+namespace Das {
+
+// Same interface as ParamGroupClass in QtScript engine. Param is wrapped in Proxy,
+// so children is available by name and index.
+static const char* params_class_code = R"js(
+(function(engine) {
+    function wrap(data) {
+        return typeof data === 'object' && data !== null ? new Params(data) : data;
+    }
+
+    function Params(param) {
+        if (param instanceof Params)
+            param = param.__param__;
+        if (typeof param !== 'object' || param === null)
+            return undefined;
+
+        return new Proxy(Object.create(Params.prototype), {
+            get: function(target, key) {
+                if (key === '__param__')
+                    return param;
+                if (typeof key === 'string') {
+                    var data = engine.param_property(param, key);
+                    if (data !== undefined)
+                        return wrap(data);
+                }
+                return Params.prototype[key];
+            },
+            set: function(target, key, value) {
+                var child = key === 'value' ? param : engine.param_property(param, key);
+                if (typeof child === 'object' && child !== null)
+                    child.value = value;
+                return true;
+            },
+            has: function(target, key) {
+                return key === '__param__' || key in Params.prototype
+                    || (typeof key === 'string' && engine.param_property(param, key) !== undefined);
+            },
+            ownKeys: function() {
+                return engine.param_names(param);
+            },
+            getOwnPropertyDescriptor: function(target, key) {
+                var data = typeof key === 'string' ? engine.param_property(param, key) : undefined;
+                if (data === undefined)
+                    return undefined;
+                return { value: wrap(data), writable: true, enumerable: true, configurable: true };
+            }
+        });
+    }
+
+    Params.prototype.byTypeId = function(type_id) {
+        return wrap(engine.param_by_type_id(this.__param__, type_id));
+    };
+    Params.prototype.valueOf = function() {
+        return this.value;
+    };
+    Params.prototype.toJSON = Params.prototype.valueOf;
+    Params.prototype.toString = function() {
+        var text = this.__param__.toString();
+        return text ? text : String(this.__param__.value);
+    };
+    return Params;
+})
+)js";
+
+template<typename T, template<typename> class P, typename... Args>
+void Script_Engine_QJS::add_type()
+{
+    QString name = T::staticMetaObject.className();
+
+    int four_dots = name.lastIndexOf("::");
+    if (four_dots >= 0)
+        name.remove(0, four_dots + 2);
+
+    types_.emplace(name, Type_Info{&T::staticMetaObject, [](const QVariantList& args) -> QObject*
+    {
+        if (static_cast<std::size_t>(args.size()) >= sizeof...(Args))
+            return create<T, Args...>(args, std::index_sequence_for<Args...>{});
+        return P<T>()();
+    }});
+}
+
+Script_Engine_QJS::Script_Engine_QJS(Scripted_Scheme* scheme) :
+    Script_Engine(scheme),
+    engine_(nullptr)
+{
+    register_types();
+    reset();
+}
+
+/*static*/ QJSValue Script_Engine_QJS::value_from_variant(QJSEngine* engine, const QVariant& data)
+{
+    switch (data.type()) {
+    case QVariant::Bool:                return data.toBool();
+    case QVariant::String:              return data.toString();
+    case QVariant::Int:                 return data.toInt();
+    case QVariant::UInt:                return data.toUInt();
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+    case QVariant::Double:              return data.toDouble();
+    default:
+        // Date and RegExp is converted to script types too
+        return engine->toScriptValue(data);
+    }
+}
+
+void Script_Engine_QJS::reset()
+{
+    handlers_.clear();
+    objects_.clear();
+    owned_structure_size_ = std::make_pair(-1, -1);
+
+    // Reset may be called from script, so old engine is deleted after it
+    if (engine_)
+        engine_->deleteLater();
+
+    engine_ = new QJSEngine(this);
+    engine_->installExtensions(QJSEngine::ConsoleExtension | QJSEngine::GarbageCollectionExtension);
+    install_types();
+}
+
+void Script_Engine_QJS::structure_changed()
+{
+    const std::pair<int, int> size{scheme_->sections().size(), scheme_->devices().size()};
+    if (owned_structure_size_ == size)
+        return;
+    owned_structure_size_ = size;
+
+    // Objects without parent returned from invokable methods is owned by script by default,
+    // so garbage collector can delete them.
+    QQmlEngine::setObjectOwnership(scheme_, QQmlEngine::CppOwnership);
+    for (Section* sct: scheme_->sections())
+    {
+        QQmlEngine::setObjectOwnership(sct, QQmlEngine::CppOwnership);
+        for (Device_item_Group* group: sct->groups())
+            QQmlEngine::setObjectOwnership(group, QQmlEngine::CppOwnership);
+    }
+
+    for (Device* dev: scheme_->devices())
+    {
+        QQmlEngine::setObjectOwnership(dev, QQmlEngine::CppOwnership);
+        for (Device_Item* item: dev->items())
+            QQmlEngine::setObjectOwnership(item, QQmlEngine::CppOwnership);
+    }
+}
+
+void Script_Engine_QJS::evaluate(const QString& code, const QString& file_name)
+{
+    check_error(file_name, engine_->evaluate(code, file_name));
+}
+
+bool Script_Engine_QJS::can_evaluate(const QString& code) const
+{
+    // QJSEngine can't check code without evaluation, so like QScriptEngine::canEvaluate
+    // code is incomplete only when brackets, comment or template string isn't closed.
+    int depth = 0;
+    QChar quote;
+    bool is_line_comment = false, is_block_comment = false, is_escaped = false;
+
+    for (int i = 0; i < code.size(); ++i)
+    {
+        const QChar c = code.at(i);
+        const QChar next = i + 1 < code.size() ? code.at(i + 1) : QChar();
+
+        if (is_line_comment)
+        {
+            if (c == '\n')
+                is_line_comment = false;
+        }
+        else if (is_block_comment)
+        {
+            if (c == '*' && next == '/')
+            {
+                is_block_comment = false;
+                ++i;
+            }
+        }
+        else if (!quote.isNull())
+        {
+            if (is_escaped)
+                is_escaped = false;
+            else if (c == '\\')
+                is_escaped = true;
+            else if (c == quote || (c == '\n' && quote != '`'))
+                quote = QChar();
+        }
+        else if (c == '/' && (next == '/' || next == '*'))
+        {
+            is_line_comment = next == '/';
+            is_block_comment = next == '*';
+            ++i;
+        }
+        else if (c == '"' || c == '\'' || c == '`')
+            quote = c;
+        else if (c == '(' || c == '[' || c == '{')
+            ++depth;
+        else if (c == ')' || c == ']' || c == '}')
+            --depth;
+    }
+
+    return depth <= 0 && !is_block_comment && quote != '`';
+}
+
+QString Script_Engine_QJS::console(const QString& code, bool& is_error)
+{
+    QJSValue res = engine_->evaluate(code, "CONSOLE");
+
+    is_error = res.isError();
+
+    if (!res.isUndefined())
+    {
+        if (!res.isError() && (res.isObject() || res.isArray()))
+        {
+            QJSValue check_func = engine_->evaluate(
+                "(function(key, value) {"
+                "  if ((typeof value === 'object' || typeof value === 'function') && "
+                "      value !== null && !Array.isArray(value) && value.toString() !== '[object Object]') {"
+                "    return value.toString();"
+                "  }"
+                "  return value;"
+                "})");
+            res = engine_->evaluate("JSON.stringify").call({res, check_func, QJSValue(" ")});
+        }
+
+        if (res.isError())
+        {
+            res = res.property("message");
+            is_error = true;
+        }
+    }
+    return res.toString();
+}
+
+QVariant Script_Engine_QJS::call_function(const QString& name, const QVariantList& args)
+{
+    QJSValueList arg_list;
+    for (const QVariant& arg: args)
+        arg_list.push_back(to_script_value(arg));
+
+    QJSValue func = engine_->globalObject().property(name);
+    QJSValue ret = func.call(arg_list);
+    check_error("exec", ret);
+    return ret.toVariant();
+}
+
+QVariant Script_Engine_QJS::api_property(const QStringList& path) const
+{
+    QJSValue obj = api();
+    for (const QString& name: path)
+        obj = obj.property(name);
+    return obj.toVariant();
+}
+
+void Script_Engine_QJS::set_api_property(const QStringList& path, const QVariant& value)
+{
+    if (path.isEmpty())
+        return;
+
+    QJSValue obj = api(), child;
+    for (int i = 0; i < path.size() - 1; ++i)
+    {
+        child = obj.property(path.at(i));
+        if (!child.isObject())
+        {
+            child = engine_->newObject();
+            obj.setProperty(path.at(i), child);
+        }
+        obj = child;
+    }
+    obj.setProperty(path.last(), to_script_value(value));
+}
+
+bool Script_Engine_QJS::is_handler(int handler_type, const QStringList& path)
+{
+    return handler(handler_type, path).isCallable();
+}
+
+QVariant Script_Engine_QJS::call_handler(int handler_type, const QStringList& path, const QVariantList& args)
+{
+    QJSValue func = handler(handler_type, path);
+    if (!func.isCallable())
+    {
+        qCDebug(ScriptDetailLog) << "Can not find:" << handler_full_name(path);
+        return {};
+    }
+
+    QJSValueList arg_list;
+    for (const QVariant& arg: args)
+        arg_list.push_back(to_script_value(arg));
+
+    QJSValue ret = func.call(arg_list);
+    if (ret.isError())
+    {
+        check_error(handler_full_name(path), ret);
+        handlers_.erase(handler_type);
+        return {};
+    }
+    return ret.toVariant();
+}
+
+QStringList Script_Engine_QJS::backtrace() const
+{
+    QStringList stack = engine_->evaluate("new Error().stack").toString().split('\n', QString::SkipEmptyParts);
+    if (!stack.isEmpty())
+        stack.removeFirst(); // Frame of this evaluate
+    return stack;
+}
+
+void Script_Engine_QJS::connect_item_is_can_change(Device_Item* item, const QJSValue& obj, const QJSValue& func)
+{
+    if (item && func.isCallable())
+    {
+        connect(item, &Device_Item::is_can_change, [this, obj, func](const QVariant& display_value, uint32_t user_id) -> bool
+        {
+            QJSValue f = func;
+            QJSValue res = f.callWithInstance(obj, QJSValueList{ to_script_value(display_value), user_id });
+            return res.toBool();
+        });
+    }
+}
+
+void Script_Engine_QJS::connect_item_raw_to_display(Device_Item* item, const QJSValue& obj, const QJSValue& func)
+{
+    if (item && func.isCallable())
+    {
+        connect(item, &Device_Item::raw_to_display, [this, obj, func](const QVariant& data) -> QVariant
+        {
+            QJSValue f = func;
+            QJSValue res = f.callWithInstance(obj, QJSValueList{ to_script_value(data) });
+            return res.toVariant();
+        });
+    }
+}
+
+void Script_Engine_QJS::connect_item_display_to_raw(Device_Item* item, const QJSValue& obj, const QJSValue& func)
+{
+    if (item && func.isCallable())
+    {
+        connect(item, &Device_Item::display_to_raw, [this, obj, func](const QVariant& data) -> QVariant
+        {
+            QJSValue f = func;
+            QJSValue res = f.callWithInstance(obj, QJSValueList{ to_script_value(data) });
+            return res.toVariant();
+        });
+    }
+}
+
+QObject* Script_Engine_QJS::create_object(const QString& class_name, const QVariantList& args)
+{
+    auto it = types_.find(class_name);
+    if (it == types_.cend())
+        return nullptr;
+
+    // Object without parent is owned by script, like with QScriptEngine::ScriptOwnership
+    return it->second.create_(args);
+}
+
+QVariant Script_Engine_QJS::param_property(QObject* obj, const QString& name) const
+{
+    Param* param = qobject_cast<Param*>(obj);
+    if (!param)
+        return {};
+
+    if (param->count())
+    {
+        bool is_index;
+        const uint index = name.toUInt(&is_index);
+        Param* child = is_index ? param->get(index) : param->get(name);
+        if (child)
+        {
+            // Params isn't parented, so script must not delete it
+            QQmlEngine::setObjectOwnership(child, QQmlEngine::CppOwnership);
+            return object(child);
+        }
+    }
+
+    if (name == "name")     return param->type()->name();
+    if (name == "title")    return param->type()->title();
+    if (name == "type")     return param->type()->id();
+    if (name == "length")   return static_cast<uint>(param->count());
+    if (name != "value")    return {};
+
+    // Same as ParamGroupClass::getValue
+    switch (param->type()->value_type())
+    {
+    case DIG_Param_Type::VT_TIME:
+    case DIG_Param_Type::VT_INT:       return param->value().toInt();
+    case DIG_Param_Type::VT_BOOL:      return param->value().toInt() ? true : false;
+    case DIG_Param_Type::VT_FLOAT:     return param->value().toReal();
+    case DIG_Param_Type::VT_BYTES:     return QString::fromLocal8Bit(param->value().toByteArray().toHex());
+    case DIG_Param_Type::VT_RANGE:
+        QQmlEngine::setObjectOwnership(param, QQmlEngine::CppOwnership);
+        return object(param);
+    case DIG_Param_Type::VT_COMBO:
+    case DIG_Param_Type::VT_STRING:
+    default:
+        return param->value().toString();
+    }
+}
+
+QVariant Script_Engine_QJS::param_by_type_id(QObject* obj, uint type_id) const
+{
+    Param* param = qobject_cast<Param*>(obj);
+    Param* child = param ? param->get_by_type_id(type_id) : nullptr;
+    if (!child)
+        return {};
+
+    QQmlEngine::setObjectOwnership(child, QQmlEngine::CppOwnership);
+    return object(child);
+}
+
+QStringList Script_Engine_QJS::param_names(QObject* obj) const
+{
+    QStringList names;
+    Param* param = qobject_cast<Param*>(obj);
+    if (param)
+    {
+        for (std::size_t i = 0; i < param->count(); ++i)
+        {
+            Param* child = param->get(static_cast<uint>(i));
+            if (child)
+                names.push_back(child->type()->name());
+        }
+    }
+    return names;
+}
+
+void Script_Engine_QJS::register_types()
+{
+    add_type<QTimer>();
+    add_type<QProcess>();
+
+    add_type<AutomationHelper, Type_Default, uint>();
+
+    add_type_n<AutomationHelperItem, Device_item_Group*>();
+    add_type_n<SeveralTimesHelper, Device_item_Group*>();
+    add_type_n<PIDHelper, Device_item_Group*, uint>();
+    add_type_n<InfoRegisterHelper, Device_item_Group*, uint, uint>();
+
+    add_type_n<Section, uint32_t, QString, uint32_t, uint32_t>();
+    add_type_n<Device_item_Group, uint32_t, QString, uint32_t, uint32_t, uint32_t>();
+}
+
+void Script_Engine_QJS::install_types()
+{
+    QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
+    const QJSValue self = engine_->newQObject(this);
+
+    // Constructor is script function, so it can be called with "new" and has enums of type
+    QJSValue make_ctor = engine_->evaluate(
+        "(function(engine, name) {"
+        "  return function() { return engine.create_object(name, Array.prototype.slice.call(arguments)); };"
+        "})");
+
+    for (const auto& it: types_)
+    {
+        QJSValue ctor = make_ctor.call({self, it.first});
+
+        const QMetaObject* meta = it.second.meta_object_;
+        for (int i = 0; i < meta->enumeratorCount(); ++i)
+        {
+            const QMetaEnum meta_enum = meta->enumerator(i);
+            for (int j = 0; j < meta_enum.keyCount(); ++j)
+                ctor.setProperty(QString::fromLatin1(meta_enum.key(j)), meta_enum.value(j));
+        }
+
+        engine_->globalObject().setProperty(it.first, ctor);
+    }
+
+    QJSValue params_class = engine_->evaluate(QString::fromLatin1(params_class_code)).call({self});
+    check_error("Params", params_class);
+    engine_->globalObject().setProperty("Params", params_class);
+}
+
+QJSValue Script_Engine_QJS::to_script_value(const QVariant& data)
+{
+    if (QMetaType::typeFlags(data.userType()) & QMetaType::PointerToQObject)
+        return script_object(data.value<QObject*>());
+
+    switch (data.type())
+    {
+    case QVariant::Invalid:
+        return QJSValue();
+
+    case QVariant::List:
+    {
+        const QVariantList list = data.toList();
+        QJSValue array = engine_->newArray(list.size());
+        quint32 index = 0;
+        for (const QVariant& value: list)
+            array.setProperty(index++, to_script_value(value));
+        return array;
+    }
+
+    case QVariant::Map:
+    {
+        const QVariantMap map = data.toMap();
+        QJSValue obj = engine_->newObject();
+        for (auto it = map.cbegin(); it != map.cend(); ++it)
+            obj.setProperty(it.key(), to_script_value(it.value()));
+        return obj;
+    }
+
+    default:
+        return value_from_variant(engine_, data);
+    }
+}
+
+QJSValue Script_Engine_QJS::api() const
+{
+    return engine_->globalObject().property("api");
+}
+
+QJSValue Script_Engine_QJS::handler(int handler_type, const QStringList& path)
+{
+    if (handler_type >= 0)
+    {
+        auto it = handlers_.find(handler_type);
+        if (it != handlers_.cend())
+            return it->second;
+    }
+
+    QJSValue obj = api().property("handlers");
+    for (const QString& name: path)
+        obj = obj.property(name);
+
+    if (handler_type >= 0 && obj.isCallable())
+        handlers_.emplace(handler_type, obj);
+    return obj;
+}
+
+QJSValue Script_Engine_QJS::script_object(QObject* obj)
+{
+    if (!obj)
+        return QJSValue(QJSValue::NullValue);
+
+    auto it = objects_.find(obj);
+    if (it == objects_.end())
+    {
+        QQmlEngine::setObjectOwnership(obj, QQmlEngine::CppOwnership);
+        it = objects_.emplace(obj, engine_->newQObject(obj)).first;
+    }
+    return it->second;
+}
+
+void Script_Engine_QJS::check_error(const QString& name, const QJSValue& result) const
+{
+    if (result.isError())
+    {
+        qCCritical(ScriptEngineLog).noquote().nospace()
+                << name << ' ' << result.property("fileName").toString()
+                << '(' << result.property("lineNumber").toInt() << "): "
+                << result.toString() << '\n' << result.property("stack").toString();
+    }
+}
+
+} // namespace Das
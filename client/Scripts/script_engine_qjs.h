@@ -0,0 +1,104 @@
+#ifndef DAS_SCRIPT_ENGINE_QJS_H
+#define DAS_SCRIPT_ENGINE_QJS_H
+
+#include <map>
+#include <functional>
+#include <utility>
+
+#include <QJSEngine>
+
+#include "script_engine.h"
+
+namespace Das {
+
+class Device_Item;
+
+// Engine based on QJSEngine (V4 with JIT). Objects is passed to scripts as QObject wrappers.
+// Types constructors and Params class is the same as in QtScript engine, debugger is available only there.
+class Script_Engine_QJS final : public Script_Engine
+{
+    Q_OBJECT
+public:
+    explicit Script_Engine_QJS(Scripted_Scheme* scheme);
+
+    QJSValue to_script_value(const QVariant& data);
+
+    void reset() override;
+    void structure_changed() override;
+    void evaluate(const QString& code, const QString& file_name) override;
+    bool can_evaluate(const QString& code) const override;
+    QString console(const QString& code, bool& is_error) override;
+    QVariant call_function(const QString& name, const QVariantList& args) override;
+
+    QVariant api_property(const QStringList& path) const override;
+    void set_api_property(const QStringList& path, const QVariant& value) override;
+
+    bool is_handler(int handler_type, const QStringList& path) override;
+    QVariant call_handler(int handler_type, const QStringList& path, const QVariantList& args) override;
+
+    QStringList backtrace() const override;
+public slots:
+    // Called from scripts as api.engine
+    void connect_item_is_can_change(Device_Item* item, const QJSValue& obj, const QJSValue& func);
+    void connect_item_raw_to_display(Device_Item* item, const QJSValue& obj, const QJSValue& func);
+    void connect_item_display_to_raw(Device_Item* item, const QJSValue& obj, const QJSValue& func);
+
+    // Used by types constructors
+    QObject* create_object(const QString& class_name, const QVariantList& args);
+
+    // Used by Params class. Property is child param by name or index, or name, title, type, length and value.
+    QVariant param_property(QObject* obj, const QString& name) const;
+    QVariant param_by_type_id(QObject* obj, uint type_id) const;
+    QStringList param_names(QObject* obj) const;
+private:
+    template<typename T>
+    struct Type_Empty {
+        QObject* operator() () { return nullptr; }
+    };
+    template<typename T>
+    struct Type_Default {
+        QObject* operator() () { return new T; }
+    };
+
+    template<typename T, typename... Args, std::size_t... I>
+    static QObject* create(const QVariantList& args, std::index_sequence<I...>)
+    {
+        return new T(args.at(I).value<Args>()...);
+    }
+
+    template<typename T, template<typename> class P = Type_Empty, typename... Args>
+    void add_type();
+
+    template<typename T, typename... Args>
+    void add_type_n() { add_type<T, Type_Empty, Args...>(); }
+
+    void register_types();
+    void install_types();
+
+    QJSValue api() const;
+    QJSValue handler(int handler_type, const QStringList& path);
+    static QJSValue value_from_variant(QJSEngine* engine, const QVariant& data);
+    QJSValue script_object(QObject* obj);
+    void check_error(const QString& name, const QJSValue& result) const;
+
+    QJSEngine* engine_;
+
+    struct Type_Info
+    {
+        const QMetaObject* meta_object_;
+        std::function<QObject*(const QVariantList&)> create_;
+    };
+    std::map<QString, Type_Info> types_;
+
+    std::map<int, QJSValue> handlers_;
+
+    // Script wrappers of groups and items, they live until reset
+    std::map<QObject*, QJSValue> objects_;
+
+    // Section and device count when ownership of structure objects was set last time
+    std::pair<int, int> owned_structure_size_;
+};
+
+} // namespace Das
+
+#endif // DAS_SCRIPT_ENGINE_QJS_H
@@ -0,0 +1,425 @@
+#include <QCoreApplication>
+#include <QTimer>
+#include <QProcess>
+
+#ifdef QT_DEBUG
+#include <QScriptEngineDebugger>
+#include <QMainWindow>
+#endif
+
+#include <Das/device.h>
+
+#include "scripted_scheme.h"
+#include "paramgroupclass.h"
+
+#include "tools/automationhelper.h"
+#include "tools/pidhelper.h"
+#include "tools/severaltimeshelper.h"
+#include "tools/inforegisterhelper.h"
+
+#include "script_engine_qtscript.h"
+
+Q_DECLARE_METATYPE(std::string)
+
+namespace Das {
+
+template<class T>
+QScriptValue sharedPtrToScriptValue(QScriptEngine *eng, const T &obj) {
+    return eng->newQObject(obj.get());
+}
+template<class T>
+void emptyFromScriptValue(const QScriptValue &, T &) {}
+
+QScriptValue stdstringToScriptValue(QScriptEngine *, const std::string& str)
+{ return QString::fromStdString(str); }
+
+// ------------------------------------------------------------------------------------
+
+template<class T>
+QScriptValue ptrToScriptValue(QScriptEngine *eng, const T& obj) {
+    return eng->newQObject(obj);
+}
+
+struct ArgumentGetter {
+    ArgumentGetter(QScriptContext* _ctx) : ctx(_ctx) {}
+    QScriptContext* ctx;
+    int arg_idx = 0;
+    QScriptValue operator() () {
+        return ctx->argument(arg_idx++);
+    }
+};
+
+template<typename T, template<typename> class P, typename... Args>
+void Script_Engine_QtScript::add_type()
+{
+    auto ctor = [](QScriptContext* ctx, QScriptEngine* script_engine_) -> QScriptValue {
+        if ((unsigned)ctx->argumentCount() >= sizeof...(Args))
+        {
+            ArgumentGetter get_arg(ctx);
+
+            auto obj = new T(qscriptvalue_cast<Args>(get_arg())...);
+            return script_engine_->newQObject(obj, QScriptEngine::ScriptOwnership);
+        }
+        return P<T>()(ctx, script_engine_);
+    };
+
+    auto value = engine_->newQMetaObject(&T::staticMetaObject,
+                                     engine_->newFunction(ctor));
+
+    QString name = T::staticMetaObject.className();
+
+    int four_dots = name.lastIndexOf("::");
+    if (four_dots >= 0)
+        name.remove(0, four_dots + 2);
+
+    engine_->globalObject().setProperty(name, value);
+
+//    qCDebug(SchemeLog) << "Register for script:" << name;
+}
+
+#ifdef QT_DEBUG
+bool do_not_show_debugger = false;
+#endif
+
+Script_Engine_QtScript::Script_Engine_QtScript(Scripted_Scheme* scheme) :
+    Script_Engine(scheme)
+{
+    register_types();
+    engine_->pushContext();
+}
+
+Script_Engine_QtScript::~Script_Engine_QtScript()
+{
+#ifdef QT_DEBUG
+    if (debugger_)
+    {
+        // Если закрыть окно отладчика,
+        // то оно не откроется при перезагрузке кнопкой на сайте
+        // Работает, но пока не понятно на сколько это удобно и нужно
+        // Возможно лучше добавить диалоговое окно при закрытии отладчика
+//        do_not_show_debugger = debugger_->standardWindow()->isHidden();
+
+        debugger_->standardWindow()->close();
+        debugger_->detach();
+        delete debugger_;
+    }
+#endif
+    engine_->popContext();
+}
+
+/*static*/ QScriptValue Script_Engine_QtScript::value_from_variant(QScriptEngine* engine, const QVariant &data)
+{
+    switch (data.type()) {
+    case QVariant::Bool:                return data.toBool();
+    case QVariant::String:              return data.toString();
+    case QVariant::Int:                 return data.toInt();
+    case QVariant::UInt:                return data.toUInt();
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+    case QVariant::Double:              return data.toDouble();
+    case QVariant::Date:
+    case QVariant::Time:
+    case QVariant::DateTime:            return engine->newDate(data.toDateTime());
+    case QVariant::RegExp:
+    case QVariant::RegularExpression:   return engine->newRegExp(data.toRegExp());
+    default:
+        return  engine->newVariant(data);
+    }
+}
+
+void Script_Engine_QtScript::reset()
+{
+    handlers_.clear();
+    objects_.clear();
+
+    engine_->popContext();
+    engine_->pushContext();
+}
+
+void Script_Engine_QtScript::evaluate(const QString& code, const QString& file_name)
+{
+    check_error(file_name, engine_->evaluate(code, file_name));
+}
+
+bool Script_Engine_QtScript::can_evaluate(const QString& code) const
+{
+    return engine_->canEvaluate(code);
+}
+
+QString Script_Engine_QtScript::console(const QString& code, bool& is_error)
+{
+    QScriptValue res = engine_->evaluate(code, "CONSOLE");
+
+    is_error = res.isError();
+
+    if (!res.isUndefined())
+    {
+        if (!res.isError() && (res.isObject() || res.isArray()))
+        {
+            QScriptValue check_func = engine_->evaluate(
+                "(function(key, value) {"
+                "  if ((typeof value === 'object' || typeof value === 'function') && "
+                "      value !== null && !Array.isArray(value) && value.toString() !== '[object Object]') {"
+                "    return value.toString();"
+                "  }"
+                "  return value;"
+                "})");
+            res = engine_->evaluate("JSON.stringify").call(QScriptValue(), {res, check_func, ' '});
+        }
+
+        if (res.isError())
+        {
+            res = res.property("message");
+            is_error = true;
+        }
+    }
+    return res.toString();
+}
+
+QVariant Script_Engine_QtScript::call_function(const QString& name, const QVariantList& args)
+{
+    QScriptValueList arg_list;
+    for (const QVariant& arg: args)
+        arg_list.push_back(engine_->newVariant(arg));
+
+    QScriptValue func = engine_->currentContext()->activationObject().property(name);
+    QScriptValue ret = func.call(QScriptValue(), arg_list);
+    check_error("exec", ret);
+    return ret.toVariant();
+}
+
+QVariant Script_Engine_QtScript::api_property(const QStringList& path) const
+{
+    QScriptValue obj = api();
+    for (const QString& name: path)
+        obj = obj.property(name);
+    return obj.toVariant();
+}
+
+void Script_Engine_QtScript::set_api_property(const QStringList& path, const QVariant& value)
+{
+    if (path.isEmpty())
+        return;
+
+    QScriptValue obj = api(), child;
+    for (int i = 0; i < path.size() - 1; ++i)
+    {
+        child = obj.property(path.at(i));
+        if (!child.isObject())
+        {
+            child = engine_->newObject();
+            obj.setProperty(path.at(i), child);
+        }
+        obj = child;
+    }
+    obj.setProperty(path.last(), to_script_value(value));
+}
+
+bool Script_Engine_QtScript::is_handler(int handler_type, const QStringList& path)
+{
+    return handler(handler_type, path).isFunction();
+}
+
+QVariant Script_Engine_QtScript::call_handler(int handler_type, const QStringList& path, const QVariantList& args)
+{
+    QScriptValue func = handler(handler_type, path);
+    if (!func.isFunction())
+    {
+        qCDebug(ScriptDetailLog) << "Can not find:" << handler_full_name(path);
+        return {};
+    }
+
+    QScriptValueList arg_list;
+    for (const QVariant& arg: args)
+        arg_list.push_back(to_script_value(arg));
+
+    QScriptValue ret = func.call(QScriptValue(), arg_list);
+    if (ret.isError())
+    {
+        check_error(handler_full_name(path), ret);
+        handlers_.erase(handler_type);
+        return {};
+    }
+    return ret.toVariant();
+}
+
+QStringList Script_Engine_QtScript::backtrace() const
+{
+    return engine_->currentContext()->backtrace();
+}
+
+void Script_Engine_QtScript::connect_item_is_can_change(Device_Item* item, const QScriptValue& obj, const QScriptValue& func)
+{
+    if (item && func.isFunction())
+    {
+        connect(item, &Device_Item::is_can_change, [this, obj, func](const QVariant& display_value, uint32_t user_id) -> bool
+        {
+            QScriptValue f = func;
+            QScriptValue res = f.call(obj, QScriptValueList{ to_script_value(display_value), user_id });
+            return res.toBool();
+        });
+    }
+}
+
+void Script_Engine_QtScript::connect_item_raw_to_display(Device_Item* item, const QScriptValue& obj, const QScriptValue& func)
+{
+    if (item && func.isFunction())
+    {
+        connect(item, &Device_Item::raw_to_display, [this, obj, func](const QVariant& data) -> QVariant
+        {
+            QScriptValue f = func;
+            QScriptValue res = f.call(obj, QScriptValueList{ to_script_value(data) });
+            return res.toVariant();
+        });
+    }
+}
+
+void Script_Engine_QtScript::connect_item_display_to_raw(Device_Item* item, const QScriptValue& obj, const QScriptValue& func)
+{
+    if (item && func.isFunction())
+    {
+        connect(item, &Device_Item::display_to_raw, [this, obj, func](const QVariant& data) -> QVariant
+        {
+            QScriptValue f = func;
+            QScriptValue res = f.call(obj, QScriptValueList{ to_script_value(data) });
+            return res.toVariant();
+        });
+    }
+}
+
+void Script_Engine_QtScript::handler_exception(const QScriptValue &exception)
+{
+    if (engine_->hasUncaughtException())
+        qCCritical(ScriptEngineLog) << "Exception:" << exception.toString() << engine_->uncaughtExceptionBacktrace()
+                                    << '\n' << backtrace().join('\n');
+}
+
+void Script_Engine_QtScript::register_types()
+{
+    engine_ = new QScriptEngine(this);
+#ifdef QT_DEBUG
+    if (qApp->thread() == thread() && !do_not_show_debugger)
+    {
+        debugger_ = new QScriptEngineDebugger(this);
+        debugger_->attachTo(engine_);
+        debugger_->standardWindow()->show();
+    }
+#endif
+
+    connect(engine_, &QScriptEngine::signalHandlerException,
+            this, &Script_Engine_QtScript::handler_exception);
+
+    add_type<QTimer>();
+    add_type<QProcess>();
+
+    add_type<AutomationHelper, Type_Default, uint>();
+
+    add_type_n<AutomationHelperItem, Device_item_Group*>();
+    add_type_n<SeveralTimesHelper, Device_item_Group*>();
+    add_type_n<PIDHelper, Device_item_Group*, uint>();
+    add_type_n<InfoRegisterHelper, Device_item_Group*, uint, uint>();
+
+    add_type_n<Section, uint32_t, QString, uint32_t, uint32_t>();
+    add_type_n<Device_item_Group, uint32_t, QString, uint32_t, uint32_t, uint32_t>();
+
+    qScriptRegisterSequenceMetaType<Sections>(engine_);
+    qScriptRegisterSequenceMetaType<Devices>(engine_);
+    qScriptRegisterSequenceMetaType<Device_Items>(engine_);
+    qScriptRegisterSequenceMetaType<QVector<Device_Item*>>(engine_);
+    qScriptRegisterSequenceMetaType<QVector<Device_item_Group*>>(engine_);
+
+//    qScriptRegisterMetaType<SectionPtr>(eng, sharedPtrToScriptValue<SectionPtr>, emptyFromScriptValue<SectionPtr>);
+    qScriptRegisterMetaType<std::string>(engine_, stdstringToScriptValue, emptyFromScriptValue<std::string>);
+//    qScriptRegisterMetaType<Device_Item*>(eng, )
+
+//    qScriptRegisterMetaType<Device_Item::ValueType>(eng, itemValueToScriptValue, itemValueFromScriptValue);
+    //    qScriptRegisterSequenceMetaType<Device_Item::ValueList>(eng);
+
+    //    qScriptRegisterSequenceMetaType<Device_Item::ValueList>(eng);
+
+    auto paramClass = new ParamGroupClass(engine_);
+    engine_->globalObject().setProperty("Params", paramClass->constructor());
+
+//    eng->globalObject().setProperty("ParamElem", paramClass->constructor());
+}
+
+QScriptValue Script_Engine_QtScript::api() const
+{
+    return engine_->currentContext()->activationObject().property("api");
+}
+
+QScriptValue Script_Engine_QtScript::handler(int handler_type, const QStringList& path)
+{
+    if (handler_type >= 0)
+    {
+        auto it = handlers_.find(handler_type);
+        if (it != handlers_.cend())
+            return it->second;
+    }
+
+    QScriptValue obj = api().property("handlers");
+    for (const QString& name: path)
+        obj = obj.property(name);
+
+    if (handler_type >= 0 && obj.isFunction())
+        handlers_.emplace(handler_type, obj);
+    return obj;
+}
+
+QScriptValue Script_Engine_QtScript::to_script_value(const QVariant& data)
+{
+    if (QMetaType::typeFlags(data.userType()) & QMetaType::PointerToQObject)
+        return script_object(data.value<QObject*>());
+
+    switch (data.type())
+    {
+    case QVariant::Invalid:
+        return QScriptValue();
+
+    case QVariant::List:
+    {
+        const QVariantList list = data.toList();
+        QScriptValue array = engine_->newArray(list.size());
+        quint32 index = 0;
+        for (const QVariant& value: list)
+            array.setProperty(index++, to_script_value(value));
+        return array;
+    }
+
+    case QVariant::Map:
+    {
+        const QVariantMap map = data.toMap();
+        QScriptValue obj = engine_->newObject();
+        for (auto it = map.cbegin(); it != map.cend(); ++it)
+            obj.setProperty(it.key(), to_script_value(it.value()));
+        return obj;
+    }
+
+    default:
+        return value_from_variant(engine_, data);
+    }
+}
+
+QScriptValue Script_Engine_QtScript::script_object(QObject* obj)
+{
+    if (!obj)
+        return engine_->nullValue();
+
+    auto it = objects_.find(obj);
+    if (it == objects_.end())
+        it = objects_.emplace(obj, engine_->newQObject(obj)).first;
+    return it->second;
+}
+
+void Script_Engine_QtScript::check_error(const QString& name, const QScriptValue& result) const
+{
+    if (result.isError())
+    {
+        qCCritical(ScriptEngineLog).noquote().nospace()
+                << name << ' ' << result.property("fileName").toString()
+                << '(' << result.property("lineNumber").toInt32() << "): "
+                << result.toString() << '\n' << backtrace().join('\n');
+    }
+}
+
+} // namespace Das
@@ -0,0 +1,88 @@
+#ifndef DAS_SCRIPT_ENGINE_QTSCRIPT_H
+#define DAS_SCRIPT_ENGINE_QTSCRIPT_H
+
+#include <map>
+
+#include <QScriptEngine>
+
+#include "script_engine.h"
+
+QT_FORWARD_DECLARE_CLASS(QScriptEngineDebugger)
+
+namespace Das {
+
+class Device_Item;
+
+// Engine with all script types, Params class and debugger window in debug build
+class Script_Engine_QtScript final : public Script_Engine
+{
+    Q_OBJECT
+public:
+    explicit Script_Engine_QtScript(Scripted_Scheme* scheme);
+    ~Script_Engine_QtScript();
+
+    QScriptValue to_script_value(const QVariant& data);
+
+    void reset() override;
+    void evaluate(const QString& code, const QString& file_name) override;
+    bool can_evaluate(const QString& code) const override;
+    QString console(const QString& code, bool& is_error) override;
+    QVariant call_function(const QString& name, const QVariantList& args) override;
+
+    QVariant api_property(const QStringList& path) const override;
+    void set_api_property(const QStringList& path, const QVariant& value) override;
+
+    bool is_handler(int handler_type, const QStringList& path) override;
+    QVariant call_handler(int handler_type, const QStringList& path, const QVariantList& args) override;
+
+    QStringList backtrace() const override;
+public slots:
+    // Called from scripts as api.engine
+    void connect_item_is_can_change(Device_Item* item, const QScriptValue& obj, const QScriptValue& func);
+    void connect_item_raw_to_display(Device_Item* item, const QScriptValue& obj, const QScriptValue& func);
+    void connect_item_display_to_raw(Device_Item* item, const QScriptValue& obj, const QScriptValue& func);
+private slots:
+    void handler_exception(const QScriptValue& exception);
+private:
+    template<typename T>
+    struct Type_Empty {
+        QScriptValue operator() (QScriptContext*, QScriptEngine*) {
+            return QScriptValue();
+        }
+    };
+    template<typename T>
+    struct Type_Default {
+        QScriptValue operator() (QScriptContext*, QScriptEngine* eng) {
+            return eng->newQObject(new T, QScriptEngine::ScriptOwnership);
+        }
+    };
+
+    template<typename T, template<typename> class P = Type_Empty, typename... Args>
+    void add_type();
+
+    template<typename T, typename... Args>
+    void add_type_n() { add_type<T, Type_Empty, Args...>(); }
+
+    void register_types();
+
+    QScriptValue api() const;
+    QScriptValue handler(int handler_type, const QStringList& path);
+    static QScriptValue value_from_variant(QScriptEngine* engine, const QVariant& data);
+    QScriptValue script_object(QObject* obj);
+    void check_error(const QString& name, const QScriptValue& result) const;
+
+    QScriptEngine* engine_;
+
+    std::map<int, QScriptValue> handlers_;
+
+    // Script wrappers of groups and items, they live until reset
+    std::map<QObject*, QScriptValue> objects_;
+
+#ifdef QT_DEBUG
+    QScriptEngineDebugger* debugger_ = nullptr;
+#endif
+};
+
+} // namespace Das
+
+#endif // DAS_SCRIPT_ENGINE_QTSCRIPT_H
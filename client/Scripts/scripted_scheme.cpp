@@ -10,28 +10,17 @@
 #include <QMetaEnum>
 #include <QProcess>
 
-#ifdef QT_DEBUG
-#include <QScriptEngineDebugger>
-#include <QMainWindow>
-#endif
-
 #include <Helpz/consolereader.h>
 #include <Helpz/db_builder.h>
 
 #include <Das/device.h>
 
 #include "scripted_scheme.h"
-#include "paramgroupclass.h"
-
-#include "tools/automationhelper.h"
-#include "tools/pidhelper.h"
-#include "tools/severaltimeshelper.h"
-#include "tools/inforegisterhelper.h"
+#include "script_engine_qtscript.h"
 
 #include "worker.h"
 #include "dbus_object.h"
 
-Q_DECLARE_METATYPE(std::string)
 Q_DECLARE_METATYPE(Das::SectionPtr)
 Q_DECLARE_METATYPE(Das::Type_Managers*)
 
@@ -41,62 +30,8 @@ Q_LOGGING_CATEGORY(ScriptLog, "script")
 Q_LOGGING_CATEGORY(ScriptEngineLog, "script.engine")
 Q_LOGGING_CATEGORY(ScriptDetailLog, "script.detail", QtInfoMsg)
 
-template<class T>
-QScriptValue sharedPtrToScriptValue(QScriptEngine *eng, const T &obj) {
-    return eng->newQObject(obj.get());
-}
-template<class T>
-void emptyFromScriptValue(const QScriptValue &, T &) {}
-
-QScriptValue stdstringToScriptValue(QScriptEngine *, const std::string& str)
-{ return QString::fromStdString(str); }
-
-// ------------------------------------------------------------------------------------
-
-template<class T>
-QScriptValue ptrToScriptValue(QScriptEngine *eng, const T& obj) {
-    return eng->newQObject(obj);
-}
-
-struct ArgumentGetter {
-    ArgumentGetter(QScriptContext* _ctx) : ctx(_ctx) {}
-    QScriptContext* ctx;
-    int arg_idx = 0;
-    QScriptValue operator() () {
-        return ctx->argument(arg_idx++);
-    }
-};
-
-template<typename T, template<typename> class P, typename... Args>
-void Scripted_Scheme::add_type()
-{
-    auto ctor = [](QScriptContext* ctx, QScriptEngine* script_engine_) -> QScriptValue {
-        if ((unsigned)ctx->argumentCount() >= sizeof...(Args))
-        {
-            ArgumentGetter get_arg(ctx);
-
-            auto obj = new T(qscriptvalue_cast<Args>(get_arg())...);
-            return script_engine_->newQObject(obj, QScriptEngine::ScriptOwnership);
-        }
-        return P<T>()(ctx, script_engine_);
-    };
-
-    auto value = script_engine_->newQMetaObject(&T::staticMetaObject,
-                                     script_engine_->newFunction(ctor));
-
-    QString name = T::staticMetaObject.className();
-
-    int four_dots = name.lastIndexOf("::");
-    if (four_dots >= 0)
-        name.remove(0, four_dots + 2);
-
-    script_engine_->globalObject().setProperty(name, value);
-
-//    qCDebug(SchemeLog) << "Register for script:" << name;
-}
-
 Scripted_Scheme::Scripted_Scheme(Worker* worker, Helpz::ConsoleReader *consoleReader, const QString &sshHost,
-                                   bool allow_shell, bool only_from_folder_if_exist) :
+                                   bool allow_shell, bool only_from_folder_if_exist, const QString& engine_name) :
     Scheme(),
     day_time_(this),
     uptime_(QDateTime::currentMSecsSinceEpoch()),
@@ -107,7 +42,7 @@ Scripted_Scheme::Scripted_Scheme(Worker* worker, Helpz::ConsoleReader *consoleRe
 {
     register_types();
 
-    script_engine_->pushContext();
+    script_engine_ = Script_Engine::create(engine_name, this);
     reinitialization();
 
     set_ssh_host(sshHost);
@@ -129,28 +64,9 @@ Scripted_Scheme::Scripted_Scheme(Worker* worker, Helpz::ConsoleReader *consoleRe
     }
 }
 
-#ifdef QT_DEBUG
-bool do_not_show_debugger = false;
-#endif
-
 Scripted_Scheme::~Scripted_Scheme()
 {
-#ifdef QT_DEBUG
-    if (debugger_)
-    {
-        // Если закрыть окно отладчика,
-        // то оно не откроется при перезагрузке кнопкой на сайте
-        // Работает, но пока не понятно на сколько это удобно и нужно
-        // Возможно лучше добавить диалоговое окно при закрытии отладчика
-//        do_not_show_debugger = debugger_->standardWindow()->isHidden();
-
-        debugger_->standardWindow()->close();
-        debugger_->detach();
-        delete debugger_;
-    }
-#endif
 //    delete db();
-    script_engine_->popContext();
 }
 
 void Scripted_Scheme::set_ssh_host(const QString &value) { if (ssh_host_ != value) ssh_host_ = value; }
@@ -159,8 +75,9 @@ qint64 Scripted_Scheme::uptime() const { return uptime_; }
 
 void Scripted_Scheme::reinitialization()
 {
-    script_engine_->popContext();
-    /*QScriptContext* ctx = */script_engine_->pushContext();
+    // Groups and items will be recreated
+    item_changes_.clear();
+    script_engine_->reset();
 
     std::unique_ptr<DB::Helper> db(new DB::Helper(Helpz::DB::Connection_Info::common(),
                                                               "SchemeManager_" + QString::number((quintptr)this)));
@@ -175,12 +92,13 @@ void Scripted_Scheme::reinitialization()
     // qScriptConnect(&m_dayTime, SIGNAL(onDayPartChanged(Section*,bool)), QScriptValue(), m_func.at(FUNC_CHANGED_DAY_PART));
     connect(&day_time_, &DayTimeHelper::onDayPartChanged, [this](Section* sct, bool is_day)
     {
-        call_function(FUNC_CHANGED_DAY_PART, { script_engine_->newQObject(sct), is_day });
+        call_function(FUNC_CHANGED_DAY_PART, { Script_Engine::object(sct), is_day });
     });
 
     db->init_scheme(this, true);
+    script_engine_->structure_changed();
 
-    if (get_handler(FUNC_CHANGED_DAY_PART).isFunction())
+    if (script_engine_->is_handler(FUNC_CHANGED_DAY_PART, handler_path(FUNC_CHANGED_DAY_PART)))
         day_time_.init();
 
     for(Section* sct: sections())
@@ -194,7 +112,7 @@ void Scripted_Scheme::reinitialization()
 
             connect(group, &Device_item_Group::connection_state_change, this, &Scripted_Scheme::sct_connection_state_change);
 
-            if (get_handler(FUNC_CONTROL_CHANGE_CHECK).isFunction())
+            if (script_engine_->is_handler(FUNC_CONTROL_CHANGE_CHECK, handler_path(FUNC_CONTROL_CHANGE_CHECK)))
             {
                 // TODO: move to Device
             }
@@ -202,6 +120,7 @@ void Scripted_Scheme::reinitialization()
     }
 
     call_function(FUNC_AFTER_DATABASE_INIT);
+    emit structure_reinitialized();
 }
 
 void Scripted_Scheme::register_types()
@@ -213,76 +132,28 @@ void Scripted_Scheme::register_types()
 
     qRegisterMetaType<AutomationHelper*>("AutomationHelper*");
 
-    script_engine_ = new QScriptEngine(this);
-#ifdef QT_DEBUG
-    if (qApp->thread() == thread() && !do_not_show_debugger)
-    {
-        debugger_ = new QScriptEngineDebugger(this);
-        debugger_->attachTo(script_engine_);
-        debugger_->standardWindow()->show();
-    }
-#endif
-
-    connect(script_engine_, &QScriptEngine::signalHandlerException,
-            this, &Scripted_Scheme::handler_exception);
-
-    add_type<QTimer>();
-    add_type<QProcess>();
-
-    add_type<AutomationHelper, Type_Default, uint>();
-
-    add_type_n<AutomationHelperItem, Device_item_Group*>();
-    add_type_n<SeveralTimesHelper, Device_item_Group*>();
-    add_type_n<PIDHelper, Device_item_Group*, uint>();
-    add_type_n<InfoRegisterHelper, Device_item_Group*, uint, uint>();
-
-    add_type_n<Section, uint32_t, QString, uint32_t, uint32_t>();
-    add_type_n<Device_item_Group, uint32_t, QString, uint32_t, uint32_t, uint32_t>();
-
     qRegisterMetaType<Sections>("Sections");
-    qScriptRegisterSequenceMetaType<Sections>(script_engine_);
-
     qRegisterMetaType<Devices>("Devices");
-    qScriptRegisterSequenceMetaType<Devices>(script_engine_);
 
     qRegisterMetaType<Device_Item*>("Device_Item*");
     qRegisterMetaType<Device_Items>("Device_Items");
-    qScriptRegisterSequenceMetaType<Device_Items>(script_engine_);
 
     qRegisterMetaType<QVector<Device_Item*>>("QVector<Device_Item*>"); // REVIEW а разве не тоже самое, что и  qRegisterMetaType<Device_Items>("Device_Items");
-    qScriptRegisterSequenceMetaType<QVector<Device_Item*>>(script_engine_);
-
     qRegisterMetaType<QVector<Device_item_Group*>>("QVector<Device_item_Group*>");
-    qScriptRegisterSequenceMetaType<QVector<Device_item_Group*>>(script_engine_);
 
     qRegisterMetaType<AutomationHelperItem*>("AutomationHelperItem*");
-
-//    qScriptRegisterMetaType<SectionPtr>(eng, sharedPtrToScriptValue<SectionPtr>, emptyFromScriptValue<SectionPtr>);
-    qScriptRegisterMetaType<std::string>(script_engine_, stdstringToScriptValue, emptyFromScriptValue<std::string>);
-//    qScriptRegisterMetaType<Device_Item*>(eng, )
-
-//    qScriptRegisterMetaType<Device_Item::ValueType>(eng, itemValueToScriptValue, itemValueFromScriptValue);
-    //    qScriptRegisterSequenceMetaType<Device_Item::ValueList>(eng);
-
-    //    qScriptRegisterSequenceMetaType<Device_Item::ValueList>(eng);
-
-    auto paramClass = new ParamGroupClass(script_engine_);
-    script_engine_->globalObject().setProperty("Params", paramClass->constructor());
-
-//    eng->globalObject().setProperty("ParamElem", paramClass->constructor());
 }
 
 template<typename T>
-void init_types(QScriptValue& parent, const QString& prop_name, DB::Base_Type_Manager<T>& type_mng)
+void init_types(Script_Engine* script_engine, const QString& prop_name, DB::Base_Type_Manager<T>& type_mng)
 {
-    QScriptValue types_obj = parent.property(prop_name);
     QString name;
     for (const T& type: type_mng.types())
     {
         name = type.name();
         if (!name.isEmpty())
         {
-            types_obj.setProperty(name, type.id());
+            script_engine->set_api_property({"type", prop_name, name}, type.id());
         }
     }
 }
@@ -297,7 +168,7 @@ void Scripted_Scheme::scripts_initialization(const QVector<Code_Item>& code_vect
             if (script_file.open(QIODevice::ReadOnly | QFile::Text))
             {
                 QTextStream stream(&script_file);
-                check_error(script_file.fileName(), stream.readAll());
+                evaluate(script_file.fileName(), stream.readAll());
                 script_file.close();
             }
             else
@@ -309,40 +180,23 @@ void Scripted_Scheme::scripts_initialization(const QVector<Code_Item>& code_vect
 
     read_script_file(":/Scripts/js/api.js");
 
-    QScriptValue api = get_api_obj();
-    api.setProperty("mng", script_engine_->newQObject(this));
-
-    QScriptValue statuses = api.property("status");
-    QScriptValue common_status = script_engine_->newObject();
-    api.setProperty("common_status", common_status);
+    script_engine_->set_api_property({"mng"}, Script_Engine::object(this));
+    script_engine_->set_api_property({"engine"}, Script_Engine::object(script_engine_));
+    script_engine_->set_api_property({"common_status"}, QVariantMap());
 
     // Многие статусы могут пренадлежать одному типу группы.
-    QString status_name;
-    QScriptValue status_group_property;
     for (DIG_Status_Type& type: *status_mng_.get_types())
     {
         if (type.group_type_id)
-        {
-            status_name = group_type_mng_.name(type.group_type_id);
-            status_group_property = statuses.property(status_name);
-            if (!status_group_property.isObject())
-            {
-                status_group_property = script_engine_->newObject();
-                statuses.setProperty(status_name, status_group_property);
-            }
-            status_group_property.setProperty(type.name(), type.id());
-        }
+            script_engine_->set_api_property({"status", group_type_mng_.name(type.group_type_id), type.name()}, type.id());
         else
-        {
-            common_status.setProperty(type.name(), type.id());
-        }
+            script_engine_->set_api_property({"common_status", type.name()}, type.id());
     }
 
-    QScriptValue types = api.property("type");
-    init_types(types, "item", device_item_type_mng_);
-    init_types(types, "group", group_type_mng_);
-    init_types(types, "mode", dig_mode_type_mng_);
-    init_types(types, "param", param_mng_);
+    init_types(script_engine_, "item", device_item_type_mng_);
+    init_types(script_engine_, "group", group_type_mng_);
+    init_types(script_engine_, "mode", dig_mode_type_mng_);
+    init_types(script_engine_, "param", param_mng_);
 
     // Begin load user scripts
 
@@ -371,34 +225,27 @@ void Scripted_Scheme::scripts_initialization(const QVector<Code_Item>& code_vect
     if (!only_from_folder_if_exist_ || !QDir(script_dir_path).exists())
     {
         for (const Code_Item& code_item: code_vect)
-            check_error(code_item.name(), code_item.text);
+            evaluate(code_item.name(), code_item.text);
     }
 
     load_scripts_from_dir(script_dir_path);
 
     // Begin search for handlers in loaded scripts
 
-    QScriptValue group_handler_obj = get_handler("changed", "group"), group_handler;
     for (const DIG_Type& type: group_type_mng_.types())
     {
         if (type.name().isEmpty())
             qCDebug(ScriptDetailLog) << "Group type" << type.id() << type.name() << "havent latin name";
-        else
-        {
-            group_handler = group_handler_obj.property(type.name());
-            if (group_handler.isFunction())
-                cache_handler_.emplace(FUNC_COUNT + type.id(), group_handler);
-            else
-                qCDebug(ScriptDetailLog) << "Group type" << type.id() << type.name() << "havent 'changed' function" << group_handler_obj.toString();
-        }
+        else if (!script_engine_->is_handler(FUNC_COUNT + type.id(), handler_path(FUNC_COUNT + type.id())))
+            qCDebug(ScriptDetailLog) << "Group type" << type.id() << type.name() << "havent 'changed' function";
     }
 
     // Begin load script checkers
 
-    QScriptValue checker_list = api.property("checker");
-    if (checker_list.isArray())
+    const QVariant checker_list = script_engine_->api_property({"checker"});
+    if (checker_list.type() == QVariant::List)
     {
-        int length = checker_list.property("length").toInt32();
+        int length = checker_list.toList().size();
         for (int i = 0; i < length; ++i)
         {
             // TODO: Load Script checkers
@@ -412,30 +259,11 @@ Section *Scripted_Scheme::add_section(Section&& section)
     auto sct = Scheme::add_section(std::move(section));
     connect(sct, &Section::group_initialized, this, &Scripted_Scheme::group_initialized);
 
-    call_function(FUNC_INIT_SECTION, { script_engine_->newQObject(sct) });
+    script_engine_->structure_changed();
+    call_function(FUNC_INIT_SECTION, { Script_Engine::object(sct) });
     return sct;
 }
 
-QScriptValue Scripted_Scheme::value_from_variant(const QVariant &data) const
-{
-    switch (data.type()) {
-    case QVariant::Bool:                return data.toBool();
-    case QVariant::String:              return data.toString();
-    case QVariant::Int:                 return data.toInt();
-    case QVariant::UInt:                return data.toUInt();
-    case QVariant::LongLong:
-    case QVariant::ULongLong:
-    case QVariant::Double:              return data.toDouble();
-    case QVariant::Date:
-    case QVariant::Time:
-    case QVariant::DateTime:            return script_engine_->newDate(data.toDateTime());
-    case QVariant::RegExp:
-    case QVariant::RegularExpression:   return script_engine_->newRegExp(data.toRegExp());
-    default:
-        return  script_engine_->newVariant(data);
-    }
-}
-
 bool Scripted_Scheme::stop(uint32_t user_id)
 {
     return can_restart(true, user_id);
@@ -443,11 +271,10 @@ bool Scripted_Scheme::stop(uint32_t user_id)
 
 bool Scripted_Scheme::can_restart(bool stop, uint32_t user_id)
 {
-    QScriptValue can_restart = get_api_obj().property("handlers").property("can_restart");
-    if (can_restart.isFunction())
+    if (script_engine_->is_handler(-1, {"can_restart"}))
     {
-        QScriptValue ret = can_restart.call(QScriptValue(), QScriptValueList{stop, user_id});
-        if (ret.isBool() && !ret.toBool())
+        QVariant ret = script_engine_->call_handler(-1, {"can_restart"}, {stop, user_id});
+        if (ret.type() == QVariant::Bool && !ret.toBool())
         {
             return false;
         }
@@ -458,14 +285,14 @@ bool Scripted_Scheme::can_restart(bool stop, uint32_t user_id)
 
 QStringList Scripted_Scheme::backtrace() const
 {
-    return script_engine_->currentContext()->backtrace();
+    return script_engine_->backtrace();
 }
 
 void Scripted_Scheme::log(const QString &msg, uint8_t type_id, uint32_t user_id, bool inform_flag, bool print_backtrace)
 {
     Log_Event_Item event{ QDateTime::currentDateTimeUtc().toMSecsSinceEpoch(), user_id, inform_flag, type_id, ScriptLog().categoryName(), msg };
     if (print_backtrace)
-        event.set_text(event.text() + "\n\n" + script_engine_->currentContext()->backtrace().join('\n'));
+        event.set_text(event.text() + "\n\n" + script_engine_->backtrace().join('\n'));
     std::cerr << "[script] " << event.text().toStdString() << std::endl;
     add_event_message(std::move(event));
 }
@@ -474,62 +301,26 @@ void Scripted_Scheme::console(uint32_t user_id, const QString &cmd, bool is_func
 {
     if (is_function)
     {
-        QScriptValueList arg_list;
-        for (const QVariant& arg: arguments)
-            arg_list.push_back(script_engine_->newVariant(arg));
-
-        QScriptValue func = script_engine_->currentContext()->activationObject().property(cmd);
-        QScriptValue ret = func.call(QScriptValue(), arg_list);
-        check_error( "exec", ret);
+        script_engine_->call_function(cmd, arguments);
         return;
     }
 
     QString script = cmd.trimmed();
-    if (script.isEmpty() || !script_engine_->canEvaluate(script))
+    if (script.isEmpty() || !script_engine_->can_evaluate(script))
         return;
 
-    QScriptValue res = script_engine_->evaluate(script, "CONSOLE");
+    bool is_error = false;
+    const QString res = script_engine_->console(script, is_error);
 
-    bool is_error = res.isError();
-
-    if (!res.isUndefined())
-    {
-        if (!res.isError() && (res.isObject() || res.isArray()))
-        {
-            QScriptValue check_func = script_engine_->evaluate(
-                "(function(key, value) {"
-                "  if ((typeof value === 'object' || typeof value === 'function') && "
-                "      value !== null && !Array.isArray(value) && value.toString() !== '[object Object]') {"
-                "    return value.toString();"
-                "  }"
-                "  return value;"
-                "})");
-            res = script_engine_->evaluate("JSON.stringify").call(QScriptValue(), {res, check_func, ' '});
-        }
-
-        if (res.isError())
-        {
-            res = res.property("message");
-            is_error = true;
-        }
-    }
     Log_Event_Item event{ QDateTime::currentDateTimeUtc().toMSecsSinceEpoch(), user_id, false, is_error ? QtCriticalMsg : QtInfoMsg,
-                ScriptLog().categoryName(), "CONSOLE [" + script + "] >" + res.toString() };
+                ScriptLog().categoryName(), "CONSOLE [" + script + "] >" + res };
     std::cerr << event.text().toStdString() << std::endl;
     add_event_message(std::move(event));
 }
 
-QScriptValue Scripted_Scheme::call_function(int handler_type, const QScriptValueList& args) const
+QVariant Scripted_Scheme::call_function(int handler_type, const QVariantList& args) const
 {
-    QScriptValue handler = get_handler(handler_type);
-    if (handler.isFunction())
-    {
-        QScriptValue ret = handler.call(QScriptValue(), args);
-        check_error( handler_type, ret);
-        return ret;
-    }
-
-    return QScriptValue();
+    return script_engine_->call_handler(handler_type, handler_path(handler_type), args);
 }
 
 void Scripted_Scheme::dig_mode_changed(uint32_t user_id, uint32_t mode_id, uint32_t group_id)
@@ -540,10 +331,10 @@ void Scripted_Scheme::dig_mode_changed(uint32_t user_id, uint32_t mode_id, uint3
 
     emit dig_mode_available(group->mode_data());
 
-    QScriptValue groupObj = script_engine_->newQObject(group);
+    const QVariant groupObj = Script_Engine::object(group);
 
     call_function(FUNC_CHANGED_MODE, { groupObj, mode_id, user_id });
-    call_function(FUNC_COUNT + group->type_id(), { groupObj, QScriptValue(), user_id });
+    call_function(FUNC_COUNT + group->type_id(), { groupObj, QVariant(), user_id });
 }
 
 void Scripted_Scheme::dig_param_changed(Param* param, uint32_t user_id)
@@ -555,10 +346,9 @@ void Scripted_Scheme::dig_param_changed(Param* param, uint32_t user_id)
     DIG_Param_Value dig_param_value{DB::Log_Base_Item::current_timestamp(), user_id, param->id(), param->value().toString()};
     emit param_value_changed(dig_param_value);
 
-    call_function(FUNC_COUNT + group->type_id(), { script_engine_->newQObject(group), QScriptValue(), user_id });
+    call_function(FUNC_COUNT + group->type_id(), { Script_Engine::object(group), QVariant(), user_id });
 }
 
-QElapsedTimer t;
 void Scripted_Scheme::item_changed(Device_Item *item, uint32_t user_id, const QVariant& old_raw_value)
 {
     if (!item)
@@ -578,27 +368,60 @@ void Scripted_Scheme::item_changed(Device_Item *item, uint32_t user_id, const QV
     log_value_item.set_need_to_save(immediately);
     emit log_item_available(log_value_item);
 
-    QScriptValue groupObj = script_engine_->newQObject(group);
-    QScriptValue itemObj = script_engine_->newQObject(item);
+    // One Device::set_device_items_values call changes many items at once,
+    // so handlers is called for the whole burst after it. Every change is kept in order,
+    // so item changed twice is handled twice.
+    if (item_changes_.empty())
+        QMetaObject::invokeMethod(this, "process_item_changes", Qt::QueuedConnection);
 
-    QScriptValueList args { groupObj, itemObj, user_id, value_from_variant(old_raw_value) };
+    item_changes_.push_back(Item_Change{group, item, user_id, old_raw_value});
+}
 
-    t.restart();
-    call_function(FUNC_CHANGED_ITEM, args);
+void Scripted_Scheme::process_item_changes()
+{
+    const std::vector<Item_Change> changes = std::move(item_changes_);
+    item_changes_.clear();
 
-    if (item->is_control())
-        call_function(FUNC_CHANGED_CONTROL, args);
-    else
-        call_function(FUNC_CHANGED_SENSOR, args);
+    if (changes.empty())
+        return;
 
-    call_function(FUNC_COUNT + group->type_id(), args);
+    QElapsedTimer t;
+    t.start();
+
+    const bool is_items_handler = script_engine_->is_handler(FUNC_CHANGED_ITEMS, handler_path(FUNC_CHANGED_ITEMS));
+    QVariantList items_array;
+
+    for (const Item_Change& change: changes)
+    {
+        const QVariant groupObj = Script_Engine::object(change.group_);
+        const QVariant itemObj = Script_Engine::object(change.item_);
+
+        const QVariantList args { groupObj, itemObj, change.user_id_, change.old_raw_value_ };
+
+        call_function(FUNC_CHANGED_ITEM, args);
+
+        if (change.item_->is_control())
+            call_function(FUNC_CHANGED_CONTROL, args);
+        else
+            call_function(FUNC_CHANGED_SENSOR, args);
+
+        call_function(FUNC_COUNT + change.group_->type_id(), args);
+
+        if (is_items_handler)
+        {
+            items_array.push_back(QVariantMap{
+                {"group", groupObj}, {"item", itemObj}, {"user_id", change.user_id_}, {"old_value", change.old_raw_value_}
+            });
+        }
+    }
+
+    if (is_items_handler)
+        call_function(FUNC_CHANGED_ITEMS, { QVariant(items_array) });
 
 //    eng->collectGarbage();
 
     if (t.elapsed() > 500)
-        qCWarning(ScriptEngineLog) << "item_changed timeout" << t.elapsed();
-
-    t.invalidate();
+        qCWarning(ScriptEngineLog) << "item_changed timeout" << t.elapsed() << "changes:" << changes.size();
 }
 
 void Scripted_Scheme::after_all_initialization()
@@ -642,45 +465,6 @@ QVariantMap Scripted_Scheme::run_command(const QString &programm, const QVariant
     return result;
 }
 
-void Scripted_Scheme::connect_item_is_can_change(Device_Item *item, const QScriptValue& obj, const QScriptValue& func)
-{
-    if (item && func.isFunction())
-    {
-        connect(item, &Device_Item::is_can_change, [this, obj, func](const QVariant& display_value, uint32_t user_id) -> bool
-        {
-            QScriptValue f = func;
-            QScriptValue res = f.call(obj, QScriptValueList{ value_from_variant(display_value), user_id });
-            return res.toBool();
-        });
-    }
-}
-
-void Scripted_Scheme::connect_item_raw_to_display(Device_Item *item, const QScriptValue &obj, const QScriptValue &func)
-{
-    if (item && func.isFunction())
-    {
-        connect(item, &Device_Item::raw_to_display, [this, obj, func](const QVariant& data) -> QVariant
-        {
-            QScriptValue f = func;
-            QScriptValue res = f.call(obj, QScriptValueList{ value_from_variant(data) });
-            return res.toVariant();
-        });
-    }
-}
-
-void Scripted_Scheme::connect_item_display_to_raw(Device_Item *item, const QScriptValue &obj, const QScriptValue &func)
-{
-    if (item && func.isFunction())
-    {
-        connect(item, &Device_Item::display_to_raw, [this, obj, func](const QVariant& data) -> QVariant
-        {
-            QScriptValue f = func;
-            QScriptValue res = f.call(obj, QScriptValueList{ value_from_variant(data) });
-            return res.toVariant();
-        });
-    }
-}
-
 QVector<DIG_Status> Scripted_Scheme::get_group_statuses() const
 {
     QVector<DIG_Status> status_vect;
@@ -751,49 +535,21 @@ void Scripted_Scheme::write_to_item_file(const QString& file_name)
 
 void Scripted_Scheme::group_initialized(Device_item_Group* group)
 {
-    QString group_type_name = group_type_mng_.name(group->type_id()),
-            func_name = "api.handlers.group.initialized." + group_type_name;
-    QScriptValue group_handler_obj = get_handler("initialized", "group");
-    QScriptValue group_handler_init = group_handler_obj.property(group_type_name);
+    const QString group_type_name = group_type_mng_.name(group->type_id());
+    const QStringList path{"group", "initialized", group_type_name};
 
-    if (group_handler_init.isFunction())
-    {
-        auto ret = group_handler_init.call(QScriptValue(), QScriptValueList{ script_engine_->newQObject(group) });
-        check_error( func_name, ret);
-    }
+    script_engine_->structure_changed();
+
+    if (script_engine_->is_handler(-1, path))
+        script_engine_->call_handler(-1, path, { Script_Engine::object(group) });
     else
-        qCDebug(ScriptDetailLog) << "Group type" << group->type_id() << group_type_name << "havent init function" << func_name;
+        qCDebug(ScriptDetailLog) << "Group type" << group->type_id() << group_type_name << "havent init function" << "api.handlers." + path.join('.');
 }
 
 bool Scripted_Scheme::control_change_check(Device_Item *item, const QVariant &display_value, uint32_t user_id)
 {
-    auto ret = call_function(FUNC_CONTROL_CHANGE_CHECK, { script_engine_->newQObject(sender()), script_engine_->newQObject(item), value_from_variant(display_value), user_id });
-    return ret.isBool() && ret.toBool();
-}
-
-void Scripted_Scheme::handler_exception(const QScriptValue &exception)
-{
-    if (script_engine_->hasUncaughtException())
-        qCCritical(ScriptEngineLog) << "Exception:" << exception.toString() << script_engine_->uncaughtExceptionBacktrace()
-                                    << '\n' << backtrace().join('\n');
-}
-
-QString Scripted_Scheme::handler_full_name(int handler_type) const
-{
-    QPair<QString,QString> names;
-    if (handler_type > FUNC_COUNT)
-    {
-        handler_type -= FUNC_COUNT;
-        names.first = "group";
-        names.second = "changed." + group_type_mng_.name(handler_type);
-    }
-    else
-        names = handler_name(handler_type);
-    QString full_name = "api.handlers.";
-    if (!names.first.isEmpty())
-        full_name += names.first + '.';
-    full_name += names.second;
-    return full_name;
+    auto ret = call_function(FUNC_CONTROL_CHANGE_CHECK, { Script_Engine::object(sender()), Script_Engine::object(item), display_value, user_id });
+    return ret.type() == QVariant::Bool && ret.toBool();
 }
 
 QPair<QString,QString> Scripted_Scheme::handler_name(int handler_type) const
@@ -816,74 +572,30 @@ QPair<QString,QString> Scripted_Scheme::handler_name(int handler_type) const
     case FUNC_AFTER_DATABASE_INIT:          return {database, initialized};
     case FUNC_CHECK_VALUE:                  return {{}, "check_value"};
     case FUNC_GROUP_STATUS:                 return {{}, "group_status"};
+    case FUNC_CHANGED_ITEMS:                return {changed, "items"};
     default:
         break;
     }
     return {};
 }
 
-QScriptValue Scripted_Scheme::get_api_obj() const
+QStringList Scripted_Scheme::handler_path(int handler_type) const
 {
-    return script_engine_->currentContext()->activationObject().property("api");
-}
-
-QScriptValue Scripted_Scheme::get_handler(int handler_type) const
-{
-    auto it = cache_handler_.find(handler_type);
-    if (it != cache_handler_.cend())
-    {
-        return it->second;
-    }
-    auto name_pair = handler_name(handler_type);
-    QScriptValue handler = get_handler(name_pair.second, name_pair.first);
-    if (handler.isFunction())
-        cache_handler_.emplace(handler_type, handler);
-    else
-        qCDebug(ScriptDetailLog) << "Can not find:" << handler_full_name(handler_type);
-    return handler;
-}
-
-QScriptValue Scripted_Scheme::get_handler(const QString& name, const QString& parent_name) const
-{
-    QScriptValue obj = get_api_obj().property("handlers");
-    if (!parent_name.isEmpty())
-    {
-        obj = obj.property(parent_name);
-        if (!obj.isValid())
-        {
-            qCDebug(ScriptDetailLog) << "Can not find property" << parent_name << "in api.handlers";
-            return obj;
-        }
-    }
-    return obj.property(name);
-}
-
-void Scripted_Scheme::check_error(int handler_type, const QScriptValue& result) const
-{
-    if (result.isError())
-    {
-        check_error(handler_full_name(handler_type), result);
-        cache_handler_.erase(handler_type);
-    }
-}
+    if (handler_type > FUNC_COUNT)
+        return {"group", "changed", group_type_mng_.name(handler_type - FUNC_COUNT)};
 
-void Scripted_Scheme::check_error(const QString& str, const QScriptValue& result) const
-{
-    if (result.isError())
-    {
-        qCCritical(ScriptEngineLog).noquote().nospace()
-                << str << ' ' << result.property("fileName").toString()
-                << '(' << result.property("lineNumber").toInt32() << "): "
-                << result.toString() << '\n' << backtrace().join('\n');
-    }
+    const QPair<QString,QString> names = handler_name(handler_type);
+    if (names.first.isEmpty())
+        return {names.second};
+    return {names.first, names.second};
 }
 
-void Scripted_Scheme::check_error(const QString &name, const QString &code) const
+void Scripted_Scheme::evaluate(const QString &name, const QString &code) const
 {
     if (code.isEmpty())
         qCWarning(SchemeLog) << "Attempt to evaluate a empty file:" << name;
     else
-        check_error(name, script_engine_->evaluate(code, name));
+        script_engine_->evaluate(code, name);
 }
 
 } // namespace Das
@@ -1,7 +1,6 @@
 #ifndef DAS_SCRIPTED_SCHEME_H
 #define DAS_SCRIPTED_SCHEME_H
 
-#include <QScriptEngine>
 #include <QtSerialBus/qmodbusdataunit.h>
 
 #include <Helpz/simplethread.h>
@@ -15,10 +14,6 @@
 #include "tools/daytimehelper.h"
 #include "tools/automationhelper.h"
 
-QT_FORWARD_DECLARE_CLASS(QScriptEngineDebugger)
-
-class QScriptEngine;
-
 namespace Helpz {
 class ConsoleReader;
 }
@@ -26,6 +21,7 @@ class ConsoleReader;
 namespace Das {
 
 class Worker;
+class Script_Engine;
 
 class AutomationHelper;
 class DayTimeHelper;
@@ -49,21 +45,20 @@ public:
         FUNC_AFTER_DATABASE_INIT,
         FUNC_CHECK_VALUE,
         FUNC_GROUP_STATUS,
+        FUNC_CHANGED_ITEMS,
 
         FUNC_COUNT
     };
     Q_ENUM(Handler_Type)
 
     Scripted_Scheme(Worker* worker, Helpz::ConsoleReader* consoleReader, const QString &sshHost,
-                     bool allow_shell, bool only_from_folder_if_exist = false);
+                     bool allow_shell, bool only_from_folder_if_exist = false, const QString& engine_name = "qtscript");
     ~Scripted_Scheme();
 
     void set_ssh_host(const QString &value);
 
     qint64 uptime() const;
     Section *add_section(Section&& section) override;
-
-    QScriptValue value_from_variant(const QVariant& data) const;
 signals:
     void param_value_changed(const DIG_Param_Value& param_value);
     void sct_connection_state_change(Device_Item*, bool value);
@@ -82,6 +77,7 @@ signals:
 //    void modbusWrite(int server, uchar registerType, int unit, quint16 state);
 
     void day_time_changed(/*Section* sct*/);
+    void structure_reinitialized();
 public slots:
     bool stop(uint32_t user_id = 0);
     bool can_restart(bool stop = false, uint32_t user_id = 0);
@@ -95,10 +91,6 @@ public slots:
     void ssh(uint32_t remote_port = 25589, const QString &user_name = "root", quint16 port = 22);
     QVariantMap run_command(const QString& programm, const QVariantList& args = QVariantList(), int timeout_msec = 5000) const;
 
-    void connect_item_is_can_change(Device_Item *item, const QScriptValue& obj, const QScriptValue& func);
-    void connect_item_raw_to_display(Device_Item *item, const QScriptValue& obj, const QScriptValue& func);
-    void connect_item_display_to_raw(Device_Item *item, const QScriptValue& obj, const QScriptValue& func);
-
     QVector<DIG_Status> get_group_statuses() const;
     QVector<Device_Item_Value> get_device_item_values() const;
 
@@ -114,47 +106,32 @@ private slots:
     void dig_mode_changed(uint32_t user_id, uint32_t mode_id, uint32_t group_id);
     void dig_param_changed(Param *param, uint32_t user_id = 0);
     void item_changed(Device_Item* item, uint32_t user_id, const QVariant& old_raw_value);
-    void handler_exception(const QScriptValue &exception);
+    void process_item_changes();
 private:
-    QString handler_full_name(int handler_type) const;
     QPair<QString, QString> handler_name(int handler_type) const;
-    QScriptValue get_api_obj() const;
-    QScriptValue get_handler(int handler_type) const;
-    QScriptValue get_handler(const QString& name, const QString& parent_name) const;
-    void check_error(int handler_type, const QScriptValue &result) const;
-    void check_error(const QString &str, const QScriptValue &result) const;
-    void check_error(const QString &name, const QString &code) const;
-
-    template<typename T>
-    struct Type_Empty {
-        QScriptValue operator() (QScriptContext*, QScriptEngine*) {
-            return QScriptValue();
-        }
-    };
-    template<typename T>
-    struct Type_Default {
-        QScriptValue operator() (QScriptContext*, QScriptEngine* eng) {
-            return eng->newQObject(new T, QScriptEngine::ScriptOwnership);
-        }
-    };
-
-    template<typename T, template<typename> class P = Type_Empty, typename... Args>
-    void add_type();
-
-    template<typename T, typename... Args>
-    void add_type_n() { add_type<T, Type_Empty, Args...>(); }
+    QStringList handler_path(int handler_type) const;
+    void evaluate(const QString &name, const QString &code) const;
 
     void register_types();
     void scripts_initialization(const QVector<Code_Item> &code_vect);
-    QScriptValue call_function(int handler_type, const QScriptValueList& args = QScriptValueList()) const;
+    QVariant call_function(int handler_type, const QVariantList& args = QVariantList()) const;
 
-    QScriptEngine *script_engine_;
+    Script_Engine *script_engine_;
 
     DayTimeHelper day_time_;
 
     qint64 uptime_;
 
-    mutable std::map<uint32_t, QScriptValue> cache_handler_;
+    struct Item_Change
+    {
+        Device_item_Group* group_;
+        Device_Item* item_;
+        uint32_t user_id_;
+        QVariant old_raw_value_;
+    };
+    // Item change handlers isn't called from item_changed, they are queued
+    // and called by process_item_changes on next event loop pass.
+    std::vector<Item_Change> item_changes_;
 
     std::pair<uint32_t, uint32_t> last_file_item_and_user_id_;
 
@@ -163,10 +140,6 @@ private:
     qint64 pid = -1;
 
     Worker* worker_;
-
-#ifdef QT_DEBUG
-    QScriptEngineDebugger* debugger_ = nullptr;
-#endif
 };
 
 } // namespace Das
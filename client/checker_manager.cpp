@@ -51,6 +51,7 @@ Manager::Manager(Worker *worker, QObject *parent) :
     {
         last_check_time_map_.insert(dev->id(), { true, 0 });
     }
+    start_plugin_workers();
     check_devices(); // Первый опрос контроллеров
     first_check_ = false;
 
@@ -60,6 +61,7 @@ Manager::Manager(Worker *worker, QObject *parent) :
 Manager::~Manager()
 {
     stop();
+    stop_plugin_workers();
 
     for (const Plugin_Type& plugin: plugin_type_mng_->types())
         if (plugin.loader && !plugin.loader->unload())
@@ -171,13 +173,46 @@ void Manager::loadPlugins(Worker *worker)
     }
 }
 
+void Manager::start_plugin_workers()
+{
+    for (Plugin_Type& plugin: *plugin_type_mng_->get_types())
+    {
+        if (plugin.loader && plugin.checker)
+        {
+            Plugin_Worker_Item item{std::make_unique<Plugin_Worker_Shared>(), nullptr};
+            item.shared_->is_break_ = b_break;
+            item.thread_ = new Plugin_Worker_Thread(scheme_, &plugin, item.shared_.get());
+            item.thread_->start();
+            plugin_workers_.emplace(&plugin, std::move(item));
+
+            qCDebug(Log) << "Plugin" << plugin.name() << "checks in own thread";
+        }
+    }
+}
+
+void Manager::stop_plugin_workers()
+{
+    for (auto& it: plugin_workers_)
+    {
+        it.second.thread_->quit();
+        if (!it.second.thread_->wait(15000))
+            it.second.thread_->terminate();
+        delete it.second.thread_;
+    }
+    plugin_workers_.clear();
+}
+
 void Manager::break_checking()
 {
     b_break = true;
 
-    for (const Plugin_Type& plugin: plugin_type_mng_->types())
-        if (plugin.loader && plugin.checker)
-            plugin.checker->stop();
+    // Plugin is stopped in its worker thread. Worker that isn't created yet doesn't start checking.
+    for (auto& it: plugin_workers_)
+    {
+        it.second.shared_->is_break_ = true;
+        if (Plugin_Worker* worker = it.second.shared_->worker_)
+            QMetaObject::invokeMethod(worker, "stop", Qt::QueuedConnection);
+    }
 }
 
 void Manager::stop()
@@ -193,6 +228,14 @@ void Manager::stop()
 void Manager::start()
 {
     qCDebug(Log) << "Start check";
+
+    for (auto& it: plugin_workers_)
+    {
+        it.second.shared_->is_break_ = false;
+        if (Plugin_Worker* worker = it.second.shared_->worker_)
+            QMetaObject::invokeMethod(worker, "start", Qt::QueuedConnection);
+    }
+
     check_devices();
 }
 
@@ -203,7 +246,8 @@ void Manager::check_devices()
     qint64 next_shot, min_shot = QDateTime::currentMSecsSinceEpoch() + 60000, now_ms;
     for (Device* dev: scheme_->devices())
     {
-        if (dev->check_interval() <= 0)
+        if (dev->check_interval() <= 0
+            || plugin_workers_.find(dev->checker_type()) != plugin_workers_.cend())
         {
             continue;
         }
@@ -299,8 +343,13 @@ void Manager::toggle_stream(uint32_t user_id, Device_Item *item, bool state)
         return;
 
     Plugin_Type* plugin = item->device()->checker_type();
-    if (plugin && plugin->checker)
-        plugin->checker->toggle_stream(user_id, item, state);
+    auto worker_it = plugin_workers_.find(plugin);
+    if (worker_it == plugin_workers_.cend())
+        return;
+
+    if (Plugin_Worker* worker = worker_it->second.shared_->worker_)
+        QMetaObject::invokeMethod(worker, "toggle_stream", Qt::QueuedConnection,
+                                  Q_ARG(uint32_t, user_id), Q_ARG(Device_Item*, item), Q_ARG(bool, state));
 }
 
 void Manager::write_data(Device_Item *item, const QVariant &raw_data, uint32_t user_id)
@@ -343,7 +392,26 @@ void Manager::write_items(Plugin_Type* plugin, std::vector<Write_Cache_Item>& it
         return;
     }
 
-    if (plugin && plugin->id() && plugin->checker)
+    auto worker_it = plugin_workers_.find(plugin);
+    if (worker_it != plugin_workers_.cend())
+    {
+        if (Plugin_Worker* worker = worker_it->second.shared_->worker_)
+        {
+            worker->add_write_items(items);
+        }
+        else
+        {
+            // Worker object isn't created in its thread yet, the plugin must not be used from this thread.
+            std::vector<Write_Cache_Item>& cache = write_cache_[plugin];
+            for (Write_Cache_Item& item: items)
+                if (std::find(cache.begin(), cache.end(), item.dev_item_) == cache.end())
+                    cache.push_back(std::move(item));
+
+            if (!b_break)
+                write_timer_.start();
+        }
+    }
+    else if (plugin && plugin->id() && plugin->checker)
     {        
         plugin->checker->write(items);
         last_check_time_map_[items.begin()->dev_item_->device_id()].time_ = 0;
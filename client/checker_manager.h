@@ -7,6 +7,7 @@
 #include <QMutexLocker>
 
 #include <map>
+#include <memory>
 
 #include <Helpz/simplethread.h>
 
@@ -14,6 +15,8 @@
 #include <Das/checker_interface.h>
 #include <Das/write_cache_item.h>
 
+#include "checker_plugin_worker.h"
+
 namespace Das {
 
 namespace DB {
@@ -48,6 +51,9 @@ private slots:
     void write_data(Device_Item* item, const QVariant& raw_data, uint32_t user_id = 0);
     void write_cache();
 private:
+    void start_plugin_workers();
+    void stop_plugin_workers();
+
     void write_items(DB::Plugin_Type* plugin, std::vector<Write_Cache_Item>& items);
 
     bool is_server_connected() const override;
@@ -66,6 +72,12 @@ private:
 
 
     std::shared_ptr<DB::Plugin_Type_Manager> plugin_type_mng_;
+    struct Plugin_Worker_Item
+    {
+        std::unique_ptr<Plugin_Worker_Shared> shared_;
+        Plugin_Worker_Thread* thread_;
+    };
+    std::map<DB::Plugin_Type*, Plugin_Worker_Item> plugin_workers_;
 
     struct Check_Info
     {
@@ -0,0 +1,159 @@
+#include <QDateTime>
+#include <QLoggingCategory>
+
+#include <Das/scheme.h>
+#include <Das/device.h>
+
+#include "checker_plugin_worker.h"
+
+namespace Das {
+namespace Checker {
+
+Q_DECLARE_LOGGING_CATEGORY(Log)
+
+#define MINIMAL_CHECK_INTERVAL    50
+
+Plugin_Worker::Plugin_Worker(Scheme *scheme, DB::Plugin_Type *plugin, Plugin_Worker_Shared *shared) :
+    QObject(),
+    scheme_(scheme),
+    plugin_(plugin),
+    shared_(shared)
+{
+    connect(&check_timer_, &QTimer::timeout, this, &Plugin_Worker::check_devices);
+    check_timer_.setSingleShot(true);
+    check_timer_.start(0);
+
+    shared_->worker_ = this;
+}
+
+Plugin_Worker::~Plugin_Worker()
+{
+    shared_->worker_ = nullptr;
+}
+
+DB::Plugin_Type *Plugin_Worker::plugin() const { return plugin_; }
+
+void Plugin_Worker::add_write_items(std::vector<Write_Cache_Item> &items)
+{
+    {
+        std::lock_guard lock(write_mutex_);
+        for (Write_Cache_Item& item: items)
+        {
+            auto it = std::find(write_cache_.begin(), write_cache_.end(), item.dev_item_);
+            if (it == write_cache_.end())
+                write_cache_.push_back(std::move(item));
+            else
+                it->raw_data_ = item.raw_data_;
+        }
+    }
+
+    QMetaObject::invokeMethod(this, "write_cache", Qt::QueuedConnection);
+}
+
+void Plugin_Worker::start()
+{
+    shared_->is_break_ = false;
+    check_devices();
+}
+
+void Plugin_Worker::stop()
+{
+    shared_->is_break_ = true;
+
+    if (check_timer_.isActive())
+        check_timer_.stop();
+
+    if (plugin_->checker)
+        plugin_->checker->stop();
+}
+
+void Plugin_Worker::toggle_stream(uint32_t user_id, Device_Item *item, bool state)
+{
+    if (plugin_->checker)
+        plugin_->checker->toggle_stream(user_id, item, state);
+}
+
+bool Plugin_Worker::is_break() const
+{
+    return shared_->is_break_;
+}
+
+void Plugin_Worker::check_devices()
+{
+    if (is_break() || !plugin_->checker)
+        return;
+
+    qint64 next_shot, min_shot = QDateTime::currentMSecsSinceEpoch() + 60000, now_ms;
+    for (Device* dev: scheme_->devices())
+    {
+        if (dev->checker_type() != plugin_ || dev->check_interval() <= 0)
+            continue;
+
+        auto check_it = last_check_time_map_.find(dev->id());
+        if (check_it == last_check_time_map_.end())
+            check_it = last_check_time_map_.emplace(dev->id(), Check_Info{ true, 0 }).first;
+        Check_Info& check_info = check_it->second;
+
+        now_ms = QDateTime::currentMSecsSinceEpoch();
+        next_shot = check_info.time_ + dev->check_interval();
+
+        if (next_shot <= now_ms)
+        {
+            if (is_break()) break;
+
+            if (dev->items().size())
+            {
+                if (plugin_->checker->check(dev))
+                {
+                    if (!check_info.status_)
+                        check_info.status_ = true;
+                }
+                else if (check_info.status_)
+                {
+                    check_info.status_ = false;
+                    qCDebug(Log) << "Fail check" << plugin_->name() << dev->toString();
+                }
+            }
+
+            now_ms = QDateTime::currentMSecsSinceEpoch();
+            check_info.time_ = now_ms;
+            next_shot = now_ms + dev->check_interval();
+        }
+        min_shot = std::min(min_shot, next_shot);
+    }
+
+    if (is_break())
+        return;
+
+    now_ms = QDateTime::currentMSecsSinceEpoch();
+    min_shot -= now_ms;
+    if (min_shot < MINIMAL_CHECK_INTERVAL)
+        min_shot = MINIMAL_CHECK_INTERVAL;
+    check_timer_.start(min_shot);
+}
+
+void Plugin_Worker::write_cache()
+{
+    std::vector<Write_Cache_Item> items;
+    {
+        std::lock_guard lock(write_mutex_);
+        items = std::move(write_cache_);
+        write_cache_.clear();
+    }
+
+    if (items.empty() || !plugin_->checker)
+        return;
+
+    const uint32_t device_id = items.front().dev_item_->device_id();
+    plugin_->checker->write(items);
+
+    auto it = last_check_time_map_.find(device_id);
+    if (it != last_check_time_map_.end())
+        it->second.time_ = 0;
+
+    if (!is_break())
+        check_timer_.start(MINIMAL_CHECK_INTERVAL);
+}
+
+} // namespace Checker
+} // namespace Das
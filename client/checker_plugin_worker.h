@@ -0,0 +1,82 @@
+#ifndef DAS_CHECKER_PLUGIN_WORKER_H
+#define DAS_CHECKER_PLUGIN_WORKER_H
+
+#include <QTimer>
+
+#include <map>
+#include <mutex>
+#include <atomic>
+
+#include <Helpz/simplethread.h>
+
+#include <Das/checker_interface.h>
+#include <Das/write_cache_item.h>
+
+namespace Das {
+
+namespace DB {
+class Plugin_Type;
+} // namespace DB
+
+class Scheme;
+
+namespace Checker {
+
+class Plugin_Worker;
+
+// Owned by manager and shared with worker thread.
+// Worker object is created in its thread, so pointer to it is published when it's ready.
+// Break flag is set by manager before worker is created too, so stop isn't lost.
+struct Plugin_Worker_Shared
+{
+    std::atomic<Plugin_Worker*> worker_{nullptr};
+    std::atomic<bool> is_break_{false};
+};
+
+// Polls the devices of one plugin on its own thread with its own timer,
+// so a slow bus doesn't delay other plugins. Every loaded plugin has own worker,
+// and plugin is used only from this thread.
+class Plugin_Worker : public QObject
+{
+    Q_OBJECT
+public:
+    Plugin_Worker(Scheme* scheme, DB::Plugin_Type* plugin, Plugin_Worker_Shared* shared);
+    ~Plugin_Worker();
+
+    DB::Plugin_Type* plugin() const;
+
+    // ATTENTION: This function calls from manager thread
+    void add_write_items(std::vector<Write_Cache_Item>& items);
+public slots:
+    void start();
+    void stop();
+    void toggle_stream(uint32_t user_id, Device_Item* item, bool state);
+private slots:
+    void check_devices();
+    void write_cache();
+private:
+    bool is_break() const;
+
+    Scheme* scheme_;
+    DB::Plugin_Type* plugin_;
+    Plugin_Worker_Shared* shared_;
+
+    QTimer check_timer_;
+
+    struct Check_Info
+    {
+        bool status_;
+        qint64 time_;
+    };
+    std::map<uint32_t, Check_Info> last_check_time_map_;
+
+    std::mutex write_mutex_;
+    std::vector<Write_Cache_Item> write_cache_;
+};
+
+using Plugin_Worker_Thread = Helpz::ParamThread<Plugin_Worker, Scheme*, DB::Plugin_Type*, Plugin_Worker_Shared*>;
+
+} // namespace Checker
+} // namespace Das
+
+#endif // DAS_CHECKER_PLUGIN_WORKER_H
@@ -1,6 +1,6 @@
 QT += core network dbus sql
 
-QT += script
+QT += script qml
 
 TARGET = DasClient
 CONFIG += console
@@ -18,6 +18,9 @@ TEMPLATE = app
 
 SOURCES += main.cpp \
     Scripts/scripted_scheme.cpp \
+    Scripts/script_engine.cpp \
+    Scripts/script_engine_qtscript.cpp \
+    Scripts/script_engine_qjs.cpp \
     worker.cpp \
     Scripts/tools/pidcontroller.cpp \
     Scripts/tools/automationhelper.cpp \
@@ -36,10 +39,14 @@ SOURCES += main.cpp \
     id_timer.cpp \
     Network/client_protocol_latest.cpp \
     dbus_object.cpp \
-    checker_manager.cpp
+    checker_manager.cpp \
+    checker_plugin_worker.cpp
 
 HEADERS  += \
     Scripts/scripted_scheme.h \
+    Scripts/script_engine.h \
+    Scripts/script_engine_qtscript.h \
+    Scripts/script_engine_qjs.h \
     worker.h \
     Scripts/tools/pidcontroller.h \
     Scripts/tools/automationhelper.h \
@@ -58,7 +65,8 @@ HEADERS  += \
     id_timer.h \
     Network/client_protocol_latest.h \
     dbus_object.h \
-    checker_manager.h
+    checker_manager.h \
+    checker_plugin_worker.h
 
 #Target version
 VER_MAJ = 1
@@ -7,7 +7,10 @@
 #include <Das/scheme.h>
 #include <Das/device.h>
 #include <Das/db/device_item_value.h>
+#include <Das/log/log_pack_codec.h>
+#include <Das/blob_store.h>
 #include <plus/das/database.h>
+#include <plus/das/upsert_helper.h>
 
 #include "worker.h"
 #include "dbus_object.h"
@@ -20,7 +23,7 @@ namespace Das {
 using namespace Helpz::DB;
 
 Log_Value_Save_Timer::Log_Value_Save_Timer(Worker *worker) :
-    prj_(worker->prj()), worker_(worker)
+    prj_(worker->prj()), worker_(worker), is_timer_items_valid_(false)
 {
     connect(&item_values_timer_, &QTimer::timeout, this, &Log_Value_Save_Timer::save_item_values);
     item_values_timer_.setSingleShot(true);
@@ -64,6 +67,8 @@ Log_Value_Save_Timer::Log_Value_Save_Timer(Worker *worker) :
             this, &Log_Value_Save_Timer::status_changed, Qt::QueuedConnection);
     connect(prj_, &Scripted_Scheme::dig_mode_available,
             this, &Log_Value_Save_Timer::dig_mode_changed, Qt::QueuedConnection);
+    connect(prj_, &Scripted_Scheme::structure_reinitialized,
+            this, &Log_Value_Save_Timer::reset_timer_items, Qt::QueuedConnection);
 }
 
 Log_Value_Save_Timer::~Log_Value_Save_Timer()
@@ -86,6 +91,14 @@ QVector<Device_Item_Value> Log_Value_Save_Timer::get_unsaved_values() const
 
 void Log_Value_Save_Timer::add_log_value_item(Log_Value_Item item)
 {
+    // Big value is saved to blob store and only reference to it is sent
+    QVariant big_value = item.raw_value();
+    if (Blob_Store::instance().put_if_big(big_value))
+        item.set_raw_value(big_value);
+    big_value = item.value();
+    if (Blob_Store::instance().put_if_big(big_value))
+        item.set_value(big_value);
+
     if (!item.is_big_value())
     {
         auto waited_it = waited_item_values_.find(item.item_id());
@@ -193,53 +206,63 @@ void Log_Value_Save_Timer::save_item_values()
     if (waited_item_values_.empty())
         return;
 
-    Table table = db_table<Device_Item_Value>();
-
     using T = Device_Item_Value;
-    QStringList field_names{
+    Table table = db_table<T>();
+    const QStringList key_field_names{
+        table.field_names().at(T::COL_item_id),
+        table.field_names().at(T::COL_scheme_id)
+    };
+    const QStringList update_field_names{
         table.field_names().at(T::COL_timestamp_msecs),
         table.field_names().at(T::COL_user_id),
         table.field_names().at(T::COL_raw_value),
         table.field_names().at(T::COL_value)
     };
+    table.field_names().removeFirst(); // remove id
 
-    table.field_names() = std::move(field_names);
-
-    Base& db = Base::get_thread_local_instance();
-
-    uint32_t scheme_id = DB::Schemed_Model::default_scheme_id();
-    const QString where = DB::Helper::get_default_suffix() + " AND item_id = ";
+    const uint32_t scheme_id = DB::Schemed_Model::default_scheme_id();
 
-    QVariantList values{QVariant(), QVariant(), QVariant(), QVariant()};
-    for (auto it: waited_item_values_)
+    QVector<Device_Item_Value> saved_values;
+    QVariantList values;
+    for (const auto& it: waited_item_values_)
     {
         const Device_Item_Value& value = it.second;
         if (value.is_big_value())
             continue;
 
-        values.front() = value.timestamp_msecs();
-        values[1] = value.user_id();
-        values[2] = value.raw_value_to_db();
-        values.back() = value.value_to_db();
+        values += QVariantList{ value.timestamp_msecs(), value.user_id(), value.item_id(),
+                                value.raw_value_to_db(), value.value_to_db(), scheme_id };
+        saved_values.push_back(value);
+    }
 
-        const QSqlQuery q = db.update(table, values, where + QString::number(value.item_id()));
-        if (!q.isActive() || q.numRowsAffected() <= 0)
-        {
-            Table ins_table = db_table<Device_Item_Value>();
-            ins_table.field_names().removeFirst(); // remove id
+    waited_item_values_.clear();
 
-            QVariantList ins_values = values;
-            ins_values.insert(2, value.item_id()); // after user_id
-            ins_values.push_back(scheme_id);
+    if (saved_values.empty())
+        return;
 
-            if (!db.insert(ins_table, ins_values))
-            {
-                // TODO: do something
-            }
+    // Values is written by the pending thread, so the DB write doesn't block this thread.
+    // Structure sync reads values through the same thread, so it always sees them.
+    // If write is failed values is returned back and saved again by next flush.
+    const int row_count = saved_values.size();
+    worker_->db_pending()->add([this, table, key_field_names, update_field_names, values, row_count, saved_values](Base* db)
+    {
+        if (!Upsert_Helper::save(*db, table, key_field_names, update_field_names, values, row_count))
+        {
+            qCWarning(Service::Log) << "Failed to save item values";
+            QMetaObject::invokeMethod(this, "restore_item_values", Qt::QueuedConnection,
+                                      Q_ARG(QVector<Device_Item_Value>, saved_values));
         }
-    }
+    });
+}
 
-    waited_item_values_.clear();
+void Log_Value_Save_Timer::restore_item_values(const QVector<Device_Item_Value>& values)
+{
+    // Value that changed after failed write is newer, so it isn't replaced
+    for (const Device_Item_Value& value: values)
+        waited_item_values_.emplace(value.item_id(), value);
+
+    if (!item_values_timer_.isActive())
+        item_values_timer_.start(5000);
 }
 
 void Log_Value_Save_Timer::send_value_pack()
@@ -315,79 +338,88 @@ void Log_Value_Save_Timer::stop()
 
 void Log_Value_Save_Timer::process_items(uint32_t timer_id)
 {
-    //qDebug() << "!!! process_items" << timer_id;
-    //    if (timer_.interval() != (period_ * 1000))
-//        timer_.setInterval(period_ * 1000);
-
     Log_Value_Item pack_item{QDateTime::currentDateTimeUtc().toMSecsSinceEpoch()};
     pack_item.set_need_to_save(true);
 
-    Device_Item_Type_Manager* typeMng = &prj_->device_item_type_mng_;
-
-    decltype(cached_values_)::iterator val_it;
-
     std::shared_ptr<QVector<Log_Value_Item>> pack = std::make_shared<QVector<Log_Value_Item>>();
 
+    Device_Item* dev_item;
     QVariant raw_value, display_value;
-    for (Device* dev: prj_->devices())
+    for (Timer_Item& item: get_timer_items(timer_id))
     {
-        for (Device_Item* dev_item: dev->items())
-        {
-            if (typeMng->save_timer_id(dev_item->type_id()) != timer_id)
-                continue;
+        dev_item = prj_->item_by_id(item.item_id_);
+        if (!dev_item)
+            continue;
 
-            val_it = cached_values_.find(dev_item->id());
+        raw_value = dev_item->raw_value();
+        display_value = dev_item->value();
 
-            raw_value = dev_item->raw_value();
-            display_value = dev_item->value();
+        if (item.is_cached_
+            && item.raw_value_ == raw_value
+            && item.raw_value_.type() == raw_value.type()
+            && item.value_ == display_value
+            && item.value_.type() == display_value.type())
+            continue;
 
-            if (val_it == cached_values_.end())
-            {
-                cached_values_.emplace(dev_item->id(), std::make_pair(raw_value, display_value));
-            }
-            else if (val_it->second.first != raw_value
-                     || val_it->second.first.type() != raw_value.type()
-                     || val_it->second.second != display_value
-                     || val_it->second.second.type() != display_value.type())
-            {
-                val_it->second = std::make_pair(raw_value, display_value);
-            }
-            else
-                continue;
+        item.is_cached_ = true;
+        item.raw_value_ = raw_value;
+        item.value_ = display_value;
 
-            pack_item.set_item_id(dev_item->id());
-            pack_item.set_raw_value(raw_value);
-            pack_item.set_value(display_value);
-            pack->push_back(pack_item);
+        pack_item.set_item_id(item.item_id_);
+        pack_item.set_raw_value(raw_value);
+        pack_item.set_value(display_value);
+        pack->push_back(pack_item);
 
-            pack_item.set_timestamp_msecs(pack_item.timestamp_msecs() + 1);
-        }
+        pack_item.set_timestamp_msecs(pack_item.timestamp_msecs() + 1);
     }
 
     if (!pack->empty())
         send(LOG_VALUE, std::move(pack));
 }
 
-void Log_Value_Save_Timer::save_dig_param_values(std::shared_ptr<QVector<Log_Param_Item>> pack)
+void Log_Value_Save_Timer::reset_timer_items()
 {
-    if (pack->empty())
-        return;
+    is_timer_items_valid_ = false;
+}
 
-    Base& db = Base::get_thread_local_instance();
-    Table table = db_table<DIG_Param_Value>();
+std::vector<Log_Value_Save_Timer::Timer_Item>& Log_Value_Save_Timer::get_timer_items(uint32_t timer_id)
+{
+    if (!is_timer_items_valid_)
+    {
+        // Last saved values is kept, so unchanged items isn't saved again after reinitialization
+        std::map<uint32_t, Timer_Item> old_items;
+        for (auto& it: timer_items_)
+            for (Timer_Item& item: it.second)
+                old_items.emplace(item.item_id_, std::move(item));
+        timer_items_.clear();
+
+        Device_Item_Type_Manager* type_mng = &prj_->device_item_type_mng_;
+        for (Device* dev: prj_->devices())
+        {
+            for (Device_Item* dev_item: dev->items())
+            {
+                std::vector<Timer_Item>& items = timer_items_[type_mng->save_timer_id(dev_item->type_id())];
 
-    using T = DIG_Param_Value;
-    QStringList field_names{
-        table.field_names().at(T::COL_timestamp_msecs),
-        table.field_names().at(T::COL_user_id),
-        table.field_names().at(T::COL_value)
-    };
+                auto old_it = old_items.find(dev_item->id());
+                if (old_it != old_items.end())
+                    items.push_back(std::move(old_it->second));
+                else
+                    items.push_back(Timer_Item{dev_item->id(), false, {}, {}});
+            }
+        }
 
-    table.field_names() = std::move(field_names);
+        is_timer_items_valid_ = true;
+    }
+
+    return timer_items_[timer_id];
+}
+
+void Log_Value_Save_Timer::save_dig_param_values(std::shared_ptr<QVector<Log_Param_Item>> pack)
+{
+    if (pack->empty())
+        return;
 
-    uint32_t scheme_id = DB::Schemed_Model::default_scheme_id();
-    const QString where = DB::Helper::get_default_suffix() + " AND group_param_id = ";
-    QVariantList values{QVariant(), QVariant(), QVariant()};
+    std::map<uint32_t, const Log_Param_Item*> last_item_map;
 
     auto dbg = qDebug(Service::Log()).nospace() << pack->front().user_id() << "|Params changed:";
 
@@ -395,26 +427,39 @@ void Log_Value_Save_Timer::save_dig_param_values(std::shared_ptr<QVector<Log_Par
     {
         dbg << '\n' << item.group_param_id() << ": " << item.value().left(16);
 
-        values.front() = item.timestamp_msecs();
-        values[1] = item.user_id();
-        values.back() = item.value();
+        const Log_Param_Item*& last_item = last_item_map[item.group_param_id()];
+        if (!last_item || last_item->timestamp_msecs() <= item.timestamp_msecs())
+            last_item = &item;
+    }
 
-        const QSqlQuery q = db.update(table, values, where + QString::number(item.group_param_id()));
-        if (!q.isActive() || q.numRowsAffected() <= 0)
-        {
-            Table table = db_table<DIG_Param_Value>();
-            table.field_names().removeFirst();
+    using T = DIG_Param_Value;
+    Table table = db_table<T>();
+    const QStringList key_field_names{
+        table.field_names().at(T::COL_group_param_id),
+        table.field_names().at(T::COL_scheme_id)
+    };
+    const QStringList update_field_names{
+        table.field_names().at(T::COL_timestamp_msecs),
+        table.field_names().at(T::COL_user_id),
+        table.field_names().at(T::COL_value)
+    };
+    table.field_names().removeFirst(); // remove id
 
-            const QVariantList ins_values{ item.timestamp_msecs(), item.user_id(), item.group_param_id(),
-                                           item.value(), scheme_id };
+    const uint32_t scheme_id = DB::Schemed_Model::default_scheme_id();
 
-            if (!db.insert(table, ins_values))
-            {
-                dbg << " failed";
-                // TODO: do something
-            }
-        }
+    QVariantList values;
+    for (const auto& it: last_item_map)
+    {
+        const Log_Param_Item& item = *it.second;
+        values += QVariantList{ item.timestamp_msecs(), item.user_id(), item.group_param_id(), item.value(), scheme_id };
     }
+
+    const int row_count = last_item_map.size();
+    worker_->db_pending()->add([table, key_field_names, update_field_names, values, row_count](Base* db)
+    {
+        if (!Upsert_Helper::save(*db, table, key_field_names, update_field_names, values, row_count))
+            qCWarning(Service::Log) << "Failed to save param values";
+    });
 }
 
 //struct Log_PK_Increaser
@@ -469,11 +514,17 @@ void Log_Value_Save_Timer::send(Log_Type_Wrapper log_type, std::shared_ptr<QVect
     auto proto = worker_->net_protocol();
     if (proto)
     {
-        proto->send(Ver::Cmd::LOG_PACK)
-                .timeout([this, pack]()
+        Helpz::Net::Protocol_Sender sender = proto->send(Ver::Cmd::LOG_PACK);
+        sender.timeout([this, pack]()
         {
             save_to_db(*pack);
-        }, std::chrono::seconds(11), std::chrono::seconds(5)) << log_type << *pack;
+        }, std::chrono::seconds(11), std::chrono::seconds(5));
+
+        sender << log_type;
+        if (proto->log_pack_compression())
+            sender << Log_Pack_Codec::encode(*pack, Helpz::Net::Protocol::DATASTREAM_VERSION);
+        else
+            sender << *pack;
     }
     else
     {
@@ -36,6 +36,7 @@ public slots:
     void dig_mode_changed(const DIG_Mode& mode);
 private slots:
     void save_item_values();
+    void restore_item_values(const QVector<Device_Item_Value>& values);
     void send_value_pack();
     void send_event_pack();
     void send_param_pack();
@@ -44,6 +45,15 @@ private:
     void save_dig_param_values(std::shared_ptr<QVector<Log_Param_Item> > pack);
     void stop();
     void process_items(uint32_t timer_id);
+    void reset_timer_items();
+
+    struct Timer_Item
+    {
+        uint32_t item_id_;
+        bool is_cached_;
+        QVariant raw_value_, value_;
+    };
+    std::vector<Timer_Item>& get_timer_items(uint32_t timer_id);
 
     template<typename T>
     void send(Log_Type_Wrapper log_type, std::shared_ptr<QVector<T>> pack);
@@ -54,7 +64,8 @@ private:
     Worker* worker_;
 
     std::vector<ID_Timer*> timers_list_;
-    std::map<uint32_t, std::pair<QVariant, QVariant>> cached_values_;
+    std::map<uint32_t, std::vector<Timer_Item>> timer_items_; // Items of each save timer with last saved values
+    bool is_timer_items_valid_;
 
     QVector<Log_Value_Item> value_pack_;
     QVector<Log_Event_Item> event_pack_;
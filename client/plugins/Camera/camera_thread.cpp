@@ -6,6 +6,7 @@
 #include <Das/device_item_group.h>
 #include <Das/device_item.h>
 #include <Das/scheme.h>
+#include <Das/blob_store.h>
 
 #include "camera_stream.h"
 #include "rtsp_stream.h"
@@ -221,7 +222,7 @@ bool Camera_Thread::send_stream_data(Device_Item *item, Camera_Stream_Iface *str
 
 void Camera_Thread::read_item(Device_Item *item)
 {
-    QByteArray data = "img:";
+    QByteArray frame;
 
     auto it = streams_.find(item);
 
@@ -242,14 +243,14 @@ void Camera_Thread::read_item(Device_Item *item)
 
             stream->reinit();
             stream->set_skip_frame_count(config().picture_skip_);
-            data += stream->get_frame().toBase64();
+            frame = stream->get_frame();
             stream->reinit(width, height);
         }
         else
         {
             std::shared_ptr<Camera_Stream_Iface> stream = open_stream(item, 0, 0);
             stream->set_skip_frame_count(config().picture_skip_);
-            data += stream->get_frame().toBase64();
+            frame = stream->get_frame();
         }
     }
     catch (const std::exception& e)
@@ -264,6 +265,18 @@ void Camera_Thread::read_item(Device_Item *item)
         return;
     }
 
+    // Frame is stored as is and only reference to it is sent, without base64
+    QVariant data;
+    if (Blob_Store::instance().is_ref_allowed())
+    {
+        const QByteArray hash = Blob_Store::instance().put(frame);
+        if (!hash.isEmpty())
+            data = Blob_Store::make_ref(hash);
+    }
+
+    if (!data.isValid())
+        data = QByteArray("img:") + frame.toBase64();
+
     const qint64 now = Log_Value_Item::current_timestamp();
     const Log_Value_Item log_value_item{now, /*user_id=*/0, item->id(), data, QVariant(), /*need_to_save=*/true};
     emit iface_->scheme()->log_item_available(log_value_item);
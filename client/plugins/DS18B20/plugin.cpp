@@ -21,6 +21,9 @@ Q_LOGGING_CATEGORY(DS18B20Log, "DS18B20")
 DS18B20_Plugin::DS18B20_Plugin() :
     QObject(),
     is_error_printed_(false),
+    is_bus_conversion_(true),
+    is_converting_(false),
+    conversion_id_(0),
     rom_count_(0),
     one_wire_(nullptr)
 {
@@ -35,10 +38,12 @@ DS18B20_Plugin::~DS18B20_Plugin()
 void DS18B20_Plugin::configure(QSettings *settings)
 {
     using Helpz::Param;
-    auto [pin] = Helpz::SettingsHelper<Param<uint16_t>>
+    auto [pin, is_bus_conversion] = Helpz::SettingsHelper<Param<uint16_t>, Param<bool>>
                                                         (settings, "DS18B20",
-                                                           Param<uint16_t>{"Pin", 7}
+                                                           Param<uint16_t>{"Pin", 7},
+                                                           Param<bool>{"BusConversion", true}
                                                            )();
+    is_bus_conversion_ = is_bus_conversion;
 
 #ifndef NO_WIRINGPI
     one_wire_ = new One_Wire(pin);
@@ -80,9 +85,25 @@ bool DS18B20_Plugin::check(Device* dev)
     if (rom_item_vect_.empty())
         return true;
 
-    if (!rom_array_ || rom_count_ < max_num)
+    if (!rom_array_ || rom_count_ <= max_num)
         search_rom();
 
+    // In bus mode values are read from conversion started on previous cycle,
+    // so check doesn't wait for it. All devices of cycle read the same conversion.
+    if (is_bus_conversion_)
+    {
+        auto conv_it = device_conversion_map_.find(dev);
+        if (conv_it != device_conversion_map_.end() && conv_it->second == conversion_id_ && is_converting_)
+        {
+            // Device already read current conversion, so devices which didn't read it isn't checked anymore
+            start_conversion();
+            return true;
+        }
+
+        if (!is_conversion_done())
+            return true;
+    }
+
     const qint64 timestamp_msecs = DB::Log_Base_Item::current_timestamp();
 
     std::map<Device_Item*, Device::Data_Item> device_items_values;
@@ -91,7 +112,7 @@ bool DS18B20_Plugin::check(Device* dev)
 
     for (auto it = rom_item_vect_.begin(); it != rom_item_vect_.end(); ++it)
     {
-        value = get_temperature(it->first, is_ok);
+        value = is_bus_conversion_ ? read_temperature(it->first, is_ok) : get_temperature(it->first, is_ok);
         if (is_ok)
         {
             Device::Data_Item data_item{0, timestamp_msecs, std::floor(value * 10) / 10};
@@ -101,6 +122,13 @@ bool DS18B20_Plugin::check(Device* dev)
             device_items_disconnected.push_back(it->second);
     }
 
+    if (is_bus_conversion_)
+    {
+        device_conversion_map_[dev] = conversion_id_;
+        if (is_conversion_read_by_all())
+            start_conversion();
+    }
+
     if (!device_items_values.empty())
     {
         QMetaObject::invokeMethod(dev, "set_device_items_values", Qt::QueuedConnection,
@@ -140,6 +168,11 @@ void DS18B20_Plugin::search_rom()
 
     if (n)
     {
+        // Sensor found now hasn't got convert command
+        if (!rom_array_ || rom_count_ != static_cast<uint32_t>(n)
+            || memcmp(rom_array_.get(), roms, n * sizeof(uint64_t)) != 0)
+            is_converting_ = false;
+
         rom_count_ = n;
         rom_array_.reset(new uint64_t[n]);
         memcpy(rom_array_.get(), roms, n * sizeof(uint64_t));
@@ -151,6 +184,8 @@ void DS18B20_Plugin::search_rom()
     {
         if (rom_array_)
             rom_array_.reset();
+        rom_count_ = 0;
+        is_converting_ = false;
 
         if (!is_error_printed_)
         {
@@ -162,6 +197,20 @@ void DS18B20_Plugin::search_rom()
 
 double DS18B20_Plugin::get_temperature(uint32_t num, bool &is_ok)
 {
+#ifndef NO_WIRINGPI
+    if (num < rom_count_)
+    {
+        one_wire_->set_device(rom_array_[num]);
+        one_wire_->write_byte(CMD_CONVERTTEMP);
+
+        delay(750);
+    }
+#endif
+    return read_temperature(num, is_ok);
+}
+
+double DS18B20_Plugin::read_temperature(uint32_t num, bool &is_ok)
+{
 #ifndef NO_WIRINGPI
     if (num < rom_count_)
     {
@@ -171,11 +220,6 @@ double DS18B20_Plugin::get_temperature(uint32_t num, bool &is_ok)
 
         do
         {
-            one_wire_->set_device(rom);
-            one_wire_->write_byte(CMD_CONVERTTEMP);
-
-            delay(750);
-
             one_wire_->set_device(rom);
             one_wire_->write_byte(CMD_RSCRATCHPAD);
 
@@ -199,4 +243,49 @@ double DS18B20_Plugin::get_temperature(uint32_t num, bool &is_ok)
 #endif
 }
 
+bool DS18B20_Plugin::is_conversion_done()
+{
+#ifndef NO_WIRINGPI
+    if (!is_converting_)
+    {
+        start_conversion();
+        return false;
+    }
+
+    // Conversion with 12 bit resolution takes up to 750 ms
+    return std::chrono::steady_clock::now() - conversion_time_ >= std::chrono::milliseconds(750);
+#else
+    return true;
+#endif
+}
+
+bool DS18B20_Plugin::is_conversion_read_by_all() const
+{
+    for (const auto& it: device_conversion_map_)
+        if (it.second != conversion_id_)
+            return false;
+    return true;
+}
+
+void DS18B20_Plugin::start_conversion()
+{
+#ifndef NO_WIRINGPI
+    // Remove devices which didn't read previous conversion
+    for (auto it = device_conversion_map_.begin(); it != device_conversion_map_.end(); )
+    {
+        if (it->second != conversion_id_)
+            it = device_conversion_map_.erase(it);
+        else
+            ++it;
+    }
+
+    one_wire_->skip_rom();
+    one_wire_->write_byte(CMD_CONVERTTEMP);
+
+    ++conversion_id_;
+    conversion_time_ = std::chrono::steady_clock::now();
+    is_converting_ = true;
+#endif
+}
+
 } // namespace Das
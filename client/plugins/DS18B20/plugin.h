@@ -1,7 +1,9 @@
 #ifndef DAS_HTU21PLUGIN_H
 #define DAS_HTU21PLUGIN_H
 
+#include <map>
 #include <memory>
+#include <chrono>
 
 #include <QLoggingCategory>
 
@@ -26,14 +28,27 @@ public:
     // CheckerInterface interface
 public:
     void configure(QSettings* settings) override;
+    bool is_need_own_thread() const override { return true; }
     bool check(Device *dev) override;
     void stop() override;
     void write(std::vector<Write_Cache_Item>& items) override;
 private:
     void search_rom();
     double get_temperature(uint32_t num, bool& is_ok);
+    double read_temperature(uint32_t num, bool& is_ok);
+
+    bool is_conversion_done();
+    bool is_conversion_read_by_all() const;
+    void start_conversion();
 
     bool is_error_printed_;
+    bool is_bus_conversion_; // Convert all sensors at once with SKIP ROM
+    bool is_converting_;
+    uint32_t conversion_id_;
+    std::chrono::steady_clock::time_point conversion_time_;
+
+    // Last conversion read by each device, next conversion starts when every device read current one
+    std::map<Device*, uint32_t> device_conversion_map_;
 
     std::unique_ptr<uint64_t[]> rom_array_;
     uint32_t rom_count_;
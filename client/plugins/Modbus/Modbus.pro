@@ -7,10 +7,14 @@ VER_MIN = 2
 
 SOURCES += \
     modbus_plugin_base.cpp \
+    modbus_bus.cpp \
+    modbus_read_planner.cpp \
     config.cpp
 
 HEADERS += \
     modbus_plugin_base.h \
+    modbus_bus.h \
+    modbus_read_planner.h \
     config.h
 
 unix {
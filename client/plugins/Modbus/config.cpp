@@ -1,6 +1,8 @@
 #include <QModbusRtuSerialMaster>
+#include <QModbusTcpClient>
 #include <QSerialPortInfo>
 #include <QVariant>
+#include <QUrl>
 
 #include "config.h"
 
@@ -9,7 +11,7 @@ namespace Modbus {
 
 Config::Config(const QString& portName, QSerialPort::BaudRate speed, QSerialPort::DataBits bits_num, QSerialPort::Parity parity,
                QSerialPort::StopBits stopBits, QSerialPort::FlowControl flowControl, int modbusTimeout, int modbusNumberOfRetries,
-               int frameDelayMicroseconds, int line_use_timeout) :
+               int frameDelayMicroseconds, int line_use_timeout, int read_register_gap, int read_bit_gap) :
     name(portName),
     baudRate(speed),
     dataBits(bits_num),
@@ -20,7 +22,9 @@ Config::Config(const QString& portName, QSerialPort::BaudRate speed, QSerialPort
     modbusTimeout(modbusTimeout),
     modbusNumberOfRetries(modbusNumberOfRetries),
     frameDelayMicroseconds(frameDelayMicroseconds),
-    line_use_timeout_(line_use_timeout)
+    line_use_timeout_(line_use_timeout),
+    read_register_gap_(read_register_gap),
+    read_bit_gap_(read_bit_gap)
 {
 }
 
@@ -32,19 +36,34 @@ QStringList Config::available_ports()
     return ports;
 }
 
-void Config::set(const Config& config, QModbusRtuSerialMaster* device)
+/*static*/ bool Config::is_tcp(const QString& name)
 {
-    device->setConnectionParameter(QModbusDevice::SerialPortNameParameter, config.name);
-    device->setConnectionParameter(QModbusDevice::SerialParityParameter,   config.parity);
-    device->setConnectionParameter(QModbusDevice::SerialBaudRateParameter, config.baudRate);
-    device->setConnectionParameter(QModbusDevice::SerialDataBitsParameter, config.dataBits);
-    device->setConnectionParameter(QModbusDevice::SerialStopBitsParameter, config.stopBits);
+    return name.startsWith("tcp://");
+}
+
+void Config::set(const Config& config, QModbusClient* device)
+{
+    if (is_tcp(config.name))
+    {
+        const QUrl url(config.name);
+        device->setConnectionParameter(QModbusDevice::NetworkAddressParameter, url.host());
+        device->setConnectionParameter(QModbusDevice::NetworkPortParameter,    url.port(502));
+    }
+    else
+    {
+        device->setConnectionParameter(QModbusDevice::SerialPortNameParameter, config.name);
+        device->setConnectionParameter(QModbusDevice::SerialParityParameter,   config.parity);
+        device->setConnectionParameter(QModbusDevice::SerialBaudRateParameter, config.baudRate);
+        device->setConnectionParameter(QModbusDevice::SerialDataBitsParameter, config.dataBits);
+        device->setConnectionParameter(QModbusDevice::SerialStopBitsParameter, config.stopBits);
+    }
 
     device->setTimeout(config.modbusTimeout);
     device->setNumberOfRetries(config.modbusNumberOfRetries);
 
-    if (config.frameDelayMicroseconds > 0)
-        device->setInterFrameDelay(config.frameDelayMicroseconds);
+    QModbusRtuSerialMaster* rtu_device = qobject_cast<QModbusRtuSerialMaster*>(device);
+    if (rtu_device && config.frameDelayMicroseconds > 0)
+        rtu_device->setInterFrameDelay(config.frameDelayMicroseconds);
 }
 
 /*static*/ QString Config::getUSBSerial()
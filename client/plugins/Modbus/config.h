@@ -5,7 +5,7 @@
 
 #include <QSerialPort>
 
-QT_FORWARD_DECLARE_CLASS(QModbusRtuSerialMaster)
+QT_FORWARD_DECLARE_CLASS(QModbusClient)
 
 namespace Das {
 namespace Modbus {
@@ -20,7 +20,8 @@ struct Config {
          QSerialPort::Parity parity = QSerialPort::NoParity,
          QSerialPort::StopBits stopBits = QSerialPort::OneStop,
          QSerialPort::FlowControl flowControl = QSerialPort::NoFlowControl,
-         int modbusTimeout = 200, int modbusNumberOfRetries = 5, int frameDelayMicroseconds = 0, int line_use_timeout = 50);
+         int modbusTimeout = 200, int modbusNumberOfRetries = 5, int frameDelayMicroseconds = 0, int line_use_timeout = 50,
+         int read_register_gap = 0, int read_bit_gap = 0);
 
     /*static QString firstPort() {
         return QSerialPortInfo::availablePorts().count() ? QSerialPortInfo::availablePorts().first().portName() : QString();
@@ -28,7 +29,9 @@ struct Config {
 
     static QStringList available_ports();
 
-    static void set(const Config& config, QModbusRtuSerialMaster* device);
+    // Port name like "tcp://192.168.1.10:502" is used for Modbus TCP gateway
+    static bool is_tcp(const QString& name);
+    static void set(const Config& config, QModbusClient* device);
 
     static QString getUSBSerial();
 
@@ -43,6 +46,8 @@ struct Config {
     int modbusNumberOfRetries;
     int frameDelayMicroseconds;
     std::chrono::milliseconds line_use_timeout_;
+    int read_register_gap_;     ///< Максимальный пропуск регистров, читаемый одним запросом
+    int read_bit_gap_;          ///< Максимальный пропуск битов, читаемый одним запросом
 };
 
 } // namespace Modbus
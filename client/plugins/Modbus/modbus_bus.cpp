@@ -0,0 +1,774 @@
+#include <deque>
+#include <vector>
+#include <iterator>
+#include <type_traits>
+
+#include <QModbusRtuSerialMaster>
+#include <QModbusTcpClient>
+#include <QDebug>
+
+#include <Das/db/device_item_type.h>
+#include <Das/device_item.h>
+#include <Das/device.h>
+
+#include "modbus_plugin_base.h"
+#include "modbus_bus.h"
+
+namespace Das {
+namespace Modbus {
+
+Q_LOGGING_CATEGORY(ModbusDetailLog, "modbus.detail", QtInfoMsg)
+
+
+template <typename T>
+struct Modbus_Pack_Item_Cast {
+    static inline Device_Item* run(T item) { return item; }
+};
+
+template <>
+struct Modbus_Pack_Item_Cast<Write_Cache_Item> {
+    static inline Device_Item* run(const Write_Cache_Item& item) { return item.dev_item_; }
+};
+
+template<typename T>
+struct Modbus_Pack
+{
+    Modbus_Pack(Modbus_Pack<T>&& o) = default;
+    Modbus_Pack(const Modbus_Pack<T>& o) = default;
+    Modbus_Pack<T>& operator =(Modbus_Pack<T>&& o) = default;
+    Modbus_Pack<T>& operator =(const Modbus_Pack<T>& o) = default;
+    Modbus_Pack(T&& item) :
+        reply_(nullptr)
+    {
+        init(Modbus_Pack_Item_Cast<T>::run(item), std::is_same<Write_Cache_Item, T>::value);
+        items_.push_back(std::move(item));
+    }
+
+    void init(Device_Item* dev_item, bool is_write)
+    {
+        bool ok;
+        server_address_ = Modbus_Plugin_Base::address(dev_item->device(), &ok);
+        if (ok && server_address_ > 0)
+        {
+            start_address_ = Modbus_Plugin_Base::unit(dev_item, &ok);
+            if (ok && start_address_ >= 0)
+            {
+                if (dev_item->register_type() > QModbusDataUnit::Invalid && dev_item->register_type() <= QModbusDataUnit::HoldingRegisters &&
+                        (!is_write || (dev_item->register_type() == QModbusDataUnit::Coils ||
+                                       dev_item->register_type() == QModbusDataUnit::HoldingRegisters)))
+                {
+                    register_type_ = static_cast<QModbusDataUnit::RegisterType>(dev_item->register_type());
+                }
+                else
+                    register_type_ = QModbusDataUnit::Invalid;
+            }
+            else
+                start_address_ = -1;
+        }
+        else
+            server_address_ = -1;
+    }
+
+    bool is_valid() const
+    {
+        return server_address_ > 0 && start_address_ >= 0 && register_type_ != QModbusDataUnit::Invalid;
+    }
+
+    bool add_next(T&& item)
+    {
+        Device_Item* dev_item = Modbus_Pack_Item_Cast<T>::run(item);
+        if (register_type_ == dev_item->register_type() &&
+            server_address_ == Modbus_Plugin_Base::address(dev_item->device()))
+        {
+            int unit = Modbus_Plugin_Base::unit(dev_item);
+            if (unit == (start_address_ + static_cast<int>(items_.size())))
+            {
+                items_.push_back(std::move(item));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool assign(Modbus_Pack<T>& pack)
+    {
+        if (register_type_ == pack.register_type_ &&
+            server_address_ == pack.server_address_ &&
+            (start_address_ + static_cast<int>(items_.size())) == pack.start_address_)
+        {
+            std::copy( std::make_move_iterator(pack.items_.begin()),
+                       std::make_move_iterator(pack.items_.end()),
+                       std::back_inserter(items_) );
+            return true;
+        }
+        return false;
+    }
+
+    bool operator <(Device_Item* dev_item) const
+    {
+        return register_type_ < dev_item->register_type() ||
+               server_address_ < Modbus_Plugin_Base::address(dev_item->device()) ||
+               (start_address_ + static_cast<int>(items_.size())) < Modbus_Plugin_Base::unit(dev_item);
+    }
+
+    int server_address_;
+    int start_address_;
+    QModbusDataUnit::RegisterType register_type_;
+    QModbusReply* reply_;
+
+    std::vector<T> items_;
+};
+
+template<typename T, typename Container> struct Input_Container_Device_Item_Type { typedef T& type; };
+template<typename T, typename Container> struct Input_Container_Device_Item_Type<T, const Container> { typedef T type; };
+
+template<typename T>
+class Modbus_Pack_Builder
+{
+public:
+    template<typename Input_Container>
+    Modbus_Pack_Builder(Input_Container& items)
+    {
+        typename std::vector<Modbus_Pack<T>>::iterator it;
+
+        for (typename Input_Container_Device_Item_Type<T, Input_Container>::type item: items)
+        {
+            insert(std::move(item));
+        }
+    }
+
+    std::vector<Modbus_Pack<T>> container_;
+private:
+    void insert(T&& item)
+    {
+        typename std::vector<Modbus_Pack<T>>::iterator it = container_.begin();
+        for (; it != container_.end(); ++it)
+        {
+            if (*it < Modbus_Pack_Item_Cast<T>::run(item))
+            {
+                continue;
+            }
+            else if (it->add_next(std::move(item)))
+            {
+                assign_next(it);
+                return;
+            }
+            else
+            {
+                create(it, std::move(item));
+                return;
+            }
+        }
+
+        if (it == container_.end())
+        {
+            create(it, std::move(item));
+        }
+    }
+
+    void create(typename std::vector<Modbus_Pack<T>>::iterator it, T&& item)
+    {
+        Modbus_Pack pack(std::move(item));
+        if (pack.is_valid())
+        {
+            it = container_.insert(it, std::move(pack));
+            assign_next(it);
+        }
+    }
+
+    void assign_next(typename std::vector<Modbus_Pack<T>>::iterator it)
+    {
+        if (it != container_.end())
+        {
+            typename std::vector<Modbus_Pack<T>>::iterator old_it = it;
+            it++;
+            if (it != container_.end())
+            {
+                if (old_it->assign(*it))
+                {
+                    container_.erase(it);
+                }
+            }
+        }
+    }
+};
+
+// -----------------------------------------------------------------
+
+class Modbus_Pack_Read_Manager
+{
+public:
+    Modbus_Pack_Read_Manager(const Modbus_Pack_Read_Manager&) = delete;
+    Modbus_Pack_Read_Manager& operator =(const Modbus_Pack_Read_Manager&) = delete;
+    Modbus_Pack_Read_Manager(Device* dev, const std::vector<Modbus_Read_Pack>& packs) :
+        is_connected_(true), position_(-1), dev_(dev), packs_(packs)
+    {
+        qint64 timestamp_msecs = DB::Log_Base_Item::current_timestamp();
+
+        for (Modbus_Read_Pack &item_pack : packs_)
+        {
+            for (const std::pair<int, Device_Item*>& item : item_pack.items_)
+            {
+                new_values_.emplace(item.second, Device::Data_Item{0, timestamp_msecs, {}});
+            }
+        }
+    }
+
+    Modbus_Pack_Read_Manager(Modbus_Pack_Read_Manager&& o) :
+        is_connected_(std::move(o.is_connected_)), position_(std::move(o.position_)), dev_(o.dev_), packs_(std::move(o.packs_)), new_values_(std::move(o.new_values_))
+    {
+        o.packs_.clear();
+        o.new_values_.clear();
+    }
+
+    ~Modbus_Pack_Read_Manager()
+    {
+        if (packs_.empty())
+            return;
+
+        if (!is_connected_)
+        {
+            std::vector<Device_Item*> v;
+            for (const auto& it : new_values_)
+            {
+                v.push_back(it.first);
+            }
+            QMetaObject::invokeMethod(dev_, "set_device_items_disconnect", Q_ARG(std::vector<Device_Item*>, v));
+        }
+        else
+        {
+            QMetaObject::invokeMethod(dev_, "set_device_items_values",
+                                      QArgument<std::map<Device_Item*, Device::Data_Item>>("std::map<Device_Item*, Device::Data_Item>", new_values_), Q_ARG(bool, true));
+        }
+        while (packs_.size())
+        {
+            if (packs_.back().reply_)
+                QObject::disconnect(packs_.back().reply_, 0, 0, 0);
+            packs_.pop_back();
+        }
+    }
+
+    bool is_connected_;
+    int position_; // int becose -1 is default
+    Device* dev_;
+    std::vector<Modbus_Read_Pack> packs_;
+    std::map<Device_Item*, Device::Data_Item> new_values_;
+};
+
+
+// -----------------------------------------------------------------
+
+struct Modbus_Queue
+{
+    std::deque<Modbus_Pack<Write_Cache_Item>> write_;
+    std::deque<Modbus_Pack_Read_Manager> read_;
+
+    bool is_active() const
+    {
+        if (!read_.empty())
+        {
+            int position  = read_.front().position_;
+            if (position > -1 && read_.front().packs_.at(position).reply_)
+            {
+                return true;
+            }
+        }
+
+        return write_.size() && write_.front().reply_;
+    }
+
+    void clear()
+    {
+        while (write_.size())
+        {
+            if (write_.front().reply_)
+                QObject::disconnect(write_.front().reply_, 0, 0, 0);
+            write_.pop_front();
+        }
+
+        while (read_.size())
+        {
+            read_.pop_front();
+        }
+    }
+
+    void clear_by_address(int address)
+    {
+        for (std::size_t i = 0; i < write_.size(); ++i)
+        {
+            if (write_.front().server_address_ == address)
+            {
+                if (write_.front().reply_)
+                    QObject::disconnect(write_.front().reply_, 0, 0, 0);
+                write_.erase(write_.begin() + i);
+                --i;
+            }
+        }
+
+        std::deque<Modbus_Pack_Read_Manager> read;
+        for (auto& it : read_)
+        {
+            if (it.packs_.front().server_address_ != address)
+            {
+                read.push_back(std::move(it));
+            }
+        }
+        read_ = std::move(read);
+    }
+};
+
+
+Modbus_Bus::Modbus_Bus(const Config& config, bool is_port_name_in_config, QObject* parent) :
+    QObject(parent),
+    config_(config),
+    device_(nullptr),
+    b_break(false),
+    is_port_name_in_config_(is_port_name_in_config),
+    line_use_last_time_(std::chrono::system_clock::now())
+{
+    if (Config::is_tcp(config_.name))
+        device_ = new QModbusTcpClient(this);
+    else
+        device_ = new QModbusRtuSerialMaster(this);
+
+    process_queue_timer_.setSingleShot(true);
+    connect(&process_queue_timer_, &QTimer::timeout, this, &Modbus_Bus::process_queue);
+
+    queue_ = new Modbus_Queue;
+
+    read_planner_.set_max_gap(config_.read_register_gap_, config_.read_bit_gap_);
+
+    connect(device_, &QModbusClient::errorOccurred, this, [this](QModbusDevice::Error e)
+    {
+        queue_->clear();
+        //qCCritical(ModbusLog).noquote() << "Occurred:" << e << device_->errorString();
+        if (e == QModbusDevice::ConnectionError)
+            device_->disconnectDevice();
+    });
+
+    // TCP connection is established asynchronously.
+    // Queued, because serial port emits it from connectDevice called by process_queue.
+    connect(device_, &QModbusClient::stateChanged, this, [this](QModbusDevice::State state)
+    {
+        if (state == QModbusDevice::ConnectedState)
+            process_queue();
+    }, Qt::QueuedConnection);
+
+    Config::set(config_, device_);
+}
+
+Modbus_Bus::~Modbus_Bus()
+{
+    stop();
+
+    queue_->clear();
+    delete queue_;
+    queue_ = nullptr;
+}
+
+bool Modbus_Bus::check_break_flag() const
+{
+    return b_break;
+}
+
+void Modbus_Bus::clear_break_flag()
+{
+    if (b_break)
+        b_break = false;
+}
+
+const Config& Modbus_Bus::config() const
+{
+    return config_;
+}
+
+bool Modbus_Bus::checkConnect()
+{
+    if (device_->state() == QModbusDevice::ConnectedState || device_->state() == QModbusDevice::ConnectingState
+        || device_->connectDevice())
+    {
+        return true;
+    }
+
+    print_cached(0, QModbusDataUnit::Invalid, QModbusDevice::ConnectionError, tr("Connect failed: ") + device_->errorString());
+    return false;
+}
+
+QModbusClient* Modbus_Bus::device() const
+{
+    return device_;
+}
+
+void Modbus_Bus::write(std::vector<Write_Cache_Item>& items)
+{
+    if (!checkConnect() || !items.size() || b_break)
+        return;
+
+    Modbus_Pack_Builder<Write_Cache_Item> pack_builder(items);
+    for (Modbus_Pack<Write_Cache_Item>& pack: pack_builder.container_)
+    {
+        queue_->write_.push_back(std::move(pack));
+    }
+    process_queue();
+}
+
+void Modbus_Bus::stop()
+{
+    b_break = true;
+}
+
+void Modbus_Bus::clear_status_cache()
+{
+    dev_status_cache_.clear();
+}
+
+void Modbus_Bus::write_finished_slot()
+{
+    write_finished(qobject_cast<QModbusReply*>(sender()));
+}
+
+void Modbus_Bus::read_finished_slot()
+{
+    read_finished(qobject_cast<QModbusReply*>(sender()));
+}
+
+void Modbus_Bus::clear_queue()
+{
+    queue_->clear();
+}
+
+void Modbus_Bus::print_cached(int server_address, QModbusDataUnit::RegisterType register_type, QModbusDevice::Error value, const QString& text)
+{
+    auto request_pair = std::make_pair(server_address, register_type);
+    auto status_it = dev_status_cache_.find(request_pair);
+
+    if (status_it == dev_status_cache_.end() || status_it->second != value)
+    {
+        qCWarning(ModbusLog).noquote() << text;
+
+        if (status_it == dev_status_cache_.end())
+            dev_status_cache_[request_pair] = value;
+        else
+            status_it->second = value;
+    }
+}
+
+bool Modbus_Bus::reconnect()
+{
+    device_->disconnectDevice();
+
+    if (!is_port_name_in_config_)
+    {
+        config_.name = Config::getUSBSerial();
+        qCDebug(ModbusLog) << "No port name in config file. Use:" << config_.name;
+    }
+
+    if (!config_.name.isEmpty())
+    {
+        Config::set(config_, device_);
+
+        if (device_->connectDevice())
+        {
+            return true;
+        }
+        else
+        {
+            print_cached(0, QModbusDataUnit::Invalid, device_->error(), tr("Connect to port %1 fail: %2").arg(config_.name).arg(device_->errorString()));
+        }
+    }
+    else
+    {
+        print_cached(0, QModbusDataUnit::Invalid, QModbusDevice::ConnectionError, tr("USB Serial not found"));
+    }
+    return false;
+}
+
+void Modbus_Bus::read(Device* dev)
+{
+    // Previous read of this device is not finished yet
+    for (auto& it : queue_->read_)
+    {
+        if (it.dev_ == dev)
+        {
+            return;
+        }
+    }
+
+    const std::vector<Modbus_Read_Pack>& packs = read_planner_.get_plan(dev);
+    if (packs.empty())
+    {
+        return;
+    }
+
+//    qint64 elapsed = tt.restart();
+//    qWarning().nospace() << ">>>> read " << (elapsed < 100 ? (elapsed < 10 ? "  " : " ") : "") <<  elapsed << " \tsize " << dev->items().size() << ' ' << dev->toString();
+
+    queue_->read_.push_back(Modbus_Pack_Read_Manager{dev, packs});
+    process_queue();
+}
+
+void Modbus_Bus::process_queue()
+{
+    if (!b_break && !queue_->is_active())
+    {
+        if (device_->state() != QModbusDevice::ConnectedState && device_->state() != QModbusDevice::ConnectingState && !reconnect())
+        {
+            queue_->clear();
+            return;
+        }
+        else if (device_->state() == QModbusDevice::ConnectingState)
+        {
+            return; // Queue is processed when TCP connection is established
+        }
+        else
+        {
+            auto status_it = dev_status_cache_.find(std::make_pair(0, QModbusDataUnit::Invalid));
+            if (status_it != dev_status_cache_.end())
+            {
+                qCDebug(ModbusLog) << "Modbus device opened";
+                dev_status_cache_.erase(status_it);
+            }
+        }
+
+        const std::chrono::system_clock::duration elapsed_time = std::chrono::system_clock::now() - line_use_last_time_;
+        if (elapsed_time < config_.line_use_timeout_)
+        {
+            if (!process_queue_timer_.isActive())
+            {
+                auto elapsed_msec = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed_time);
+                process_queue_timer_.start((config_.line_use_timeout_ - elapsed_msec).count());
+            }
+            return;
+        }
+
+        if (queue_->write_.size())
+        {
+            Modbus_Pack<Write_Cache_Item>& pack = queue_->write_.front();
+            write_pack(pack.server_address_, pack.register_type_, pack.start_address_, pack.items_, &pack.reply_);
+            if (!pack.reply_)
+            {
+                queue_->write_.pop_front();
+                process_queue();
+            }
+        }
+        else if (queue_->read_.size())
+        {
+            Modbus_Pack_Read_Manager& modbus_pack_read_manager = queue_->read_.front();
+            ++modbus_pack_read_manager.position_;
+            if (modbus_pack_read_manager.position_ >= static_cast<int>(modbus_pack_read_manager.packs_.size()))
+            {
+                queue_->read_.pop_front();
+                process_queue();
+            }
+            else
+            {
+                Modbus_Read_Pack& pack = modbus_pack_read_manager.packs_.at(modbus_pack_read_manager.position_);
+//                qint64 elapsed = tt.restart();
+//                qWarning().nospace() << "->>>> read " << (elapsed < 100 ? (elapsed < 10 ? "  " : " ") : "") <<  elapsed << " \tsize " << pack.count_ << ' ' << modbus_pack_read_manager.dev_->toString();
+                read_pack(pack.server_address_, pack.register_type_, pack.start_address_, pack.count_, &pack.reply_);
+
+                if (!pack.reply_)
+                {
+                    process_queue();
+                }
+            }
+        }
+    }
+    else if (b_break && queue_)
+        queue_->clear();
+}
+
+QVector<quint16> Modbus_Bus::cache_items_to_values(const std::vector<Write_Cache_Item>& items) const
+{
+    QVector<quint16> values;
+    quint16 write_data;
+    for (const Write_Cache_Item& item: items)
+    {
+        if (item.raw_data_.type() == QVariant::Bool)
+            write_data = item.raw_data_.toBool() ? 1 : 0;
+        else
+            write_data = item.raw_data_.toUInt();
+        values.push_back(write_data);
+
+    }
+    return values;
+}
+
+void Modbus_Bus::write_pack(int server_address, QModbusDataUnit::RegisterType register_type, int start_address, const std::vector<Write_Cache_Item>& items, QModbusReply** reply)
+{
+    if (!items.size() || device_->state() != QModbusDevice::ConnectedState)
+        return;
+
+    QVector<quint16> values = cache_items_to_values(items);
+    qCDebug(ModbusDetailLog).noquote().nospace()
+            << items.front().user_id_ << "|WRITE " << values << ' '
+            << (register_type == QModbusDataUnit::Coils ? "Coils" : "HoldingRegisters")
+            << " START " << start_address << " TO ADR " << server_address;
+
+    QModbusDataUnit write_unit(register_type, start_address, values);
+    *reply = device_->sendWriteRequest(write_unit, server_address);
+
+    if (*reply)
+    {
+        if ((*reply)->isFinished())
+        {
+            write_finished(*reply);
+        }
+        else
+        {
+            connect(*reply, &QModbusReply::finished, this, &Modbus_Bus::write_finished_slot);
+        }
+    }
+    else
+        qCCritical(ModbusLog).noquote() << tr("Write error: ") + device_->errorString();
+}
+
+void Modbus_Bus::write_finished(QModbusReply* reply)
+{
+    line_use_last_time_ = std::chrono::system_clock::now();
+    if (!reply || b_break)
+    {
+        qCCritical(ModbusLog).noquote() << tr("Write finish error: ") + device_->errorString();
+        if (reply)
+        {
+            reply->deleteLater();
+        }
+        process_queue();
+        return;
+    }
+
+    if (queue_->write_.size())
+    {
+        Modbus_Pack<Write_Cache_Item>& pack = queue_->write_.front();
+        if (reply != pack.reply_)
+        {
+            qCCritical(ModbusLog).noquote() << tr("Write finished but is not queue front") << reply << pack.reply_;
+        }
+
+        pack.reply_ = nullptr;
+
+        queue_->write_.pop_front();
+
+        if (reply->error() != QModbusDevice::NoError)
+        {
+            qCWarning(ModbusLog).noquote() << tr("Write response error: %1 Device address: %2 (%3) Function: %4 Start unit: %5 Data:")
+                          .arg(reply->errorString())
+                          .arg(reply->serverAddress())
+                          .arg(reply->error() == QModbusDevice::ProtocolError ?
+                                   tr("Mobus exception: 0x%1").arg(reply->rawResult().exceptionCode(), -1, 16) :
+                                   tr("code: 0x%1").arg(reply->error(), -1, 16))
+                          .arg(pack.register_type_).arg(pack.start_address_) << cache_items_to_values(pack.items_);
+            queue_->clear_by_address(reply->serverAddress());
+        }
+    }
+    else
+        qCCritical(ModbusLog).noquote() << tr("Write finished but queue is empty");
+
+    reply->deleteLater();
+    process_queue();
+}
+
+void Modbus_Bus::read_pack(int server_address, QModbusDataUnit::RegisterType register_type, int start_address, int count, QModbusReply** reply)
+{
+    QModbusDataUnit request(register_type, start_address, count);
+    *reply = device_->sendReadRequest(request, server_address);
+
+    if (*reply)
+    {
+        if ((*reply)->isFinished())
+        {
+            read_finished(*reply);
+        }
+        else
+        {
+            connect(*reply, &QModbusReply::finished, this, &Modbus_Bus::read_finished_slot);
+        }
+    }
+    else
+        qCCritical(ModbusLog).noquote() << tr("Read error: ") + device_->errorString();
+}
+
+void Modbus_Bus::read_finished(QModbusReply* reply)
+{
+    line_use_last_time_ = std::chrono::system_clock::now();
+    if (!reply || b_break)
+    {
+        qCCritical(ModbusLog).noquote() << tr("Read finish error: ") + device_->errorString();
+        if (reply)
+        {
+            reply->deleteLater();
+        }
+        process_queue();
+        return;
+    }
+
+    if (queue_->read_.size())
+    {
+        Modbus_Pack_Read_Manager& modbus_pack_read_manager = queue_->read_.front();
+        Modbus_Read_Pack& pack = modbus_pack_read_manager.packs_.at(modbus_pack_read_manager.position_);
+        if (reply != pack.reply_)
+        {
+            qCCritical(ModbusLog).noquote() << tr("Read finished but is not queue front") << reply << pack.reply_;
+        }
+
+        pack.reply_ = nullptr;
+
+        if (reply->error() != QModbusDevice::NoError)
+        {
+            modbus_pack_read_manager.is_connected_ = false;
+            print_cached(pack.server_address_, pack.register_type_, reply->error(), tr("Read response error: %5 Device address: %1 (%6) registerType: %2 Start: %3 Value count: %4")
+                         .arg(pack.server_address_).arg(pack.register_type_).arg(pack.start_address_).arg(pack.count_)
+                         .arg(reply->errorString())
+                         .arg(reply->error() == QModbusDevice::ProtocolError ?
+                                tr("Mobus exception: 0x%1").arg(reply->rawResult().exceptionCode(), -1, 16) :
+                                  tr("code: 0x%1").arg(reply->error(), -1, 16)));
+
+            if (reply->error() == QModbusDevice::ProtocolError && pack.has_gap())
+            {
+                qCWarning(ModbusLog) << "Modbus device" << pack.server_address_ << "is read without gaps from now";
+                read_planner_.disable_gaps(modbus_pack_read_manager.dev_);
+            }
+
+            queue_->clear_by_address(pack.server_address_);
+        }
+        else
+        {
+            QVariant raw_data;
+            const QModbusDataUnit unit = reply->result();
+            for (const std::pair<int, Device_Item*>& item: pack.items_)
+            {
+                if (item.first < static_cast<int>(unit.valueCount()))
+                {
+                    if (pack.register_type_ == QModbusDataUnit::Coils ||
+                            pack.register_type_ == QModbusDataUnit::DiscreteInputs)
+                    {
+                        raw_data = static_cast<bool>(unit.value(item.first));
+                    }
+                    else
+                    {
+                        raw_data = static_cast<qint32>(unit.value(item.first));
+                    }
+                }
+                else
+                    raw_data.clear();
+
+                modbus_pack_read_manager.new_values_.at(item.second).raw_data_ = raw_data;
+    //                QMetaObject::invokeMethod(item.second, "set_raw_value", Qt::QueuedConnection, Q_ARG(const QVariant&, raw_data));
+            }
+
+            auto status_it = dev_status_cache_.find(std::make_pair(pack.server_address_, pack.register_type_));
+            if (status_it != dev_status_cache_.end())
+            {
+                qCDebug(ModbusLog) << "Modbus device" << pack.server_address_ << "recovered" << status_it->second
+                         << "RegisterType:" << pack.register_type_ << "Start:" << pack.start_address_ << "Value count:" << pack.count_;
+                dev_status_cache_.erase(status_it);
+            }
+        }
+    }
+    else
+        qCCritical(ModbusLog).noquote() << tr("Read finished but queue is empty");
+
+    reply->deleteLater();
+    process_queue();
+}
+
@@ -0,0 +1,77 @@
+#ifndef DAS_MODBUS_BUS_H
+#define DAS_MODBUS_BUS_H
+
+#include <chrono>
+#include <map>
+
+#include <QModbusClient>
+#include <QTimer>
+
+#include <Das/write_cache_item.h>
+
+#include "config.h"
+#include "modbus_read_planner.h"
+
+namespace Das {
+
+class Device;
+
+namespace Modbus {
+
+struct Modbus_Queue;
+
+// One physical line: serial port or TCP gateway.
+// Every bus has own master and queue, so buses is polled at the same time.
+// Write requests of bus is sent before read requests.
+class Modbus_Bus : public QObject
+{
+    Q_OBJECT
+public:
+    Modbus_Bus(const Config& config, bool is_port_name_in_config = true, QObject* parent = nullptr);
+    ~Modbus_Bus();
+
+    const Config& config() const;
+    QModbusClient* device() const;
+
+    bool check_break_flag() const;
+    void clear_break_flag();
+
+    bool checkConnect();
+
+    void read(Device* dev);
+    void write(std::vector<Write_Cache_Item>& items);
+    void stop();
+
+    void clear_status_cache();
+private slots:
+    void write_finished_slot();
+    void read_finished_slot();
+private:
+    void clear_queue();
+    void print_cached(int server_address, QModbusDataUnit::RegisterType register_type, QModbusDevice::Error value, const QString& text);
+    bool reconnect();
+    void process_queue();
+    QVector<quint16> cache_items_to_values(const std::vector<Write_Cache_Item>& items) const;
+    void write_pack(int server_address, QModbusDataUnit::RegisterType register_type, int start_address, const std::vector<Write_Cache_Item>& items, QModbusReply** reply);
+    void write_finished(QModbusReply* reply);
+    void read_pack(int server_address, QModbusDataUnit::RegisterType register_type, int start_address, int count, QModbusReply** reply);
+    void read_finished(QModbusReply* reply);
+
+    typedef std::map<std::pair<int, QModbusDataUnit::RegisterType>, QModbusDevice::Error> StatusCacheMap;
+    StatusCacheMap dev_status_cache_;
+
+    Config config_;
+    QModbusClient* device_;
+
+    Modbus_Queue* queue_;
+    Modbus_Read_Planner read_planner_;
+
+    bool b_break, is_port_name_in_config_;
+    std::chrono::system_clock::time_point line_use_last_time_;
+    QTimer process_queue_timer_;
+};
+
+} // namespace Modbus
+} // namespace Das
+
+#endif // DAS_MODBUS_BUS_H
@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <tuple>
+
+#include <Das/device_item.h>
+#include <Das/device.h>
+
+#include "modbus_plugin_base.h"
+#include "modbus_read_planner.h"
+
+namespace Das {
+namespace Modbus {
+
+bool Modbus_Read_Pack::has_gap() const
+{
+    int next_offset = 0;
+    for (const std::pair<int, Device_Item*>& item: items_)
+    {
+        if (item.first > next_offset)
+            return true;
+        next_offset = item.first + 1;
+    }
+    return next_offset < count_;
+}
+
+// -----------------------------------------------------------------
+
+Modbus_Read_Planner::Modbus_Read_Planner(int max_register_gap, int max_bit_gap) :
+    max_register_gap_(max_register_gap), max_bit_gap_(max_bit_gap)
+{
+}
+
+void Modbus_Read_Planner::set_max_gap(int max_register_gap, int max_bit_gap)
+{
+    max_register_gap_ = std::max(max_register_gap, 0);
+    max_bit_gap_ = std::max(max_bit_gap, 0);
+    plans_.clear();
+}
+
+const std::vector<Modbus_Read_Pack>& Modbus_Read_Planner::get_plan(Device* dev)
+{
+    auto it = plans_.find(dev);
+    if (it == plans_.end())
+    {
+        it = plans_.emplace(dev, Device_Plan{true, {}, {}}).first;
+        build(dev, it->second);
+    }
+    else if (it->second.items_ != dev->items())
+        build(dev, it->second);
+
+    return it->second.packs_;
+}
+
+void Modbus_Read_Planner::disable_gaps(Device* dev)
+{
+    auto it = plans_.find(dev);
+    if (it != plans_.end() && it->second.is_gap_allowed_)
+    {
+        it->second.is_gap_allowed_ = false;
+        build(dev, it->second);
+    }
+}
+
+void Modbus_Read_Planner::clear()
+{
+    plans_.clear();
+}
+
+void Modbus_Read_Planner::build(Device* dev, Device_Plan& plan) const
+{
+    plan.items_ = dev->items();
+    plan.packs_.clear();
+
+    bool ok;
+    const int server_address = Modbus_Plugin_Base::address(dev, &ok);
+    if (!ok || server_address <= 0)
+        return;
+
+    std::vector<std::tuple<QModbusDataUnit::RegisterType, int, Device_Item*>> units;
+    for (Device_Item* dev_item: plan.items_)
+    {
+        const int unit = Modbus_Plugin_Base::unit(dev_item, &ok);
+        if (!ok || unit < 0
+            || dev_item->register_type() <= QModbusDataUnit::Invalid
+            || dev_item->register_type() > QModbusDataUnit::HoldingRegisters)
+            continue;
+
+        units.emplace_back(static_cast<QModbusDataUnit::RegisterType>(dev_item->register_type()), unit, dev_item);
+    }
+
+    std::stable_sort(units.begin(), units.end(), [](const auto& a, const auto& b)
+    {
+        return std::tie(std::get<0>(a), std::get<1>(a)) < std::tie(std::get<0>(b), std::get<1>(b));
+    });
+
+    Modbus_Read_Pack* pack = nullptr;
+    for (const auto& it: units)
+    {
+        const QModbusDataUnit::RegisterType register_type = std::get<0>(it);
+        const int unit = std::get<1>(it);
+
+        const bool is_bit = register_type == QModbusDataUnit::Coils || register_type == QModbusDataUnit::DiscreteInputs;
+        const int max_gap = plan.is_gap_allowed_ ? (is_bit ? max_bit_gap_ : max_register_gap_) : 0;
+        const int max_count = is_bit ? max_bit_count : max_register_count;
+
+        if (!pack
+            || pack->register_type_ != register_type
+            || unit - (pack->start_address_ + pack->count_) > max_gap
+            || unit - pack->start_address_ >= max_count)
+        {
+            plan.packs_.push_back(Modbus_Read_Pack{server_address, unit, 0, register_type, nullptr, {}});
+            pack = &plan.packs_.back();
+        }
+
+        const int offset = unit - pack->start_address_;
+        pack->count_ = std::max(pack->count_, offset + 1);
+        pack->items_.emplace_back(offset, std::get<2>(it));
+    }
+}
+
+} // namespace Modbus
+} // namespace Das
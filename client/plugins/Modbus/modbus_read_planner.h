@@ -0,0 +1,68 @@
+#ifndef DAS_MODBUS_READ_PLANNER_H
+#define DAS_MODBUS_READ_PLANNER_H
+
+#include <map>
+#include <vector>
+
+#include <QModbusDataUnit>
+#include <QVector>
+
+QT_FORWARD_DECLARE_CLASS(QModbusReply)
+
+namespace Das {
+
+class Device;
+class Device_Item;
+
+namespace Modbus {
+
+struct Modbus_Read_Pack
+{
+    bool has_gap() const;
+
+    int server_address_;
+    int start_address_;
+    int count_;
+    QModbusDataUnit::RegisterType register_type_;
+    QModbusReply* reply_;
+
+    std::vector<std::pair<int, Device_Item*>> items_; // Offset from start address and item
+};
+
+// Splits device items to read requests. Units close to each other is read by one request
+// even if there is a small gap between them, so request count is lower.
+// Plan is kept for device until its item list is changed.
+class Modbus_Read_Planner
+{
+public:
+    static constexpr int max_register_count = 125;
+    static constexpr int max_bit_count = 2000;
+
+    Modbus_Read_Planner(int max_register_gap = 0, int max_bit_gap = 0);
+
+    void set_max_gap(int max_register_gap, int max_bit_gap);
+
+    const std::vector<Modbus_Read_Pack>& get_plan(Device* dev);
+
+    // Device may answer with exception for unit in gap, then it's read without gaps
+    void disable_gaps(Device* dev);
+
+    void clear();
+private:
+    struct Device_Plan
+    {
+        bool is_gap_allowed_;
+        QVector<Device_Item*> items_;
+        std::vector<Modbus_Read_Pack> packs_;
+    };
+
+    void build(Device* dev, Device_Plan& plan) const;
+
+    int max_register_gap_, max_bit_gap_;
+    std::map<Device*, Device_Plan> plans_;
+};
+
+} // namespace Modbus
+} // namespace Das
+
+#endif // DAS_MODBUS_READ_PLANNER_H
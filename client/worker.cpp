@@ -18,6 +18,7 @@
 #include <Das/device.h>
 #include <Das/db/dig_status.h>
 #include <Das/db/dig_mode.h>
+#include <Das/blob_store.h>
 
 #include "dbus_object.h"
 #include "worker.h"
@@ -47,6 +48,7 @@ Worker::Worker(QObject *parent) :
     init_logging(s.get());
     init_dbus(s.get());
     init_database(s.get());
+    init_blob_store(s.get());
     init_scheme(s.get()); // инициализация структуры проекта
     init_log_timer(); // сохранение статуса устройства по таймеру
     init_checker(s.get()); // запуск потока опроса устройств
@@ -209,6 +211,26 @@ void Worker::init_database(QSettings* s)
     db_pending_thread_.reset(new Helpz::DB::Thread);
 }
 
+void Worker::init_blob_store(QSettings* s)
+{
+    auto [blob_path, blob_keep_days] = Helpz::SettingsHelper(
+                s, "Blob",
+                Z::Param<QString>{"Path", QString()}, // Empty path disables blob store
+                Z::Param<int>{"KeepDays", 7})();
+
+    Blob_Store::instance().set_path(blob_path);
+    if (blob_path.isEmpty() || blob_keep_days <= 0)
+        return;
+
+    // Blob is needed only until server acknowledge it
+    const int keep_days = blob_keep_days;
+    connect(&blob_clean_timer_, &QTimer::timeout, this, [keep_days]()
+    {
+        Blob_Store::instance().remove_old(keep_days);
+    });
+    blob_clean_timer_.start(std::chrono::hours(1));
+}
+
 void Worker::init_scheme(QSettings* s)
 {
     qRegisterMetaType<QVector<DIG_Status>>("QVector<DIG_Status>");
@@ -228,9 +250,11 @@ void Worker::init_scheme(QSettings* s)
                                 s, "Server",
                                 Z::Param<QString>{"SSHHost", "80.89.129.98"},
                                 Z::Param<bool>{"AllowShell", false},
-                                Z::Param<bool>{"OnlyFromFolderIfExist", false}
+                                Z::Param<bool>{"OnlyFromFolderIfExist", false},
+                                Z::Param<QString>{"ScriptEngine", "qtscript"}
                             }();
-            prj_ = new Scripted_Scheme(this, cr, std::get<0>(server_conf), std::get<1>(server_conf));
+            prj_ = new Scripted_Scheme(this, cr, std::get<0>(server_conf), std::get<1>(server_conf),
+                                       std::get<2>(server_conf), std::get<3>(server_conf));
         }
 #endif
     }
@@ -241,7 +265,8 @@ void Worker::init_scheme(QSettings* s)
                               cr,
                               Z::Param<QString>{"SSHHost", "80.89.129.98"},
                               Z::Param<bool>{"AllowShell", false},
-                              Z::Param<bool>{"OnlyFromFolderIfExist", false}
+                              Z::Param<bool>{"OnlyFromFolderIfExist", false},
+                              Z::Param<QString>{"ScriptEngine", "qtscript"} // qtscript or qjs
                               );
         scheme_thread_->start(QThread::HighPriority);
     }
@@ -275,8 +300,8 @@ void Worker::init_network_client(QSettings* s)
     if (!auth_info)
         return;
 
-#define DAS_PROTOCOL_LATEST "das/2.6"
-#define DAS_PROTOCOL_SUPORTED DAS_PROTOCOL_LATEST",das/2.5"
+#define DAS_PROTOCOL_LATEST "das/2.8"
+#define DAS_PROTOCOL_SUPORTED DAS_PROTOCOL_LATEST",das/2.7,das/2.6,das/2.5"
 
     const QString default_dir = qApp->applicationDirPath() + '/';
     auto [ tls_policy_file, host, port, protocols, recpnnect_interval_sec ]
@@ -297,6 +322,9 @@ void Worker::init_network_client(QSettings* s)
     Helpz::DTLS::Create_Client_Protocol_Func_T func = [this, auth_info, config](const std::string& app_protocol) -> std::shared_ptr<Helpz::Net::Protocol>
     {
         std::shared_ptr<Ver::Client::Protocol> ptr = std::make_shared<Ver::Client::Protocol>(this, auth_info, config);
+        // Log packs is compressed since 2.7 and blob references is sent since 2.8
+        ptr->set_log_pack_compression(app_protocol == DAS_PROTOCOL_LATEST || app_protocol == "das/2.7");
+        Blob_Store::instance().set_ref_allowed(app_protocol == DAS_PROTOCOL_LATEST);
 
         if (app_protocol != DAS_PROTOCOL_LATEST)
         {
@@ -58,6 +58,7 @@ private:
     void init_logging(QSettings* s);
     void init_dbus(QSettings* s);
     void init_database(QSettings *s);
+    void init_blob_store(QSettings* s);
     void init_scheme(QSettings* s);
     void init_checker(QSettings* s);
     void init_network_client(QSettings* s);
@@ -100,7 +101,7 @@ private:
     std::unique_ptr<Helpz::DB::Thread> db_pending_thread_;
     Worker_Structure_Synchronizer* structure_sync_;
 
-    using Scripts_Thread = Helpz::SettingsThreadHelper<Scripted_Scheme, Worker*, Helpz::ConsoleReader*, QString, bool, bool>;
+    using Scripts_Thread = Helpz::SettingsThreadHelper<Scripted_Scheme, Worker*, Helpz::ConsoleReader*, QString, bool, bool, QString>;
     Scripts_Thread::Type* scheme_thread_;
     Scripted_Scheme* prj_;
 
@@ -113,7 +114,7 @@ private:
     friend class Scripted_Scheme;
 
     uint32_t restart_user_id_;
-    QTimer restart_timer_;
+    QTimer restart_timer_, blob_clean_timer_;
 
     Client::Dbus_Object* dbus_;
     Scheme_Info scheme_info_;
@@ -34,9 +34,11 @@ SOURCES += \
     log/log_base_item.cpp \
     log/log_event_item.cpp \
     log/log_mode_item.cpp \
+    log/log_pack_codec.cpp \
     log/log_param_item.cpp \
     log/log_status_item.cpp \
     log/log_value_item.cpp \
+    log/log_value_rollup.cpp \
     proto_scheme.cpp \
     scheme.cpp \
     section.cpp \
@@ -52,6 +54,7 @@ SOURCES += \
     db/plugin_type.cpp \
     type_managers.cpp \
     write_cache_item.cpp \
+    blob_store.cpp \
     db/device_item_value.cpp \
     db/device_item.cpp \
     db/device_extra_params.cpp \
@@ -60,7 +63,9 @@ SOURCES += \
     db/node.cpp \
     db/disabled_param.cpp \
     db/disabled_status.cpp \
-    db/chart.cpp
+    db/chart.cpp \
+    db/upsert_sql.cpp \
+    db/blob_scheme.cpp
 
 HEADERS +=\
     db/auth_group.h \
@@ -83,9 +88,11 @@ HEADERS +=\
     log/log_base_item.h \
     log/log_event_item.h \
     log/log_mode_item.h \
+    log/log_pack_codec.h \
     log/log_param_item.h \
     log/log_status_item.h \
     log/log_value_item.h \
+    log/log_value_rollup.h \
     proto_scheme.h \
     scheme.h \
     section.h \
@@ -104,6 +111,7 @@ HEADERS +=\
     db/plugin_type.h \
     type_managers.h \
     write_cache_item.h \
+    blob_store.h \
     db/device_item_value.h \
     db/device_item.h \
     db/device_extra_params.h \
@@ -112,7 +120,9 @@ HEADERS +=\
     db/node.h \
     db/disabled_param.h \
     db/disabled_status.h \
-    db/chart.h
+    db/chart.h \
+    db/upsert_sql.h \
+    db/blob_scheme.h
 
 DESTDIR = $${OUT_PWD}/../..
 
@@ -0,0 +1,275 @@
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDirIterator>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+#include <QDebug>
+
+#include <Das/db/device_item_value.h>
+
+#include "blob_store.h"
+
+namespace Das {
+
+namespace {
+const QLatin1String blob_ref_prefix("blob:");
+const QLatin1String ack_suffix(".ack");
+} // namespace
+
+/*static*/ Blob_Store &Blob_Store::instance()
+{
+    static Blob_Store store;
+    return store;
+}
+
+void Blob_Store::set_path(const QString &path)
+{
+    std::lock_guard lock(mutex_);
+    path_ = path;
+    if (!path_.isEmpty())
+    {
+        QDir dir;
+        dir.mkpath(path_);
+        dir.mkpath(path_ + "/partial");
+    }
+}
+
+QString Blob_Store::path() const
+{
+    std::lock_guard lock(mutex_);
+    return path_;
+}
+
+bool Blob_Store::is_enabled() const
+{
+    std::lock_guard lock(mutex_);
+    return !path_.isEmpty();
+}
+
+void Blob_Store::set_ref_allowed(bool state)
+{
+    std::lock_guard lock(mutex_);
+    is_ref_allowed_ = state;
+}
+
+bool Blob_Store::is_ref_allowed() const
+{
+    std::lock_guard lock(mutex_);
+    return is_ref_allowed_ && !path_.isEmpty();
+}
+
+/*static*/ QString Blob_Store::make_ref(const QByteArray &hash)
+{
+    return blob_ref_prefix + QString::fromLatin1(hash.toHex());
+}
+
+/*static*/ bool Blob_Store::is_ref(const QVariant &value)
+{
+    return value.type() == QVariant::String
+            && value.toString().startsWith(blob_ref_prefix)
+            && is_valid_hash(hash_from_ref(value));
+}
+
+/*static*/ QByteArray Blob_Store::hash_from_ref(const QVariant &value)
+{
+    if (value.type() != QVariant::String)
+        return {};
+
+    const QString text = value.toString();
+    if (!text.startsWith(blob_ref_prefix))
+        return {};
+    return QByteArray::fromHex(text.mid(blob_ref_prefix.size()).toLatin1());
+}
+
+/*static*/ bool Blob_Store::is_valid_hash(const QByteArray &hash)
+{
+    return hash.size() == 20; // SHA1
+}
+
+QString Blob_Store::file_path(const QByteArray &hash) const
+{
+    const QString hex = QString::fromLatin1(hash.toHex());
+    return path() + '/' + hex.left(2) + '/' + hex;
+}
+
+bool Blob_Store::contains(const QByteArray &hash) const
+{
+    return is_enabled() && is_valid_hash(hash) && QFile::exists(file_path(hash));
+}
+
+QByteArray Blob_Store::put(const QByteArray &data)
+{
+    const QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+    if (!is_enabled() || contains(hash))
+        return hash;
+
+    const QString file_name = file_path(hash);
+    QDir().mkpath(QFileInfo(file_name).absolutePath());
+
+    QSaveFile file(file_name);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit())
+    {
+        qWarning() << "Blob_Store: Can't write blob" << file_name << file.errorString();
+        return {};
+    }
+    return hash;
+}
+
+bool Blob_Store::put_if_big(QVariant &value)
+{
+    if (!is_ref_allowed() || !Device_Item_Value::is_big_value(value))
+        return false;
+
+    const QByteArray hash = put(value.type() == QVariant::ByteArray ? value.toByteArray() : value.toString().toUtf8());
+    if (hash.isEmpty())
+        return false;
+
+    value = make_ref(hash);
+    return true;
+}
+
+void Blob_Store::set_acknowledged(const QByteArray &hash)
+{
+    if (!contains(hash))
+        return;
+
+    QFile file(file_path(hash) + ack_suffix);
+    if (!file.exists() && !file.open(QIODevice::WriteOnly))
+        qWarning() << "Blob_Store: Can't write ack" << file.fileName() << file.errorString();
+}
+
+QByteArray Blob_Store::read(const QByteArray &hash, qint64 offset, qint64 &total_size) const
+{
+    total_size = -1;
+    if (!is_enabled() || !is_valid_hash(hash))
+        return {};
+
+    QFile file(file_path(hash));
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+
+    total_size = file.size();
+    if (offset < 0 || offset > total_size || !file.seek(offset))
+        return {};
+    return file.read(chunk_size);
+}
+
+QString Blob_Store::partial_file_path(const QByteArray &hash, uint32_t owner_id) const
+{
+    return path() + "/partial/" + QString::number(owner_id) + '_' + QString::fromLatin1(hash.toHex());
+}
+
+QVector<QByteArray> Blob_Store::partial_hashes(uint32_t owner_id) const
+{
+    QVector<QByteArray> hashes;
+    if (!is_enabled())
+        return hashes;
+
+    const QString prefix = QString::number(owner_id) + '_';
+    const QStringList file_names = QDir(path() + "/partial").entryList({prefix + '*'}, QDir::Files);
+    for (const QString& file_name: file_names)
+    {
+        const QByteArray hash = QByteArray::fromHex(file_name.mid(prefix.size()).toLatin1());
+        if (is_valid_hash(hash))
+            hashes.push_back(hash);
+    }
+    return hashes;
+}
+
+qint64 Blob_Store::partial_size(const QByteArray &hash, uint32_t owner_id) const
+{
+    const QFileInfo info(partial_file_path(hash, owner_id));
+    return info.exists() ? info.size() : 0;
+}
+
+bool Blob_Store::append_partial(const QByteArray &hash, uint32_t owner_id, qint64 offset, const QByteArray &data)
+{
+    if (!is_enabled() || !is_valid_hash(hash))
+        return false;
+
+    QFile file(partial_file_path(hash, owner_id));
+    if (!file.open(QIODevice::ReadWrite) || file.size() != offset || !file.seek(offset))
+        return false;
+    return file.write(data) == data.size();
+}
+
+bool Blob_Store::finish_partial(const QByteArray &hash, uint32_t owner_id)
+{
+    const QString partial_name = partial_file_path(hash, owner_id);
+
+    QFile file(partial_name);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QCryptographicHash file_hash(QCryptographicHash::Sha1);
+    if (!file_hash.addData(&file) || file_hash.result() != hash)
+    {
+        file.close();
+        file.remove();
+        return false;
+    }
+    file.close();
+
+    const QString file_name = file_path(hash);
+    if (QFile::exists(file_name))
+        return file.remove();
+
+    QDir().mkpath(QFileInfo(file_name).absolutePath());
+    return file.rename(file_name);
+}
+
+void Blob_Store::remove_partial(const QByteArray &hash, uint32_t owner_id)
+{
+    QFile::remove(partial_file_path(hash, owner_id));
+}
+
+int Blob_Store::remove_old(int max_age_days)
+{
+    if (!is_enabled() || max_age_days <= 0)
+        return 0;
+
+    int count = 0;
+    const QDateTime min_time = QDateTime::currentDateTime().addDays(-max_age_days);
+    QDirIterator it(path(), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        it.next();
+        if (!is_valid_hash(QByteArray::fromHex(it.fileName().toLatin1()))
+            || it.fileInfo().lastModified() >= min_time)
+            continue;
+
+        // Blob which is not received by server yet is kept
+        const QString ack_name = it.filePath() + ack_suffix;
+        if (QFile::exists(ack_name) && QFile::remove(it.filePath()))
+        {
+            QFile::remove(ack_name);
+            ++count;
+        }
+    }
+    return count;
+}
+
+int Blob_Store::remove_unused(int max_age_days, const std::function<bool(const QByteArray& hash)>& is_used)
+{
+    if (!is_enabled() || max_age_days <= 0)
+        return 0;
+
+    int count = 0;
+    const QDateTime min_time = QDateTime::currentDateTime().addDays(-max_age_days);
+    QDirIterator it(path(), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        it.next();
+        const QByteArray hash = QByteArray::fromHex(it.fileName().toLatin1());
+        if (!is_valid_hash(hash) || it.fileInfo().lastModified() >= min_time || is_used(hash))
+            continue;
+
+        if (QFile::remove(it.filePath()))
+            ++count;
+    }
+    return count;
+}
+
+} // namespace Das
@@ -0,0 +1,78 @@
+#ifndef DAS_BLOB_STORE_H
+#define DAS_BLOB_STORE_H
+
+#include <mutex>
+#include <functional>
+
+#include <QVariant>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include <Das/daslib_global.h>
+
+namespace Das {
+
+// Content addressed storage for big device item values.
+// Blob is file named by SHA1 of its data, so same data is stored once.
+// Value of log item keeps only reference "blob:<sha1 hex>" to it.
+class DAS_LIBRARY_SHARED_EXPORT Blob_Store
+{
+public:
+    static constexpr qint64 chunk_size = 48 * 1024;
+
+    static Blob_Store& instance();
+
+    // Empty path disables store
+    void set_path(const QString& path);
+    QString path() const;
+    bool is_enabled() const;
+
+    // Server supports blob references (protocol das/2.8), set when connection protocol is chosen
+    void set_ref_allowed(bool state);
+    bool is_ref_allowed() const;
+
+    static QString make_ref(const QByteArray& hash);
+    static bool is_ref(const QVariant& value);
+    static QByteArray hash_from_ref(const QVariant& value);
+    static bool is_valid_hash(const QByteArray& hash);
+
+    QString file_path(const QByteArray& hash) const;
+    bool contains(const QByteArray& hash) const;
+
+    // Save data to store and return its hash
+    QByteArray put(const QByteArray& data);
+
+    // Replace big value with reference to blob if references is allowed. Returns false if value isn't changed.
+    bool put_if_big(QVariant& value);
+
+    // Server has saved blob to its store, so it can be removed by remove_old
+    void set_acknowledged(const QByteArray& hash);
+
+    // Read part of blob. total_size is -1 if blob not found.
+    QByteArray read(const QByteArray& hash, qint64 offset, qint64& total_size) const;
+
+    // Partial blob is received by chunks and may be resumed after reconnect
+    QString partial_file_path(const QByteArray& hash, uint32_t owner_id) const;
+    QVector<QByteArray> partial_hashes(uint32_t owner_id) const;
+    qint64 partial_size(const QByteArray& hash, uint32_t owner_id) const;
+    bool append_partial(const QByteArray& hash, uint32_t owner_id, qint64 offset, const QByteArray& data);
+    bool finish_partial(const QByteArray& hash, uint32_t owner_id);
+    void remove_partial(const QByteArray& hash, uint32_t owner_id);
+
+    // Remove acknowledged blobs which isn't modified more than max_age_days
+    int remove_old(int max_age_days);
+
+    // Remove blobs which isn't modified more than max_age_days and isn't used. Used on server.
+    int remove_unused(int max_age_days, const std::function<bool(const QByteArray& hash)>& is_used);
+private:
+    Blob_Store() = default;
+
+    bool is_ref_allowed_ = false;
+    QString path_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace Das
+
+#endif // DAS_BLOB_STORE_H
@@ -48,6 +48,9 @@ namespace Cmd {
 
         SET_SCHEME_NAME,
 
+        BLOB_REQUEST, // QByteArray hash, qint64 offset
+        BLOB_STORED, // QByteArray hash
+
         /*
             cmdCreateDevice,
             cmdSetInform,
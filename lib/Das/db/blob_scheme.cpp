@@ -0,0 +1,21 @@
+#include "blob_scheme.h"
+
+namespace Das {
+namespace DB {
+
+Blob_Scheme::Blob_Scheme(const QString& hash, qint64 timestamp_msecs) :
+    id_(0), hash_(hash), timestamp_msecs_(timestamp_msecs)
+{
+}
+
+uint32_t Blob_Scheme::id() const { return id_; }
+void Blob_Scheme::set_id(uint32_t id) { id_ = id; }
+
+QString Blob_Scheme::hash() const { return hash_; }
+void Blob_Scheme::set_hash(const QString& hash) { hash_ = hash; }
+
+qint64 Blob_Scheme::timestamp_msecs() const { return timestamp_msecs_; }
+void Blob_Scheme::set_timestamp_msecs(qint64 timestamp_msecs) { timestamp_msecs_ = timestamp_msecs; }
+
+} // namespace DB
+} // namespace Das
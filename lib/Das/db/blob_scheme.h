@@ -0,0 +1,43 @@
+#ifndef DAS_DATABASE_BLOB_SCHEME_H
+#define DAS_DATABASE_BLOB_SCHEME_H
+
+#include <Helpz/db_meta.h>
+
+#include <Das/daslib_global.h>
+#include <Das/db/schemed_model.h>
+
+namespace Das {
+namespace DB {
+
+// Blob stored on server for scheme. Row is written when blob is received or already exists,
+// it's used to check access to blob and to remove blobs that isn't referenced anymore.
+// Table must have unique key on (hash, scheme_id).
+class DAS_LIBRARY_SHARED_EXPORT Blob_Scheme : public Schemed_Model
+{
+    HELPZ_DB_META(Blob_Scheme, "blob_scheme", "bs", DB_A(id), DB_A(hash), DB_A(timestamp_msecs), DB_A(scheme_id))
+public:
+    Blob_Scheme(const QString& hash = QString(), qint64 timestamp_msecs = 0);
+
+    uint32_t id() const;
+    void set_id(uint32_t id);
+
+    // SHA1 of blob in hex
+    QString hash() const;
+    void set_hash(const QString& hash);
+
+    // Last time when blob is referenced by scheme
+    qint64 timestamp_msecs() const;
+    void set_timestamp_msecs(qint64 timestamp_msecs);
+private:
+    uint32_t id_;
+    QString hash_;
+    qint64 timestamp_msecs_;
+};
+
+} // namespace DB
+
+using Blob_Scheme = DB::Blob_Scheme;
+
+} // namespace Das
+
+#endif // DAS_DATABASE_BLOB_SCHEME_H
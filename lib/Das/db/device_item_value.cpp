@@ -68,51 +68,59 @@ void Device_Item_Value::set_value_from_db(const QVariant& value)
     if (!var.isValid() || (var.type() != QVariant::String && var.type() != QVariant::ByteArray))
         return var;
 
-    QString text = var.toString();
+    const QString text = var.toString();
     if (text.isEmpty())
         return QVariant();
 
+    // Value type is detected by first char, so text is parsed only once
+    const QChar first = text.at(0);
     if (text.length() > 2)
     {
-        if (text.length() == 4 && text.toLower() == "true")
-            return true;
-        else if (text.length() == 5 && text.toLower() == "false")
-            return false;
-        else if ((text.at(0) == '[' && text.at(text.length() - 1) == ']') || (text.at(0) == '{' && text.at(text.length() - 1) == '}'))
+        if (first == '[' || first == '{')
         {
-            QJsonParseError parse_error;
-            parse_error.error = QJsonParseError::NoError;
-            QJsonDocument doc = QJsonDocument::fromJson(var.toByteArray(), &parse_error);
-            if (parse_error.error == QJsonParseError::NoError)
+            const QChar last = text.at(text.length() - 1);
+            if ((first == '[' && last == ']') || (first == '{' && last == '}'))
             {
+                QJsonParseError parse_error;
+                parse_error.error = QJsonParseError::NoError;
+                QJsonDocument doc = QJsonDocument::fromJson(text.toUtf8(), &parse_error);
+                if (parse_error.error != QJsonParseError::NoError)
+                    return text;
                 if (doc.isArray())
                     return doc.array().toVariantList();
                 if (doc.isObject())
                     return doc.object().toVariantMap();
             }
-            else
-                return text;
-        }
-        else if (text.startsWith("base64:"))
-        {
-            text.remove(0, 7);
-            return QByteArray::fromBase64(text.toLocal8Bit());
+            return text;
         }
+        else if (text.length() == 4 && (first == 't' || first == 'T') && text.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0)
+            return true;
+        else if (text.length() == 5 && (first == 'f' || first == 'F') && text.compare(QLatin1String("false"), Qt::CaseInsensitive) == 0)
+            return false;
+        else if (first == 'b' && text.startsWith(QLatin1String("base64:")))
+            return QByteArray::fromBase64(text.midRef(7).toLocal8Bit());
     }
 
+    if (!is_number_start(first))
+        return text;
+
     bool ok = false;
-    int int_val = text.toInt(&ok);
-    if (ok && text == QString::number(int_val))
-        return int_val;
+    if (is_canonical_int(text))
+    {
+        const int int_val = text.toInt(&ok);
+        if (ok)
+            return int_val;
+    }
 
     double dbl_val = text.toDouble(&ok);
     if (ok)
         return dbl_val;
 
-    if (text.indexOf('.') != -1 || text.indexOf(',') != -1) {
+    // Decimal comma
+    if (text.indexOf('.') == -1 && text.indexOf(',') != -1)
+    {
         QString t = text;
-        t = t.indexOf('.') != -1 ? t.replace('.', ',') : t.replace(',', '.');
-        dbl_val = t.toDouble(&ok);
+        dbl_val = t.replace(',', '.').toDouble(&ok);
         if (ok)
             return dbl_val;
     }
@@ -120,6 +128,34 @@ void Device_Item_Value::set_value_from_db(const QVariant& value)
     return text;
 }
 
+/*static*/ bool Device_Item_Value::is_number_start(QChar c)
+{
+    // 'n' and 'i' is for NaN and inf
+    switch (c.unicode())
+    {
+    case '+': case '-': case '.': case ',':
+    case 'n': case 'N': case 'i': case 'I':
+        return true;
+    default:
+        return c.isDigit() || c.isSpace();
+    }
+}
+
+/*static*/ bool Device_Item_Value::is_canonical_int(const QString &text)
+{
+    // Same as text == QString::number(text.toInt())
+    int pos = text.at(0) == '-' ? 1 : 0;
+    const int digit_count = text.length() - pos;
+    if (digit_count <= 0 || digit_count > 10
+        || (text.at(pos) == '0' && (digit_count > 1 || pos == 1)))
+        return false;
+
+    for (; pos < text.length(); ++pos)
+        if (text.at(pos) < '0' || text.at(pos) > '9')
+            return false;
+    return true;
+}
+
 bool Device_Item_Value::is_big_value() const
 {
     return is_big_value(raw_value_) || is_big_value(value_);
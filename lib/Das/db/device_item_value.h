@@ -48,6 +48,9 @@ public:
     bool is_big_value() const;
     static bool is_big_value(const QVariant& val);
 private:
+    static bool is_number_start(QChar c);
+    static bool is_canonical_int(const QString& text);
+
     uint32_t item_id_;
     QVariant raw_value_, value_;
 
@@ -0,0 +1,30 @@
+#include "upsert_sql.h"
+
+namespace Das {
+namespace DB {
+
+QString get_upsert_sql(const Helpz::DB::Table& table, int row_count, const QStringList& update_field_names)
+{
+    const int field_count = table.field_names().size();
+    const QString row_q = '(' + QString("?,").repeated(field_count - 1) + "?)";
+
+    QString sql = "INSERT INTO " + table.name() + '(' + table.field_names().join(',') + ") VALUES";
+    for (int i = 0; i < row_count; ++i)
+    {
+        if (i)
+            sql += ',';
+        sql += row_q;
+    }
+
+    sql += " ON DUPLICATE KEY UPDATE ";
+    for (const QString& name: update_field_names)
+    {
+        if (&name != &update_field_names.front())
+            sql += ", ";
+        sql += name + " = VALUES(" + name + ')';
+    }
+    return sql;
+}
+
+} // namespace DB
+} // namespace Das
@@ -0,0 +1,23 @@
+#ifndef DAS_DATABASE_UPSERT_SQL_H
+#define DAS_DATABASE_UPSERT_SQL_H
+
+#include <QStringList>
+
+#include <Helpz/db_table.h>
+
+#include <Das/daslib_global.h>
+
+namespace Das {
+namespace DB {
+
+// Returns multi-row "INSERT ... ON DUPLICATE KEY UPDATE" query used to save current values.
+// Row is replaced only if table has unique key on it: device_item_value (scheme_id, item_id),
+// dig_param_value (scheme_id, group_param_id) and dig_mode (scheme_id, group_id).
+// Use Upsert_Helper::save from DasPlus, it checks the key and falls back to update and insert.
+DAS_LIBRARY_SHARED_EXPORT QString get_upsert_sql(const Helpz::DB::Table& table, int row_count,
+                                                 const QStringList& update_field_names);
+
+} // namespace DB
+} // namespace Das
+
+#endif // DAS_DATABASE_UPSERT_SQL_H
@@ -75,7 +75,13 @@ Plugin_Type *Device::checker_type() const { return checker_type_; }
 
 const QVector<Device_Item *> &Device::items() const { return items_; }
 
-void Device::add_item(Device_Item *item) { items_.push_back(item); }
+void Device::add_item(Device_Item *item)
+{
+    items_.push_back(item);
+
+    if (Scheme* scheme = qobject_cast<Scheme*>(parent()))
+        scheme->add_item_to_index(item);
+}
 
 Device_Item *Device::create_item(Device_Item&& device_item)
 {
@@ -86,6 +92,9 @@ Device_Item *Device::create_item(Device_Item&& device_item)
         item->set_param_name_list(checker_type_->param_names_device_item());
 
     items_.push_back(item);
+
+    if (Scheme* scheme = qobject_cast<Scheme*>(parent()))
+        scheme->add_item_to_index(item);
     return item;
 }
 
@@ -0,0 +1,277 @@
+#include <cstring>
+
+#include <QtEndian>
+
+#include "log_base_item.h"
+#include "log_pack_codec.h"
+
+namespace Das {
+
+namespace {
+
+enum Value_Tag : quint8
+{
+    VT_INVALID,
+    VT_FALSE,
+    VT_TRUE,
+    VT_INT,
+    VT_DOUBLE,
+    VT_STRING,
+    VT_VARIANT
+};
+
+enum Row_Flags : quint8
+{
+    RF_FLAG = 0x01
+};
+
+quint64 zigzag(qint64 value) { return (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63); }
+qint64 unzigzag(quint64 value) { return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1); }
+
+class Writer
+{
+public:
+    Writer(QByteArray& data, int ds_version) : data_(data), ds_version_(ds_version) {}
+
+    void byte(quint8 value) { data_.append(static_cast<char>(value)); }
+
+    void varint(quint64 value)
+    {
+        while (value >= 0x80)
+        {
+            byte(static_cast<quint8>(value) | 0x80);
+            value >>= 7;
+        }
+        byte(static_cast<quint8>(value));
+    }
+
+    void bytes(const QByteArray& value)
+    {
+        varint(value.size());
+        data_.append(value);
+    }
+
+    void value(const QVariant& var)
+    {
+        switch (var.type())
+        {
+        case QVariant::Invalid:
+            byte(VT_INVALID);
+            break;
+        case QVariant::Bool:
+            byte(var.toBool() ? VT_TRUE : VT_FALSE);
+            break;
+        case QVariant::Int:
+            byte(VT_INT);
+            varint(zigzag(var.toInt()));
+            break;
+        case QVariant::Double:
+        {
+            byte(VT_DOUBLE);
+            const double number = var.toDouble();
+            quint64 bits;
+            std::memcpy(&bits, &number, sizeof(bits));
+            bits = qToLittleEndian(bits);
+            data_.append(reinterpret_cast<const char*>(&bits), sizeof(bits));
+            break;
+        }
+        case QVariant::String:
+            byte(VT_STRING);
+            bytes(var.toString().toUtf8());
+            break;
+        default:
+        {
+            byte(VT_VARIANT);
+            QByteArray buffer;
+            QDataStream ds(&buffer, QIODevice::WriteOnly);
+            ds.setVersion(ds_version_);
+            ds << var;
+            bytes(buffer);
+            break;
+        }
+        }
+    }
+
+private:
+    QByteArray& data_;
+    int ds_version_;
+};
+
+class Reader
+{
+public:
+    Reader(const QByteArray& data, int ds_version) : data_(data), pos_(0), ds_version_(ds_version), ok_(true) {}
+
+    bool ok() const { return ok_; }
+    bool at_end() const { return pos_ >= data_.size(); }
+
+    quint8 byte()
+    {
+        if (at_end())
+        {
+            ok_ = false;
+            return 0;
+        }
+        return static_cast<quint8>(data_.at(pos_++));
+    }
+
+    quint64 varint()
+    {
+        quint64 value = 0;
+        for (int shift = 0; shift < 64 && ok_; shift += 7)
+        {
+            const quint8 part = byte();
+            value |= static_cast<quint64>(part & 0x7F) << shift;
+            if (!(part & 0x80))
+                return value;
+        }
+        ok_ = false;
+        return 0;
+    }
+
+    QByteArray bytes()
+    {
+        const quint64 size = varint();
+        if (!ok_ || size > static_cast<quint64>(data_.size() - pos_))
+        {
+            ok_ = false;
+            return {};
+        }
+        const QByteArray value = data_.mid(pos_, static_cast<int>(size));
+        pos_ += static_cast<int>(size);
+        return value;
+    }
+
+    QVariant value()
+    {
+        switch (byte())
+        {
+        case VT_INVALID:    return QVariant();
+        case VT_FALSE:      return false;
+        case VT_TRUE:       return true;
+        case VT_INT:        return static_cast<int>(unzigzag(varint()));
+        case VT_DOUBLE:
+        {
+            if (data_.size() - pos_ < static_cast<int>(sizeof(quint64)))
+                break;
+            quint64 bits;
+            std::memcpy(&bits, data_.constData() + pos_, sizeof(bits));
+            pos_ += sizeof(bits);
+            bits = qFromLittleEndian(bits);
+            double number;
+            std::memcpy(&number, &bits, sizeof(number));
+            return number;
+        }
+        case VT_STRING:     return QString::fromUtf8(bytes());
+        case VT_VARIANT:
+        {
+            const QByteArray buffer = bytes();
+            QDataStream ds(buffer);
+            ds.setVersion(ds_version_);
+            QVariant var;
+            ds >> var;
+            if (ds.status() == QDataStream::Ok)
+                return var;
+            break;
+        }
+        default:
+            break;
+        }
+
+        ok_ = false;
+        return QVariant();
+    }
+
+private:
+    const QByteArray& data_;
+    int pos_;
+    int ds_version_;
+    bool ok_;
+};
+
+} // namespace
+
+/*static*/ QByteArray Log_Pack_Codec::encode(const QVector<Log_Value_Item> &pack, int ds_version)
+{
+    QByteArray data;
+    data.reserve(pack.size() * 16);
+
+    Writer writer(data, ds_version);
+    writer.byte(F_VALUE_DELTA);
+    writer.varint(pack.size());
+
+    // Rows are mostly sorted by time and items are saved in groups,
+    // so small deltas take one or two bytes instead of eight.
+    qint64 prev_timestamp = 0, prev_item_id = 0;
+    for (const Log_Value_Item& item: pack)
+    {
+        writer.varint(zigzag(item.timestamp_msecs() - prev_timestamp));
+        writer.byte(item.flag() ? RF_FLAG : 0);
+        writer.varint(item.user_id());
+        writer.varint(zigzag(static_cast<qint64>(item.item_id()) - prev_item_id));
+        writer.value(item.raw_value());
+        writer.value(item.value());
+
+        prev_timestamp = item.timestamp_msecs();
+        prev_item_id = item.item_id();
+    }
+
+    return compress(data);
+}
+
+/*static*/ bool Log_Pack_Codec::decode(const QByteArray &compressed, QVector<Log_Value_Item> &pack, int ds_version)
+{
+    const QByteArray data = uncompress(compressed);
+    if (data.isEmpty())
+        return false;
+
+    Reader reader(data, ds_version);
+    if (reader.byte() != F_VALUE_DELTA)
+        return false;
+
+    const quint64 count = reader.varint();
+    if (!reader.ok() || count > static_cast<quint64>(data.size())) // Each row takes at least one byte
+        return false;
+
+    pack.clear();
+    pack.reserve(static_cast<int>(count));
+
+    qint64 timestamp = 0, item_id = 0;
+    for (quint64 i = 0; i < count && reader.ok(); ++i)
+    {
+        timestamp += unzigzag(reader.varint());
+        const quint8 flags = reader.byte();
+        const uint32_t user_id = static_cast<uint32_t>(reader.varint());
+        item_id += unzigzag(reader.varint());
+        const QVariant raw_value = reader.value();
+        const QVariant value = reader.value();
+
+        pack.push_back(Log_Value_Item{timestamp, user_id, static_cast<uint32_t>(item_id), raw_value, value, bool(flags & RF_FLAG)});
+    }
+
+    if (!reader.ok() || !reader.at_end())
+    {
+        pack.clear();
+        return false;
+    }
+    return true;
+}
+
+/*static*/ QByteArray Log_Pack_Codec::compress(const QByteArray &data)
+{
+    // Fastest zlib level, pack is sent once so speed matters more than ratio
+    return qCompress(data, 1);
+}
+
+/*static*/ QByteArray Log_Pack_Codec::uncompress(const QByteArray &data)
+{
+    if (data.size() <= 4)
+        return {};
+
+    const QByteArray result = qUncompress(data);
+    if (result.isEmpty())
+        qCWarning(Sync_Log) << "Log_Pack_Codec: Can't uncompress log pack of size" << data.size();
+    return result;
+}
+
+} // namespace Das
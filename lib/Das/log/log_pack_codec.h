@@ -0,0 +1,64 @@
+#ifndef DAS_LOG_PACK_CODEC_H
+#define DAS_LOG_PACK_CODEC_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QVector>
+
+#include <Das/daslib_global.h>
+#include <Das/log/log_pack.h>
+
+namespace Das {
+
+// Compact network form of log pack, used when both sides support it.
+// Timestamps and item ids of value pack are delta encoded,
+// then the whole pack is compressed.
+class DAS_LIBRARY_SHARED_EXPORT Log_Pack_Codec
+{
+public:
+    enum Format : quint8
+    {
+        F_DATASTREAM = 1,
+        F_VALUE_DELTA
+    };
+
+    template<typename T>
+    static QByteArray encode(const QVector<T>& pack, int ds_version)
+    {
+        QByteArray data;
+        QDataStream ds(&data, QIODevice::WriteOnly);
+        ds.setVersion(ds_version);
+        ds << static_cast<quint8>(F_DATASTREAM) << pack;
+        return compress(data);
+    }
+
+    template<typename T>
+    static bool decode(const QByteArray& compressed, QVector<T>& pack, int ds_version)
+    {
+        const QByteArray data = uncompress(compressed);
+        if (data.isEmpty())
+            return false;
+
+        QDataStream ds(data);
+        ds.setVersion(ds_version);
+
+        quint8 format;
+        ds >> format;
+        if (format != F_DATASTREAM)
+            return false;
+
+        ds >> pack;
+        return ds.status() == QDataStream::Ok;
+    }
+
+    static QByteArray encode(const QVector<Log_Value_Item>& pack, int ds_version);
+    static bool decode(const QByteArray& compressed, QVector<Log_Value_Item>& pack, int ds_version);
+
+private:
+    static QByteArray compress(const QByteArray& data);
+    static QByteArray uncompress(const QByteArray& data);
+};
+
+} // namespace Das
+
+#endif // DAS_LOG_PACK_CODEC_H
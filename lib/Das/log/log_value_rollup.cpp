@@ -0,0 +1,78 @@
+#include "log_value_rollup.h"
+
+namespace Das {
+namespace DB {
+
+Log_Value_Rollup::Log_Value_Rollup(qint64 timestamp_msecs, uint32_t item_id) :
+    id_(0), item_id_(item_id), value_count_(0),
+    timestamp_msecs_(timestamp_msecs), last_timestamp_msecs_(0), min_timestamp_msecs_(0), max_timestamp_msecs_(0),
+    min_value_(0.), max_value_(0.), sum_value_(0.), last_value_(0.)
+{
+}
+
+uint32_t Log_Value_Rollup::id() const { return id_; }
+void Log_Value_Rollup::set_id(uint32_t id) { id_ = id; }
+
+qint64 Log_Value_Rollup::timestamp_msecs() const { return timestamp_msecs_; }
+void Log_Value_Rollup::set_timestamp_msecs(qint64 timestamp_msecs) { timestamp_msecs_ = timestamp_msecs; }
+
+uint32_t Log_Value_Rollup::item_id() const { return item_id_; }
+void Log_Value_Rollup::set_item_id(uint32_t item_id) { item_id_ = item_id; }
+
+uint32_t Log_Value_Rollup::value_count() const { return value_count_; }
+void Log_Value_Rollup::set_value_count(uint32_t value_count) { value_count_ = value_count; }
+
+double Log_Value_Rollup::min_value() const { return min_value_; }
+void Log_Value_Rollup::set_min_value(double min_value) { min_value_ = min_value; }
+
+double Log_Value_Rollup::max_value() const { return max_value_; }
+void Log_Value_Rollup::set_max_value(double max_value) { max_value_ = max_value; }
+
+double Log_Value_Rollup::sum_value() const { return sum_value_; }
+void Log_Value_Rollup::set_sum_value(double sum_value) { sum_value_ = sum_value; }
+
+double Log_Value_Rollup::last_value() const { return last_value_; }
+void Log_Value_Rollup::set_last_value(double last_value) { last_value_ = last_value; }
+
+qint64 Log_Value_Rollup::last_timestamp_msecs() const { return last_timestamp_msecs_; }
+void Log_Value_Rollup::set_last_timestamp_msecs(qint64 last_timestamp_msecs) { last_timestamp_msecs_ = last_timestamp_msecs; }
+
+qint64 Log_Value_Rollup::min_timestamp_msecs() const { return min_timestamp_msecs_; }
+void Log_Value_Rollup::set_min_timestamp_msecs(qint64 min_timestamp_msecs) { min_timestamp_msecs_ = min_timestamp_msecs; }
+
+qint64 Log_Value_Rollup::max_timestamp_msecs() const { return max_timestamp_msecs_; }
+void Log_Value_Rollup::set_max_timestamp_msecs(qint64 max_timestamp_msecs) { max_timestamp_msecs_ = max_timestamp_msecs; }
+
+void Log_Value_Rollup::add(qint64 timestamp_msecs, double value)
+{
+    if (value_count_ == 0)
+    {
+        min_value_ = max_value_ = value;
+        min_timestamp_msecs_ = max_timestamp_msecs_ = timestamp_msecs;
+    }
+    else
+    {
+        if (min_value_ > value || (min_value_ == value && min_timestamp_msecs_ > timestamp_msecs))
+        {
+            min_value_ = value;
+            min_timestamp_msecs_ = timestamp_msecs;
+        }
+        if (max_value_ < value || (max_value_ == value && max_timestamp_msecs_ > timestamp_msecs))
+        {
+            max_value_ = value;
+            max_timestamp_msecs_ = timestamp_msecs;
+        }
+    }
+
+    if (last_timestamp_msecs_ <= timestamp_msecs)
+    {
+        last_timestamp_msecs_ = timestamp_msecs;
+        last_value_ = value;
+    }
+
+    sum_value_ += value;
+    ++value_count_;
+}
+
+} // namespace DB
+} // namespace Das
@@ -0,0 +1,99 @@
+#ifndef DAS_DB_LOG_VALUE_ROLLUP_H
+#define DAS_DB_LOG_VALUE_ROLLUP_H
+
+#include <Helpz/db_meta.h>
+
+#include <Das/daslib_global.h>
+#include <Das/db/schemed_model.h>
+
+namespace Das {
+namespace DB {
+
+#define LOG_VALUE_ROLLUP_DB_META(x, y, z) \
+    HELPZ_DB_META(x, y, z, DB_A(id), DB_A(timestamp_msecs), DB_A(item_id), \
+              DB_A(value_count), DB_A(min_value), DB_A(max_value), DB_A(sum_value), \
+              DB_A(last_value), DB_A(last_timestamp_msecs), \
+              DB_A(min_timestamp_msecs), DB_A(max_timestamp_msecs), DB_A(scheme_id))
+
+// Aggregate of numeric log values of one item in one time bucket
+class DAS_LIBRARY_SHARED_EXPORT Log_Value_Rollup : public Schemed_Model
+{
+    LOG_VALUE_ROLLUP_DB_META(Log_Value_Rollup, "log_value_rollup", "lvr")
+public:
+    Log_Value_Rollup(qint64 timestamp_msecs = 0, uint32_t item_id = 0);
+
+    uint32_t id() const;
+    void set_id(uint32_t id);
+
+    // Bucket start
+    qint64 timestamp_msecs() const;
+    void set_timestamp_msecs(qint64 timestamp_msecs);
+
+    uint32_t item_id() const;
+    void set_item_id(uint32_t item_id);
+
+    uint32_t value_count() const;
+    void set_value_count(uint32_t value_count);
+
+    double min_value() const;
+    void set_min_value(double min_value);
+
+    double max_value() const;
+    void set_max_value(double max_value);
+
+    double sum_value() const;
+    void set_sum_value(double sum_value);
+
+    double last_value() const;
+    void set_last_value(double last_value);
+
+    qint64 last_timestamp_msecs() const;
+    void set_last_timestamp_msecs(qint64 last_timestamp_msecs);
+
+    // Time of first minimum and first maximum value in bucket
+    qint64 min_timestamp_msecs() const;
+    void set_min_timestamp_msecs(qint64 min_timestamp_msecs);
+
+    qint64 max_timestamp_msecs() const;
+    void set_max_timestamp_msecs(qint64 max_timestamp_msecs);
+
+    void add(qint64 timestamp_msecs, double value);
+private:
+    uint32_t id_, item_id_, value_count_;
+    qint64 timestamp_msecs_, last_timestamp_msecs_, min_timestamp_msecs_, max_timestamp_msecs_;
+    double min_value_, max_value_, sum_value_, last_value_;
+};
+
+class DAS_LIBRARY_SHARED_EXPORT Log_Value_Minute : public Log_Value_Rollup
+{
+    LOG_VALUE_ROLLUP_DB_META(Log_Value_Minute, "log_value_minute", "lvmi")
+public:
+    using Log_Value_Rollup::Log_Value_Rollup;
+    static constexpr qint64 interval_msecs = 60 * 1000;
+};
+
+class DAS_LIBRARY_SHARED_EXPORT Log_Value_Hour : public Log_Value_Rollup
+{
+    LOG_VALUE_ROLLUP_DB_META(Log_Value_Hour, "log_value_hour", "lvh")
+public:
+    using Log_Value_Rollup::Log_Value_Rollup;
+    static constexpr qint64 interval_msecs = 60 * 60 * 1000;
+};
+
+class DAS_LIBRARY_SHARED_EXPORT Log_Value_Day : public Log_Value_Rollup
+{
+    LOG_VALUE_ROLLUP_DB_META(Log_Value_Day, "log_value_day", "lvd")
+public:
+    using Log_Value_Rollup::Log_Value_Rollup;
+    static constexpr qint64 interval_msecs = 24 * 60 * 60 * 1000;
+};
+
+} // namespace DB
+
+using Log_Value_Minute = DB::Log_Value_Minute;
+using Log_Value_Hour = DB::Log_Value_Hour;
+using Log_Value_Day = DB::Log_Value_Day;
+
+} // namespace Das
+
+#endif // DAS_DB_LOG_VALUE_ROLLUP_H
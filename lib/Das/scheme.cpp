@@ -61,10 +61,26 @@ void Scheme::set_devices(const Devices &devices)
     clear_devices();
     devs_ = devices;
     sort_devices(devs_);
+
+    for (Device* dev: devs_)
+        add_device_to_index(dev);
+}
+
+void Scheme::clear_devices()
+{
+    item_index_.clear();
+    dev_index_.clear();
+    item_delete_later(devs_);
+}
+
+void Scheme::clear_sections()
+{
+    param_index_.clear();
+    group_index_.clear();
+    section_index_.clear();
+    item_delete_later(scts_);
 }
 
-void Scheme::clear_devices() { item_delete_later(devs_); }
-void Scheme::clear_sections() { item_delete_later(scts_); }
 uint Scheme::section_count() { return scts_.size(); }
 
 Section *Scheme::add_section(Section&& section)
@@ -74,8 +90,10 @@ Section *Scheme::add_section(Section&& section)
 
     connect(sct, &Section::control_state_changed, this, &Scheme::control_state_changed);
     connect(sct, &Section::mode_changed, this, &Scheme::mode_changed);
+    connect(sct, &Section::group_initialized, this, &Scheme::add_group_to_index, Qt::DirectConnection);
 
     scts_.push_back( sct );
+    section_index_[sct->id()] = sct;
     return sct;
 }
 
@@ -84,62 +102,70 @@ Device *Scheme::add_device(Device&& device)
     Device* dev = new Device{ std::move(device) };
     dev->set_scheme(this);
     devs_.push_back(dev);
+    add_device_to_index(dev);
     return dev;
 }
 
 void Scheme::set_mode(uint32_t user_id, uint32_t mode_id, uint32_t group_id)
 {
-    Device_item_Group* group;
-    for (Section* sct: scts_)
-        if (group = sct->group_by_id(group_id), group)
-        {
-            group->set_mode(mode_id, user_id);
-            break;
-        }
+    if (Device_item_Group* group = group_by_id(group_id))
+        group->set_mode(mode_id, user_id);
 }
 
 void Scheme::set_dig_param_values(uint32_t user_id, QVector<DB::DIG_Param_Value_Base> params)
 {
-    Param* p;
-
-    for(Section* sct: scts_)
+    params.erase(std::remove_if(params.begin(), params.end(), [&](const DB::DIG_Param_Value_Base& param)
     {
-        for (Device_item_Group* group: sct->groups())
+        if (Param* p = param_by_id(param.group_param_id()))
         {
-            params.erase(std::remove_if(params.begin(), params.end(), [&](const DB::DIG_Param_Value_Base& param)
-            {
-                if (p = group->params()->get_by_id(param.group_param_id()), p)
-                {
-                    p->set_value_from_string(param.value(), user_id);
-                    return true;
-                }
-                return false;
-            }), params.end());
+            p->set_value_from_string(param.value(), user_id);
+            return true;
         }
-    }
+        return false;
+    }), params.end());
 
     if (params.size() != 0)
         qCWarning(SchemeLog) << "Failed to set param values, size:" << params.size();
 }
 
-Device *Scheme::dev_by_id(uint32_t id) const { return by_id(id, devs_); }
-Section* Scheme::section_by_id(uint32_t id) const { return by_id(id, scts_); }
-Device_Item* Scheme::item_by_id(uint32_t id) const
+Device *Scheme::dev_by_id(uint32_t id) const { return by_id(id, dev_index_); }
+Section* Scheme::section_by_id(uint32_t id) const { return by_id(id, section_index_); }
+Device_Item* Scheme::item_by_id(uint32_t id) const { return by_id(id, item_index_); }
+Device_item_Group *Scheme::group_by_id(uint32_t id) const { return by_id(id, group_index_); }
+Param *Scheme::param_by_id(uint32_t id) const { return by_id(id, param_index_); }
+
+void Scheme::add_item_to_index(Device_Item *item)
 {
-    for (Device* dev: devs_)
-        for (Device_Item* item: dev->items())
-            if (item->id() == id)
-                return item;
-    return nullptr;
+    item_index_[item->id()] = item;
+}
+
+void Scheme::add_group_to_index(Device_item_Group *group)
+{
+    group_index_[group->id()] = group;
+    add_param_to_index(group->params());
+}
+
+void Scheme::add_device_to_index(Device *dev)
+{
+    dev_index_[dev->id()] = dev;
+    for (Device_Item* item: dev->items())
+        add_item_to_index(item);
+}
+
+void Scheme::add_param_to_index(Param *param)
+{
+    if (param->id())
+        param_index_[param->id()] = param;
+
+    for (std::size_t i = 0; i < param->count(); ++i)
+        add_param_to_index(param->get(static_cast<uint>(i)));
 }
 
 template<class T>
-T* Scheme::by_id(uint32_t id, const QVector<T*> &items) const
+T* Scheme::by_id(uint32_t id, const std::unordered_map<uint32_t, T*>& index) const
 {
-    for (auto&& item: items)
-        if (item->id() == id)
-            return item;
-    return nullptr;
+    auto it = index.find(id);
+    return it != index.cend() ? it->second : nullptr;
 }
 
 } // namespace Das
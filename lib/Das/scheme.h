@@ -3,6 +3,8 @@
 
 #include <QLoggingCategory>
 
+#include <unordered_map>
+
 #include <Das/db/dig_param_value.h>
 #include <Das/log/log_value_item.h>
 #include <Das/type_managers.h>
@@ -11,6 +13,8 @@
 namespace Das
 {
 
+class Param;
+
 Q_DECLARE_LOGGING_CATEGORY(SchemeLog)
 Q_DECLARE_LOGGING_CATEGORY(SchemeDetailLog)
 
@@ -54,7 +58,10 @@ public:
     Device* dev_by_id(uint32_t id) const;
     Section* section_by_id(uint32_t id) const;
     Device_Item *item_by_id(uint32_t id) const;
-//    Device_item_Group* group_by_id(uint32_t id) const;
+    Device_item_Group* group_by_id(uint32_t id) const;
+    Param* param_by_id(uint32_t id) const;
+
+    void add_item_to_index(Device_Item* item);
 signals:
     void log_item_available(const Log_Value_Item& log_value_item);
     void control_state_changed(Device_Item* item, const QVariant& raw_data, uint32_t user_id = 0);
@@ -63,12 +70,23 @@ public slots:
     void set_mode(uint32_t user_id, uint32_t mode_id, uint32_t group_id);
 
     void set_dig_param_values(uint32_t user_id, QVector<DB::DIG_Param_Value_Base> params);
+private slots:
+    void add_group_to_index(Device_item_Group* group);
 private:
+    void add_device_to_index(Device* dev);
+    void add_param_to_index(Param* param);
+
     template<class T>
-    T* by_id(uint32_t id, const QVector< T* >& items) const;
+    T* by_id(uint32_t id, const std::unordered_map<uint32_t, T*>& index) const;
 
     Devices devs_;
     Sections scts_;
+
+    std::unordered_map<uint32_t, Device*> dev_index_;
+    std::unordered_map<uint32_t, Device_Item*> item_index_;
+    std::unordered_map<uint32_t, Section*> section_index_;
+    std::unordered_map<uint32_t, Device_item_Group*> group_index_;
+    std::unordered_map<uint32_t, Param*> param_index_;
 };
 
 } // namespace Das
@@ -13,6 +13,7 @@
 
 #include <Das/section.h>
 #include <Das/log/log_pack.h>
+#include <Das/log/log_value_rollup.h>
 
 #include <Das/db/node.h>
 #include <Das/db/disabled_param.h>
@@ -75,6 +76,9 @@ inline Delete_Info_List db_delete_info< Device_Item >(const QString& db_name)
 {
     return {
         { Helpz::DB::db_table<Log_Value_Item>(db_name), Log_Value_Item::COL_item_id },
+        { Helpz::DB::db_table<Log_Value_Minute>(db_name), Log_Value_Minute::COL_item_id },
+        { Helpz::DB::db_table<Log_Value_Hour>(db_name), Log_Value_Hour::COL_item_id },
+        { Helpz::DB::db_table<Log_Value_Day>(db_name), Log_Value_Day::COL_item_id },
         { Helpz::DB::db_table<Device_Item_Value>(db_name), Device_Item_Value::COL_item_id },
         { Helpz::DB::db_table<Device_Item>(db_name), Device_Item::COL_parent_id, {}, true },
         { Helpz::DB::db_table<Chart_Item>(db_name), Chart_Item::COL_item_id }
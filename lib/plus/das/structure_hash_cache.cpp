@@ -0,0 +1,152 @@
+#include "structure_hash_cache.h"
+
+namespace Das {
+namespace Ver {
+
+/*static*/ Structure_Hash_Cache &Structure_Hash_Cache::instance()
+{
+    static Structure_Hash_Cache cache;
+    return cache;
+}
+
+Structure_Hash_Cache::Structure_Hash_Cache() :
+    max_age_(0)
+{
+}
+
+void Structure_Hash_Cache::set_max_age(std::chrono::seconds max_age)
+{
+    std::lock_guard lock(mutex_);
+    max_age_ = max_age;
+    if (max_age_.count() <= 0)
+        entry_map_.clear();
+}
+
+bool Structure_Hash_Cache::is_enabled() const
+{
+    std::lock_guard lock(mutex_);
+    return max_age_.count() > 0;
+}
+
+bool Structure_Hash_Cache::get_data(uint8_t struct_type, const Scheme_Info &scheme, QByteArray &data, QByteArray *hash)
+{
+    std::lock_guard lock(mutex_);
+    Entry* entry = get_entry(struct_type, scheme);
+    if (!entry || !entry->is_data_valid_)
+        return false;
+
+    data = entry->data_;
+    if (hash)
+        *hash = entry->hash_;
+    return true;
+}
+
+void Structure_Hash_Cache::set_data(uint8_t struct_type, const Scheme_Info &scheme, const QByteArray &data, const QByteArray &hash)
+{
+    std::lock_guard lock(mutex_);
+    if (max_age_.count() <= 0)
+        return;
+
+    Entry& entry = get_or_create_entry(struct_type, scheme);
+    entry.is_data_valid_ = true;
+    entry.data_ = data;
+    entry.hash_ = hash;
+}
+
+bool Structure_Hash_Cache::get_item_hash_map(uint8_t struct_type, const Scheme_Info &scheme, QMap<uint32_t, uint16_t> &hash_map)
+{
+    std::lock_guard lock(mutex_);
+    Entry* entry = get_entry(struct_type, scheme);
+    if (!entry || !entry->is_item_hash_valid_)
+        return false;
+
+    hash_map = entry->item_hash_map_;
+    return true;
+}
+
+void Structure_Hash_Cache::set_item_hash_map(uint8_t struct_type, const Scheme_Info &scheme, const QMap<uint32_t, uint16_t> &hash_map)
+{
+    std::lock_guard lock(mutex_);
+    if (max_age_.count() <= 0)
+        return;
+
+    Entry& entry = get_or_create_entry(struct_type, scheme);
+    entry.is_item_hash_valid_ = true;
+    entry.item_hash_map_ = hash_map;
+}
+
+void Structure_Hash_Cache::invalidate(uint32_t scheme_id, uint8_t struct_type)
+{
+    std::lock_guard lock(mutex_);
+    for (auto it = entry_map_.begin(); it != entry_map_.end();)
+    {
+        if (it->first.second == struct_type && it->second.scheme_id_set_.find(scheme_id) != it->second.scheme_id_set_.cend())
+            it = entry_map_.erase(it);
+        else
+            ++it;
+    }
+}
+
+void Structure_Hash_Cache::invalidate(uint32_t scheme_id)
+{
+    std::lock_guard lock(mutex_);
+    for (auto it = entry_map_.begin(); it != entry_map_.end();)
+    {
+        if (it->second.scheme_id_set_.find(scheme_id) != it->second.scheme_id_set_.cend())
+            it = entry_map_.erase(it);
+        else
+            ++it;
+    }
+}
+
+Structure_Hash_Cache::Entry *Structure_Hash_Cache::get_entry(uint8_t struct_type, const Scheme_Info &scheme)
+{
+    if (max_age_.count() <= 0)
+        return nullptr;
+
+    auto it = entry_map_.find(Key{scheme.ids_to_sql(), struct_type});
+    if (it == entry_map_.end())
+        return nullptr;
+
+    if (std::chrono::steady_clock::now() - it->second.time_ >= max_age_)
+    {
+        entry_map_.erase(it);
+        return nullptr;
+    }
+    return &it->second;
+}
+
+Structure_Hash_Cache::Entry &Structure_Hash_Cache::get_or_create_entry(uint8_t struct_type, const Scheme_Info &scheme)
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_clean_time_ >= max_age_)
+    {
+        last_clean_time_ = now;
+        remove_expired(now);
+    }
+
+    auto it = entry_map_.find(Key{scheme.ids_to_sql(), struct_type});
+    if (it == entry_map_.end())
+    {
+        Entry entry;
+        entry.scheme_id_set_ = scheme.extending_scheme_ids();
+        entry.scheme_id_set_.insert(scheme.id());
+        entry.time_ = now;
+        it = entry_map_.emplace(Key{scheme.ids_to_sql(), struct_type}, std::move(entry)).first;
+    }
+    return it->second;
+}
+
+void Structure_Hash_Cache::remove_expired(std::chrono::steady_clock::time_point now)
+{
+    for (auto it = entry_map_.begin(); it != entry_map_.end();)
+    {
+        if (now - it->second.time_ >= max_age_)
+            it = entry_map_.erase(it);
+        else
+            ++it;
+    }
+}
+
+} // namespace Ver
+} // namespace Das
@@ -0,0 +1,69 @@
+#ifndef DAS_STRUCTURE_HASH_CACHE_H
+#define DAS_STRUCTURE_HASH_CACHE_H
+
+#include <map>
+#include <set>
+#include <mutex>
+#include <chrono>
+
+#include <QByteArray>
+#include <QMap>
+
+#include "scheme_info.h"
+
+namespace Das {
+namespace Ver {
+
+// Keeps serialized structure tables of schemes, their hashes and item hashes,
+// so structure check after reconnect doesn't read whole structure from database.
+// Entry is removed when table is modified or when it is older than max age.
+// Cache lives only in server memory: hashes isn't saved to database, because tables can be changed
+// not only by server, so the first check after server restart still reads whole table.
+// Changes made by others isn't seen until entry expires, so cache is disabled by default.
+class Structure_Hash_Cache
+{
+public:
+    static Structure_Hash_Cache& instance();
+
+    // Zero max age disables cache
+    void set_max_age(std::chrono::seconds max_age);
+    bool is_enabled() const;
+
+    bool get_data(uint8_t struct_type, const Scheme_Info& scheme, QByteArray& data, QByteArray* hash = nullptr);
+    void set_data(uint8_t struct_type, const Scheme_Info& scheme, const QByteArray& data, const QByteArray& hash);
+
+    bool get_item_hash_map(uint8_t struct_type, const Scheme_Info& scheme, QMap<uint32_t, uint16_t>& hash_map);
+    void set_item_hash_map(uint8_t struct_type, const Scheme_Info& scheme, const QMap<uint32_t, uint16_t>& hash_map);
+
+    // Remove table of every cached scheme set which contains scheme_id
+    void invalidate(uint32_t scheme_id, uint8_t struct_type);
+    void invalidate(uint32_t scheme_id);
+private:
+    Structure_Hash_Cache();
+
+    struct Entry
+    {
+        std::set<uint32_t> scheme_id_set_;
+        std::chrono::steady_clock::time_point time_;
+
+        bool is_data_valid_ = false, is_item_hash_valid_ = false;
+        QByteArray data_, hash_;
+        QMap<uint32_t, uint16_t> item_hash_map_;
+    };
+
+    using Key = std::pair<QString, uint8_t>;
+
+    Entry* get_entry(uint8_t struct_type, const Scheme_Info& scheme);
+    Entry& get_or_create_entry(uint8_t struct_type, const Scheme_Info& scheme);
+    void remove_expired(std::chrono::steady_clock::time_point now);
+
+    std::chrono::seconds max_age_;
+    std::chrono::steady_clock::time_point last_clean_time_;
+    std::map<Key, Entry> entry_map_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace Ver
+} // namespace Das
+
+#endif // DAS_STRUCTURE_HASH_CACHE_H
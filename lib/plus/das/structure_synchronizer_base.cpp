@@ -9,6 +9,7 @@
 #include <Das/commands.h>
 
 #include "database_delete_info.h"
+#include "structure_hash_cache.h"
 #include "structure_synchronizer_base.h"
 
 namespace Das {
@@ -140,26 +141,46 @@ void Structure_Synchronizer_Base::process_modify_message(uint32_t user_id, uint8
 
 QByteArray Structure_Synchronizer_Base::get_structure_hash(uint8_t struct_type, Helpz::DB::Base& db, const Scheme_Info &scheme)
 {
-    QBuffer buffer;
-    buffer.open(QIODevice::ReadWrite);
-    QDataStream ds(&buffer);
-    ds.setVersion(Helpz::Net::Protocol::DATASTREAM_VERSION);
-    add_structure_data(struct_type, ds, db, scheme);
-
-    return QCryptographicHash::hash(buffer.buffer(), QCryptographicHash::Sha1);
+    QByteArray hash;
+    const QByteArray data = get_structure_data(struct_type, db, scheme, &hash);
+    return hash.isEmpty() ? QCryptographicHash::hash(data, QCryptographicHash::Sha1) : hash;
 }
 
 QByteArray Structure_Synchronizer_Base::get_structure_hash_for_all(Helpz::DB::Base& db, const Scheme_Info &scheme)
 {
+    // Same as hash of all tables written to one stream
+    QCryptographicHash hash(QCryptographicHash::Sha1);
     std::vector<uint8_t> struct_type_array = get_main_table_types();
-    QBuffer buffer;
-    buffer.open(QIODevice::ReadWrite);
+    for (const uint8_t struct_type: struct_type_array)
+        hash.addData(get_structure_data(struct_type, db, scheme));
+
+    return hash.result();
+}
+
+QByteArray Structure_Synchronizer_Base::get_structure_data(uint8_t struct_type, Helpz::DB::Base& db, const Scheme_Info &scheme, QByteArray* hash)
+{
+    const bool is_cacheable = is_hash_cacheable(struct_type);
+
+    QByteArray data;
+    if (is_cacheable && Structure_Hash_Cache::instance().get_data(struct_type, scheme, data, hash))
+        return data;
+
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
     QDataStream ds(&buffer);
     ds.setVersion(Helpz::Net::Protocol::DATASTREAM_VERSION);
-    for (const uint8_t struct_type: struct_type_array)
-        add_structure_data(struct_type, ds, db, scheme);
+    add_structure_data(struct_type, ds, db, scheme);
+    buffer.close();
 
-    return QCryptographicHash::hash(buffer.buffer(), QCryptographicHash::Sha1);
+    if (is_cacheable)
+    {
+        const QByteArray data_hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+        Structure_Hash_Cache::instance().set_data(struct_type, scheme, data, data_hash);
+        if (hash)
+            *hash = data_hash;
+    }
+
+    return data;
 }
 
 Helpz::DB::Thread *Structure_Synchronizer_Base::db_thread() const
@@ -199,45 +220,73 @@ void Structure_Synchronizer_Base::add_structure_items_data(uint8_t struct_type,
     }
 }
 
+/*static*/ bool Structure_Synchronizer_Base::is_hash_cacheable(uint8_t struct_type)
+{
+    switch (struct_type)
+    {
+    // Tables without scheme_id can be changed not by scheme
+    case ST_AUTH_GROUP:
+    case ST_AUTH_GROUP_PERMISSION:
+    case ST_USER:
+    case ST_USER_GROUP:
+        return false;
+    default:
+        break;
+    }
+
+    std::vector<uint8_t> struct_type_array = get_main_table_types();
+    return std::find(struct_type_array.cbegin(), struct_type_array.cend(), struct_type) != struct_type_array.cend()
+            && Structure_Hash_Cache::instance().is_enabled();
+}
+
 QMap<uint32_t, uint16_t> Structure_Synchronizer_Base::get_structure_hash_map_by_type(uint8_t struct_type, Helpz::DB::Base& db, const Scheme_Info &scheme)
 {
+    const bool is_cacheable = is_hash_cacheable(struct_type);
+
+    QMap<uint32_t, uint16_t> hash_map;
+    if (is_cacheable && Structure_Hash_Cache::instance().get_item_hash_map(struct_type, scheme, hash_map))
+        return hash_map;
+
     switch (struct_type)
     {
-    case ST_DEVICE:                return get_structure_hash_map<Device>                  (struct_type, db, scheme); break;
-    case ST_PLUGIN_TYPE:           return get_structure_hash_map<Plugin_Type>             (struct_type, db, scheme); break;
-    case ST_DEVICE_ITEM:           return get_structure_hash_map<Device_Item>             (struct_type, db, scheme); break;
-    case ST_DEVICE_ITEM_TYPE:      return get_structure_hash_map<Device_Item_Type>        (struct_type, db, scheme); break;
-    case ST_SECTION:               return get_structure_hash_map<Section>                 (struct_type, db, scheme); break;
-    case ST_DEVICE_ITEM_GROUP:     return get_structure_hash_map<Device_item_Group>       (struct_type, db, scheme); break;
-    case ST_DIG_TYPE:              return get_structure_hash_map<DIG_Type>                (struct_type, db, scheme); break;
-    case ST_DIG_MODE_TYPE:         return get_structure_hash_map<DIG_Mode_Type>           (struct_type, db, scheme); break;
-    case ST_DIG_PARAM:             return get_structure_hash_map<DIG_Param>               (struct_type, db, scheme); break;
-    case ST_DIG_PARAM_TYPE:        return get_structure_hash_map<DIG_Param_Type>          (struct_type, db, scheme); break;
-    case ST_DIG_STATUS_TYPE:       return get_structure_hash_map<DIG_Status_Type>         (struct_type, db, scheme); break;
-    case ST_DIG_STATUS_CATEGORY:   return get_structure_hash_map<DIG_Status_Category>     (struct_type, db, scheme); break;
-    case ST_SIGN_TYPE:             return get_structure_hash_map<Sign_Type>               (struct_type, db, scheme); break;
-    case ST_CODES:                 return get_structure_hash_map<Code_Item>               (struct_type, db, scheme); break;
-    case ST_SAVE_TIMER:            return get_structure_hash_map<Save_Timer>              (struct_type, db, scheme); break;
-    case ST_TRANSLATION:           return get_structure_hash_map<Translation>             (struct_type, db, scheme); break;
-    case ST_NODE:                  return get_structure_hash_map<DB::Node>                (struct_type, db, scheme); break;
-    case ST_DISABLED_PARAM:        return get_structure_hash_map<DB::Disabled_Param>      (struct_type, db, scheme); break;
-    case ST_DISABLED_STATUS:       return get_structure_hash_map<DB::Disabled_Status>     (struct_type, db, scheme); break;
-    case ST_CHART:                 return get_structure_hash_map<DB::Chart>               (struct_type, db, scheme); break;
-    case ST_CHART_ITEM:            return get_structure_hash_map<DB::Chart_Item>          (struct_type, db, scheme); break;
-    case ST_AUTH_GROUP:            return get_structure_hash_map<Auth_Group>              (struct_type, db, scheme); break;
-    case ST_AUTH_GROUP_PERMISSION: return get_structure_hash_map<Auth_Group_Permission>   (struct_type, db, scheme); break;
-    case ST_USER:                  return get_structure_hash_map<User>                    (struct_type, db, scheme); break;
-    case ST_USER_GROUP:            return get_structure_hash_map<User_Groups>             (struct_type, db, scheme); break;
-
-    case ST_DEVICE_ITEM_VALUE:     return get_structure_hash_map<Device_Item_Value>       (struct_type, db, scheme); break;
-    case ST_DIG_MODE:              return get_structure_hash_map<DIG_Mode>                (struct_type, db, scheme); break;
-    case ST_DIG_PARAM_VALUE:       return get_structure_hash_map<DIG_Param_Value>         (struct_type, db, scheme); break;
+    case ST_DEVICE:                hash_map = get_structure_hash_map<Device>                  (struct_type, db, scheme); break;
+    case ST_PLUGIN_TYPE:           hash_map = get_structure_hash_map<Plugin_Type>             (struct_type, db, scheme); break;
+    case ST_DEVICE_ITEM:           hash_map = get_structure_hash_map<Device_Item>             (struct_type, db, scheme); break;
+    case ST_DEVICE_ITEM_TYPE:      hash_map = get_structure_hash_map<Device_Item_Type>        (struct_type, db, scheme); break;
+    case ST_SECTION:               hash_map = get_structure_hash_map<Section>                 (struct_type, db, scheme); break;
+    case ST_DEVICE_ITEM_GROUP:     hash_map = get_structure_hash_map<Device_item_Group>       (struct_type, db, scheme); break;
+    case ST_DIG_TYPE:              hash_map = get_structure_hash_map<DIG_Type>                (struct_type, db, scheme); break;
+    case ST_DIG_MODE_TYPE:         hash_map = get_structure_hash_map<DIG_Mode_Type>           (struct_type, db, scheme); break;
+    case ST_DIG_PARAM:             hash_map = get_structure_hash_map<DIG_Param>               (struct_type, db, scheme); break;
+    case ST_DIG_PARAM_TYPE:        hash_map = get_structure_hash_map<DIG_Param_Type>          (struct_type, db, scheme); break;
+    case ST_DIG_STATUS_TYPE:       hash_map = get_structure_hash_map<DIG_Status_Type>         (struct_type, db, scheme); break;
+    case ST_DIG_STATUS_CATEGORY:   hash_map = get_structure_hash_map<DIG_Status_Category>     (struct_type, db, scheme); break;
+    case ST_SIGN_TYPE:             hash_map = get_structure_hash_map<Sign_Type>               (struct_type, db, scheme); break;
+    case ST_CODES:                 hash_map = get_structure_hash_map<Code_Item>               (struct_type, db, scheme); break;
+    case ST_SAVE_TIMER:            hash_map = get_structure_hash_map<Save_Timer>              (struct_type, db, scheme); break;
+    case ST_TRANSLATION:           hash_map = get_structure_hash_map<Translation>             (struct_type, db, scheme); break;
+    case ST_NODE:                  hash_map = get_structure_hash_map<DB::Node>                (struct_type, db, scheme); break;
+    case ST_DISABLED_PARAM:        hash_map = get_structure_hash_map<DB::Disabled_Param>      (struct_type, db, scheme); break;
+    case ST_DISABLED_STATUS:       hash_map = get_structure_hash_map<DB::Disabled_Status>     (struct_type, db, scheme); break;
+    case ST_CHART:                 hash_map = get_structure_hash_map<DB::Chart>               (struct_type, db, scheme); break;
+    case ST_CHART_ITEM:            hash_map = get_structure_hash_map<DB::Chart_Item>          (struct_type, db, scheme); break;
+    case ST_AUTH_GROUP:            hash_map = get_structure_hash_map<Auth_Group>              (struct_type, db, scheme); break;
+    case ST_AUTH_GROUP_PERMISSION: hash_map = get_structure_hash_map<Auth_Group_Permission>   (struct_type, db, scheme); break;
+    case ST_USER:                  hash_map = get_structure_hash_map<User>                    (struct_type, db, scheme); break;
+    case ST_USER_GROUP:            hash_map = get_structure_hash_map<User_Groups>             (struct_type, db, scheme); break;
+
+    case ST_DEVICE_ITEM_VALUE:     hash_map = get_structure_hash_map<Device_Item_Value>       (struct_type, db, scheme); break;
+    case ST_DIG_MODE:              hash_map = get_structure_hash_map<DIG_Mode>                (struct_type, db, scheme); break;
+    case ST_DIG_PARAM_VALUE:       hash_map = get_structure_hash_map<DIG_Param_Value>         (struct_type, db, scheme); break;
 
     default:
         qCWarning(Struct_Log) << "get_structure_hash_map_by_type unprocessed" << struct_type;
-        break;
+        return {};
     }
-    return {};
+
+    if (is_cacheable)
+        Structure_Hash_Cache::instance().set_item_hash_map(struct_type, scheme, hash_map);
+    return hash_map;
 }
 
 template<typename T>
@@ -385,6 +434,8 @@ void Structure_Synchronizer_Base::modify(QVector<T>&& upd_vect, QVector<T>&& ins
             bool ok = self->modify_table(struct_type, *db, upd_vect, insrt_vect, del_vect, scheme);
             if (ok)
             {
+                Structure_Hash_Cache::instance().invalidate(scheme.id(), struct_type);
+
                 if (!self->modified_ && self->is_main_table(struct_type))
                 {
                     self->modified_ = true;
@@ -79,7 +79,11 @@ protected:
     void add_structure_items_data(uint8_t struct_type, const QVector<uint32_t>& id_vect, QDataStream& ds, Helpz::DB::Base& db, const Scheme_Info &scheme);
 
     QMap<uint32_t, uint16_t> get_structure_hash_map_by_type(uint8_t struct_type, Helpz::DB::Base& db, const Scheme_Info& scheme);
+
+    static bool is_hash_cacheable(uint8_t struct_type);
 private:
+    QByteArray get_structure_data(uint8_t struct_type, Helpz::DB::Base& db, const Scheme_Info& scheme, QByteArray* hash = nullptr);
+
     template<typename T>
     QString get_db_list_suffix(uint8_t struct_type, const QVector<uint32_t>& id_vect, const Scheme_Info& scheme);
 
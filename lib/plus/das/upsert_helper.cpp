@@ -0,0 +1,127 @@
+#include <set>
+
+#include <QSqlQuery>
+#include <QDebug>
+
+#include <Das/db/upsert_sql.h>
+
+#include "upsert_helper.h"
+
+namespace Das {
+
+using namespace Helpz::DB;
+
+/*static*/ std::mutex Upsert_Helper::mutex_;
+/*static*/ std::map<QString, bool> Upsert_Helper::has_key_map_;
+
+/*static*/ bool Upsert_Helper::save(Base& db, const Table& table, const QStringList& key_field_names,
+                                    const QStringList& update_field_names, const QVariantList& values, int row_count)
+{
+    if (row_count <= 0)
+        return true;
+
+    if (has_unique_key(db, table.name(), key_field_names))
+        return db.exec(DB::get_upsert_sql(table, row_count, update_field_names), values).isActive();
+    return save_by_rows(db, table, key_field_names, update_field_names, values, row_count);
+}
+
+/*static*/ bool Upsert_Helper::has_unique_key(Base& db, const QString& table_name, const QStringList& key_field_names)
+{
+    {
+        std::lock_guard lock(mutex_);
+        auto it = has_key_map_.find(table_name);
+        if (it != has_key_map_.cend())
+            return it->second;
+    }
+
+    QSqlQuery q = db.exec("SHOW INDEX FROM " + table_name + " WHERE Non_unique = 0");
+    if (!q.isActive())
+        return false; // Check again next time
+
+    // Column 2 is Key_name and column 4 is Column_name
+    std::map<QString, std::set<QString>> key_columns;
+    while (q.next())
+        key_columns[q.value(2).toString()].insert(q.value(4).toString());
+
+    const std::set<QString> need_columns(key_field_names.cbegin(), key_field_names.cend());
+    bool has_key = false;
+    for (const auto& it: key_columns)
+    {
+        if (it.second == need_columns)
+        {
+            has_key = true;
+            break;
+        }
+    }
+
+    if (!has_key)
+        qWarning() << "Table" << table_name << "hasn't unique key on" << key_field_names
+                   << "current values is saved row by row";
+
+    std::lock_guard lock(mutex_);
+    has_key_map_[table_name] = has_key;
+    return has_key;
+}
+
+/*static*/ bool Upsert_Helper::save_by_rows(Base& db, const Table& table, const QStringList& key_field_names,
+                                            const QStringList& update_field_names, const QVariantList& values, int row_count)
+{
+    const QStringList& field_names = table.field_names();
+    const int field_count = field_names.size();
+
+    QString where;
+    for (const QString& name: key_field_names)
+    {
+        if (!where.isEmpty())
+            where += " AND ";
+        where += name + " = ?";
+    }
+
+    QString update_sql = "UPDATE " + table.name() + " SET ";
+    for (const QString& name: update_field_names)
+    {
+        if (&name != &update_field_names.front())
+            update_sql += ", ";
+        update_sql += name + " = ?";
+    }
+    update_sql += " WHERE " + where;
+
+    const QString select_sql = "SELECT 1 FROM " + table.name() + " WHERE " + where + " LIMIT 1";
+    const QString insert_sql = "INSERT INTO " + table.name() + '(' + field_names.join(',') + ") VALUES" +
+            Base::get_q_array(field_count, 1);
+
+    bool is_ok = true;
+    QVariantList row, key_values, update_values;
+    for (int i = 0; i < row_count; ++i)
+    {
+        row = values.mid(i * field_count, field_count);
+
+        key_values.clear();
+        for (const QString& name: key_field_names)
+            key_values.push_back(row.at(field_names.indexOf(name)));
+
+        update_values.clear();
+        for (const QString& name: update_field_names)
+            update_values.push_back(row.at(field_names.indexOf(name)));
+
+        QSqlQuery q = db.exec(update_sql, update_values + key_values);
+        if (!q.isActive())
+        {
+            is_ok = false;
+            continue;
+        }
+
+        // Update of row with same values doesn't affect it, so check that row exists
+        if (q.numRowsAffected() > 0)
+            continue;
+
+        q = db.exec(select_sql, key_values);
+        if (!q.isActive())
+            is_ok = false;
+        else if (!q.next() && !db.exec(insert_sql, row).isActive())
+            is_ok = false;
+    }
+    return is_ok;
+}
+
+} // namespace Das
@@ -0,0 +1,33 @@
+#ifndef DAS_UPSERT_HELPER_H
+#define DAS_UPSERT_HELPER_H
+
+#include <map>
+#include <mutex>
+
+#include <Helpz/db_base.h>
+
+namespace Das {
+
+// Saves current values, like device_item_value, dig_param_value and dig_mode.
+// Rows is written by one "INSERT ... ON DUPLICATE KEY UPDATE" only if table has unique key on key fields.
+// Database schema isn't created by this project, so without the key every row is updated
+// and inserted when it doesn't exist yet, as before. Key is checked once per table after start.
+class Upsert_Helper
+{
+public:
+    // Table must be without id field, values is rows in order of table fields.
+    static bool save(Helpz::DB::Base& db, const Helpz::DB::Table& table, const QStringList& key_field_names,
+                     const QStringList& update_field_names, const QVariantList& values, int row_count);
+
+    static bool has_unique_key(Helpz::DB::Base& db, const QString& table_name, const QStringList& key_field_names);
+private:
+    static bool save_by_rows(Helpz::DB::Base& db, const Helpz::DB::Table& table, const QStringList& key_field_names,
+                             const QStringList& update_field_names, const QVariantList& values, int row_count);
+
+    static std::mutex mutex_;
+    static std::map<QString, bool> has_key_map_;
+};
+
+} // namespace Das
+
+#endif // DAS_UPSERT_HELPER_H
@@ -16,8 +16,10 @@ SOURCES += \
     das/authentication_info.cpp \
     das/scheme_info.cpp \
     das/structure_synchronizer_base.cpp \
+    das/structure_hash_cache.cpp \
     das/jwt_helper.cpp \
-    das/status_helper.cpp
+    das/status_helper.cpp \
+    das/upsert_helper.cpp
 
 HEADERS +=\
     ../Das/daslib_global.h \
@@ -26,9 +28,11 @@ HEADERS +=\
     das/authentication_info.h \
     das/scheme_info.h \
     das/structure_synchronizer_base.h \
+    das/structure_hash_cache.h \
     das/database_delete_info.h \
     das/jwt_helper.h \
-    das/status_helper.h
+    das/status_helper.h \
+    das/upsert_helper.h
 
 DESTDIR = $${OUT_PWD}/../..
 
@@ -0,0 +1,169 @@
+#include <QDebug>
+
+#include <Helpz/db_table.h>
+
+#include <Das/commands.h>
+#include <Das/blob_store.h>
+#include <Das/db/blob_scheme.h>
+#include <Das/log/log_base_item.h>
+#include <plus/das/upsert_helper.h>
+
+#include "server.h"
+#include "database/db_thread_manager.h"
+#include "server_protocol.h"
+#include "blob_synchronizer.h"
+
+namespace Das {
+namespace Ver {
+namespace Server {
+
+Blob_Synchronizer::Blob_Synchronizer(Protocol_Base *protocol) :
+    Base_Synchronizer(protocol),
+    enabled_(false),
+    in_progress_(false)
+{
+}
+
+void Blob_Synchronizer::set_enabled(bool state)
+{
+    enabled_ = state;
+}
+
+void Blob_Synchronizer::check_values(const QVector<Log_Value_Item>& pack)
+{
+    Blob_Store& store = Blob_Store::instance();
+    if (!enabled_ || !store.is_enabled())
+        return;
+
+    for (const Log_Value_Item& item: pack)
+    {
+        for (const QVariant* value: {&item.raw_value(), &item.value()})
+        {
+            const QByteArray hash = Blob_Store::hash_from_ref(*value);
+            if (!Blob_Store::is_valid_hash(hash))
+                continue;
+
+            if (store.contains(hash))
+                send_stored(hash);
+            else
+                add(hash);
+        }
+    }
+}
+
+void Blob_Synchronizer::resume()
+{
+    if (!enabled_)
+        return;
+
+    const QVector<QByteArray> hashes = Blob_Store::instance().partial_hashes(scheme_id());
+    for (const QByteArray& hash: hashes)
+        add(hash);
+}
+
+void Blob_Synchronizer::add(const QByteArray& hash)
+{
+    if (!queued_set_.insert(hash).second)
+        return;
+
+    queue_.push_back(hash);
+    if (!in_progress_)
+        request_next();
+}
+
+void Blob_Synchronizer::request_next()
+{
+    if (queue_.empty())
+    {
+        in_progress_ = false;
+        return;
+    }
+
+    in_progress_ = true;
+    const QByteArray& hash = queue_.front();
+    const qint64 offset = Blob_Store::instance().partial_size(hash, scheme_id());
+
+    protocol_->send(Cmd::BLOB_REQUEST).answer([this](QIODevice& data_dev)
+    {
+        apply_parse(data_dev, &Blob_Synchronizer::process_chunk);
+    })
+    .timeout([this]()
+    {
+        // Partial blob is left on disk and will be resumed after reconnect
+        qWarning().noquote() << title() << "Blob request timeout";
+        in_progress_ = false;
+    }, std::chrono::seconds(15), std::chrono::seconds(5)) << hash << offset;
+}
+
+void Blob_Synchronizer::process_chunk(const QByteArray& hash, qint64 offset, qint64 total_size, const QByteArray& data)
+{
+    if (queue_.empty() || queue_.front() != hash)
+        return;
+
+    Blob_Store& store = Blob_Store::instance();
+    const uint32_t s_id = scheme_id();
+
+    if (total_size < 0 || total_size > max_blob_size)
+    {
+        qWarning().noquote() << title() << "Blob" << hash.toHex() << "is skipped, size:" << total_size;
+        store.remove_partial(hash, s_id);
+        pop_front();
+    }
+    else if ((data.isEmpty() && offset < total_size) || !store.append_partial(hash, s_id, offset, data))
+    {
+        qWarning().noquote() << title() << "Blob" << hash.toHex() << "bad chunk at" << offset;
+        store.remove_partial(hash, s_id);
+        pop_front();
+    }
+    else if (offset + data.size() >= total_size)
+    {
+        if (store.finish_partial(hash, s_id))
+            send_stored(hash);
+        else
+            qWarning().noquote() << title() << "Blob" << hash.toHex() << "hash mismatch";
+        pop_front();
+    }
+
+    request_next();
+}
+
+void Blob_Synchronizer::pop_front()
+{
+    queued_set_.erase(queue_.front());
+    queue_.pop_front();
+}
+
+void Blob_Synchronizer::send_stored(const QByteArray& hash)
+{
+    save_blob_scheme(hash);
+
+    // Scheme can remove its copy of blob after this
+    protocol_->send(Cmd::BLOB_STORED) << hash;
+}
+
+void Blob_Synchronizer::save_blob_scheme(const QByteArray& hash)
+{
+    // Access to blob from web is checked by this table, and blob isn't removed while scheme references it
+    const uint32_t s_id = scheme_id();
+    const QString hash_hex = QString::fromLatin1(hash.toHex());
+    const qint64 now = DB::Log_Base_Item::current_timestamp();
+
+    protocol_->work_object()->db_thread_mng_->log_pool()->add(s_id, [s_id, hash_hex, now](Helpz::DB::Base* db)
+    {
+        using T = DB::Blob_Scheme;
+        Helpz::DB::Table table = Helpz::DB::db_table<T>();
+        const QStringList key_field_names{
+            table.field_names().at(T::COL_hash),
+            table.field_names().at(T::COL_scheme_id)
+        };
+        const QStringList update_field_names{ table.field_names().at(T::COL_timestamp_msecs) };
+        table.field_names().removeFirst(); // remove id
+
+        if (!Upsert_Helper::save(*db, table, key_field_names, update_field_names, { hash_hex, now, s_id }, 1))
+            qWarning() << "Failed to save blob" << hash_hex << "for scheme" << s_id;
+    });
+}
+
+} // namespace Server
+} // namespace Ver
+} // namespace Das
@@ -0,0 +1,50 @@
+#ifndef DAS_BLOB_SYNCHRONIZER_H
+#define DAS_BLOB_SYNCHRONIZER_H
+
+#include <deque>
+#include <set>
+
+#include <QIODevice>
+
+#include <Das/log/log_pack.h>
+
+#include "base_synchronizer.h"
+
+namespace Das {
+namespace Ver {
+namespace Server {
+
+using namespace Das::Server;
+
+// Receives big values referenced by log items from scheme by chunks.
+// Received part is kept on disk, so transfer continues after reconnect.
+class Blob_Synchronizer : public Base_Synchronizer
+{
+public:
+    static constexpr qint64 max_blob_size = 32 * 1024 * 1024;
+
+    Blob_Synchronizer(Protocol_Base* protocol);
+
+    // Blob references is supported by scheme since das/2.8
+    void set_enabled(bool state);
+
+    void check_values(const QVector<Log_Value_Item>& pack);
+    void resume();
+private:
+    void add(const QByteArray& hash);
+    void request_next();
+    void process_chunk(const QByteArray& hash, qint64 offset, qint64 total_size, const QByteArray& data);
+    void pop_front();
+    void send_stored(const QByteArray& hash);
+    void save_blob_scheme(const QByteArray& hash);
+
+    bool enabled_, in_progress_;
+    std::deque<QByteArray> queue_;
+    std::set<QByteArray> queued_set_;
+};
+
+} // namespace Server
+} // namespace Ver
+} // namespace Das
+
+#endif // DAS_BLOB_SYNCHRONIZER_H
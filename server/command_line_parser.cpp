@@ -8,6 +8,7 @@
 
 #include <Das/lib.h>
 
+#include "database/db_thread_manager.h"
 #include "worker.h"
 #include "server.h"
 #include "server_protocol.h"
@@ -33,6 +34,7 @@ void Command_Line_Parser::process_commands(const QStringList& args)
 {
     const QCommandLineOption o_list_version{ { "v", "list_version" }, QCoreApplication::translate("main", "List versions of connected schemes.")};
     const QCommandLineOption o_list{ { "l", "list" }, QCoreApplication::translate("main", "List of connected schemes.")};
+    const QCommandLineOption o_log_queue{ "log_queue", QCoreApplication::translate("main", "Show log threads queue size.")};
     const QCommandLineOption o_id{ {"pi", "scheme_id"}, QCoreApplication::translate("main", "Scheme id."), "prj_id"};
     const QCommandLineOption o_user_id{ {"ui", "user_id"}, QCoreApplication::translate("main", "User id."), "user_id"};
     const QCommandLineOption o_devitem_id{ {"dii", "devitem_id"}, QCoreApplication::translate("main", "Device Item id."), "di_id"};
@@ -40,7 +42,7 @@ void Command_Line_Parser::process_commands(const QStringList& args)
     const QCommandLineOption o_send_file_name{ "send_file_name", QCoreApplication::translate("main", "Send file name to schemes."), "file_name"};
 
     QList<QCommandLineOption> opt{
-        o_list_version, o_list, o_id, o_user_id, o_devitem_id, o_send_file, o_send_file_name,
+        o_list_version, o_list, o_log_queue, o_id, o_user_id, o_devitem_id, o_send_file, o_send_file_name,
 /*
         { { "d", "dev", "device" }, QCoreApplication::translate("main", "Device"), "ethX" },
 
@@ -69,6 +71,10 @@ void Command_Line_Parser::process_commands(const QStringList& args)
     {
         print_connected_schemes(parser.isSet(o_list_version));
     }
+    else if (parser.isSet(o_log_queue))
+    {
+        print_log_queue();
+    }
     else if (parser.isSet(o_id))
     {
         uint32_t scheme_id = parser.value(o_id).toInt();
@@ -81,10 +87,7 @@ void Command_Line_Parser::process_commands(const QStringList& args)
             {
                 if (work_object_->server_thread_ && work_object_->server_thread_->server())
                 {
-                    auto node = work_object_->server_thread_->server()->find_client([scheme_id](const Helpz::Net::Protocol* protocol) -> bool
-                    {
-                        return static_cast<const Protocol_Base*>(protocol)->id() == scheme_id;
-                    });
+                    auto node = work_object_->find_client(scheme_id);
 
                     if (node)
                     {
@@ -163,5 +166,23 @@ void Command_Line_Parser::print_connected_schemes(bool with_version) const
     });
 }
 
+void Command_Line_Parser::print_log_queue() const
+{
+    if (!work_object_->db_thread_mng_)
+    {
+        std::cerr << "Database not initialized" << std::endl;
+        return;
+    }
+
+    const std::vector<DB::Log_Thread_Pool::Stats> stats = work_object_->db_thread_mng_->log_pool()->stats();
+    std::cout << "Log threads: " << stats.size() << std::endl;
+    for (std::size_t i = 0; i < stats.size(); ++i)
+    {
+        const DB::Log_Thread_Pool::Stats& item = stats.at(i);
+        std::cout << i << " | queue " << item.queue_size_ << " max " << item.max_queue_size_
+                  << " done " << item.done_count_ << std::endl;
+    }
+}
+
 } // namespace Server
 } // namespace Das
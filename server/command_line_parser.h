@@ -16,6 +16,7 @@ public:
     void process_commands(const QStringList &args);
 private:
     void print_connected_schemes(bool with_version) const;
+    void print_log_queue() const;
 
     Worker* work_object_;
 };
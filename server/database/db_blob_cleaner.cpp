@@ -0,0 +1,72 @@
+#include <QDateTime>
+#include <QLoggingCategory>
+
+#include <Helpz/db_table.h>
+
+#include <Das/blob_store.h>
+#include <Das/db/blob_scheme.h>
+#include <Das/db/device_item_value.h>
+
+#include "db_blob_cleaner.h"
+
+namespace Das {
+namespace DB {
+
+Q_LOGGING_CATEGORY(Blob_Log, "blob")
+
+using namespace Helpz::DB;
+
+Blob_Cleaner::Blob_Cleaner(Thread* db_thread, int keep_days, int delete_limit) :
+    in_progress_(false),
+    last_clean_time_(0),
+    keep_days_(keep_days),
+    delete_limit_(delete_limit),
+    db_thread_(db_thread)
+{
+}
+
+void Blob_Cleaner::clean()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (in_progress_ || now - last_clean_time_ < 60 * 60 * 1000)
+        return;
+    in_progress_ = true;
+    last_clean_time_ = now;
+
+    db_thread_->add([this, now](Base* db)
+    {
+        clean_impl(*db, now);
+        in_progress_ = false;
+    });
+}
+
+void Blob_Cleaner::clean_impl(Base& db, qint64 now)
+{
+    const qint64 keep_time = now - keep_days_ * 24LL * 60 * 60 * 1000;
+    const QString blob_table_name = db_table_name<Blob_Scheme>();
+    const QString ref_sql = "CONCAT('blob:', " + blob_table_name + ".hash)";
+
+    const QString sql = "DELETE FROM " + blob_table_name + " WHERE timestamp_msecs < " + QString::number(keep_time) +
+            " AND NOT EXISTS (SELECT 1 FROM " + db_table_name<Device_Item_Value>() + " v"
+            " WHERE v.scheme_id = " + blob_table_name + ".scheme_id AND (v.value = " + ref_sql + " OR v.raw_value = " + ref_sql + "))"
+            " LIMIT " + QString::number(delete_limit_);
+    if (!db.exec(sql).isActive())
+    {
+        qCWarning(Blob_Log) << "Failed delete old rows from" << blob_table_name;
+        return;
+    }
+
+    const QString used_sql = "SELECT 1 FROM " + blob_table_name + " WHERE hash = ? LIMIT 1";
+    const int count = Blob_Store::instance().remove_unused(keep_days_, [&db, &used_sql](const QByteArray& hash)
+    {
+        QSqlQuery q = db.exec(used_sql, { QString::fromLatin1(hash.toHex()) });
+        // Blob is kept if database isn't available
+        return !q.isActive() || q.next();
+    });
+
+    if (count)
+        qCInfo(Blob_Log) << "Removed" << count << "unused blobs";
+}
+
+} // namespace DB
+} // namespace Das
@@ -0,0 +1,33 @@
+#ifndef DAS_DATABASE_BLOB_CLEANER_H
+#define DAS_DATABASE_BLOB_CLEANER_H
+
+#include <atomic>
+
+#include <Helpz/db_base.h>
+#include <Helpz/db_thread.h>
+
+namespace Das {
+namespace DB {
+
+// Removes blobs that isn't referenced by any scheme more than keep_days.
+// Blob referenced by current device item value is kept regardless of age.
+class Blob_Cleaner
+{
+public:
+    Blob_Cleaner(Helpz::DB::Thread* db_thread, int keep_days, int delete_limit = 10000);
+
+    // Called from main thread by timer
+    void clean();
+private:
+    void clean_impl(Helpz::DB::Base& db, qint64 now);
+
+    std::atomic<bool> in_progress_;
+    qint64 last_clean_time_;
+    int keep_days_, delete_limit_;
+    Helpz::DB::Thread* db_thread_;
+};
+
+} // namespace DB
+} // namespace Das
+
+#endif // DAS_DATABASE_BLOB_CLEANER_H
@@ -0,0 +1,162 @@
+#include <algorithm>
+
+#include <QSqlError>
+#include <QLoggingCategory>
+
+#include "db_log_batch_writer.h"
+
+namespace Das {
+namespace DB {
+
+Q_LOGGING_CATEGORY(Batch_Log, "log.batch")
+
+using namespace Helpz::DB;
+
+namespace {
+
+QString get_insert_sql(const Table& table, int row_count)
+{
+    return "INSERT INTO " +
+            table.name() + '(' + table.field_names().join(',') + ") VALUES" +
+            Base::get_q_array(table.field_names().size(), row_count);
+}
+
+} // namespace
+
+bool Log_Batch_Writer::add(const Table& table, int row_count, QVariantList&& values, Done_Func done_func)
+{
+    std::lock_guard lock(mutex_);
+    const bool is_first = pending_.empty();
+
+    auto it = pending_.find(table.name());
+    if (it == pending_.end())
+        it = pending_.emplace(table.name(), Table_Packs{table, {}}).first;
+
+    it->second.packs_.push_back(Pack{row_count, std::move(values), std::move(done_func)});
+    return is_first;
+}
+
+void Log_Batch_Writer::flush(Base& db)
+{
+    std::map<QString, Table_Packs> pending;
+    {
+        std::lock_guard lock(mutex_);
+        pending.swap(pending_);
+    }
+
+    for (auto& it: pending)
+        flush_table(db, it.second);
+}
+
+void Log_Batch_Writer::flush_table(Base& db, Table_Packs& table_packs)
+{
+    QVariantList values;
+    int row_count = 0;
+    for (const Pack& pack: table_packs.packs_)
+    {
+        values += pack.values_;
+        row_count += pack.row_count_;
+    }
+
+    int written_rows = 0;
+    if (write(db, table_packs.table_, values, row_count, written_rows))
+    {
+        for (const Pack& pack: table_packs.packs_)
+            pack.done_func_(db, true);
+        return;
+    }
+
+    qCWarning(Batch_Log) << "Batch insert failed" << table_packs.table_.name() << "packs" << table_packs.packs_.size()
+                         << "rows" << row_count << "written" << written_rows;
+
+    // Connection may be reopened, so prepared queries is not valid anymore
+    query_cache_.clear();
+
+    // Write every pack separately, so one bad pack doesn't reject others.
+    // Rows already written without transaction is skipped, so they aren't duplicated.
+    const int field_count = table_packs.table_.field_names().size();
+    int pack_offset = 0;
+    for (const Pack& pack: table_packs.packs_)
+    {
+        const int skip_rows = std::min(std::max(written_rows - pack_offset, 0), pack.row_count_);
+        pack_offset += pack.row_count_;
+
+        bool is_ok = true;
+        if (skip_rows < pack.row_count_)
+        {
+            const QVariantList pack_values = skip_rows ? pack.values_.mid(skip_rows * field_count) : pack.values_;
+            is_ok = db.exec(get_insert_sql(table_packs.table_, pack.row_count_ - skip_rows), pack_values).isActive();
+        }
+        pack.done_func_(db, is_ok);
+    }
+}
+
+bool Log_Batch_Writer::write(Base& db, const Table& table, const QVariantList& values, int row_count, int& written_rows)
+{
+    QSqlDatabase sql_db = db.database();
+    const bool is_transaction = sql_db.transaction();
+
+    int size, row_offset = 0;
+    while (row_offset < row_count)
+    {
+        size = row_count - row_offset;
+        if (size >= max_rows_per_query)
+            size = max_rows_per_query;
+        else
+        {
+            // Take highest power of two
+            while (size & (size - 1))
+                size &= size - 1;
+        }
+
+        if (!exec_rows(db, table, values, row_offset, size))
+        {
+            if (is_transaction)
+                sql_db.rollback();
+            else
+                written_rows = row_offset;
+            return false;
+        }
+
+        row_offset += size;
+    }
+
+    if (is_transaction && !sql_db.commit())
+        return false;
+
+    written_rows = row_count;
+    return true;
+}
+
+bool Log_Batch_Writer::exec_rows(Base& db, const Table& table, const QVariantList& values, int row_offset, int row_count)
+{
+    QSqlQuery& query = prepared_query(db, table, row_count);
+
+    const int field_count = table.field_names().size();
+    const int value_offset = row_offset * field_count;
+    const int value_count = row_count * field_count;
+    for (int i = 0; i < value_count; ++i)
+        query.bindValue(i, values.at(value_offset + i));
+
+    if (!query.exec())
+    {
+        qCWarning(Batch_Log) << "Insert error:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+QSqlQuery& Log_Batch_Writer::prepared_query(Base& db, const Table& table, int row_count)
+{
+    auto it = query_cache_.find({table.name(), row_count});
+    if (it == query_cache_.end())
+    {
+        QSqlQuery query(db.database());
+        query.prepare(get_insert_sql(table, row_count));
+        it = query_cache_.emplace(std::make_pair(table.name(), row_count), std::move(query)).first;
+    }
+    return it->second;
+}
+
+} // namespace DB
+} // namespace Das
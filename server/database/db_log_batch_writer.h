@@ -0,0 +1,61 @@
+#ifndef DAS_DB_LOG_BATCH_WRITER_H
+#define DAS_DB_LOG_BATCH_WRITER_H
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include <functional>
+
+#include <QSqlQuery>
+
+#include <Helpz/db_base.h>
+
+namespace Das {
+namespace DB {
+
+// Collects log packs of many schemes and writes them by one multi-row insert per table.
+// Packs are collected while log thread is busy, so the batch size grows with the load.
+class Log_Batch_Writer
+{
+public:
+    using Done_Func = std::function<void(Helpz::DB::Base& db, bool is_ok)>;
+
+    static const int max_rows_per_query = 256;
+
+    // Table must be without id field.
+    // Returns true if it is first pack after last flush, then flush must be added to log thread.
+    bool add(const Helpz::DB::Table& table, int row_count, QVariantList&& values, Done_Func done_func);
+
+    // Called in log thread
+    void flush(Helpz::DB::Base& db);
+private:
+    struct Pack
+    {
+        int row_count_;
+        QVariantList values_;
+        Done_Func done_func_;
+    };
+
+    struct Table_Packs
+    {
+        Helpz::DB::Table table_;
+        std::vector<Pack> packs_;
+    };
+
+    void flush_table(Helpz::DB::Base& db, Table_Packs& table_packs);
+    // written_rows is count of rows saved even if false is returned, it is not zero when driver hasn't transactions
+    bool write(Helpz::DB::Base& db, const Helpz::DB::Table& table, const QVariantList& values, int row_count, int& written_rows);
+    bool exec_rows(Helpz::DB::Base& db, const Helpz::DB::Table& table, const QVariantList& values, int row_offset, int row_count);
+    QSqlQuery& prepared_query(Helpz::DB::Base& db, const Helpz::DB::Table& table, int row_count);
+
+    std::mutex mutex_;
+    std::map<QString, Table_Packs> pending_;
+
+    // Used only in log thread. Row count of query is always power of two, so cache is small.
+    std::map<std::pair<QString, int>, QSqlQuery> query_cache_;
+};
+
+} // namespace DB
+} // namespace Das
+
+#endif // DAS_DB_LOG_BATCH_WRITER_H
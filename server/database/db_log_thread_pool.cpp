@@ -0,0 +1,78 @@
+#include "db_log_thread_pool.h"
+
+namespace Das {
+namespace DB {
+
+Log_Thread_Pool::Shard::Shard(const Helpz::DB::Connection_Info& info) :
+    queue_size_(0), max_queue_size_(0), done_count_(0),
+    thread_(info, 1)
+{
+}
+
+Log_Thread_Pool::Log_Thread_Pool(const Helpz::DB::Connection_Info& info, std::size_t thread_count)
+{
+    if (thread_count == 0)
+        thread_count = 1;
+
+    for (std::size_t i = 0; i < thread_count; ++i)
+        shards_.emplace_back(new Shard{info});
+}
+
+std::size_t Log_Thread_Pool::size() const
+{
+    return shards_.size();
+}
+
+void Log_Thread_Pool::add(uint32_t scheme_id, std::function<void(Helpz::DB::Base*)> func)
+{
+    add(shard(scheme_id), std::move(func));
+}
+
+void Log_Thread_Pool::add_pack(uint32_t scheme_id, const Helpz::DB::Table& table, int row_count, QVariantList&& values,
+                               Log_Batch_Writer::Done_Func done_func)
+{
+    Shard* shard = this->shard(scheme_id);
+    if (shard->batch_writer_.add(table, row_count, std::move(values), std::move(done_func)))
+    {
+        add(shard, [shard](Helpz::DB::Base* db)
+        {
+            shard->batch_writer_.flush(*db);
+        });
+    }
+}
+
+Log_Thread_Pool::Shard* Log_Thread_Pool::shard(uint32_t scheme_id)
+{
+    return shards_.at(scheme_id % shards_.size()).get();
+}
+
+void Log_Thread_Pool::add(Shard* shard, std::function<void(Helpz::DB::Base*)> func)
+{
+    const std::size_t queue_size = ++shard->queue_size_;
+    std::size_t max_queue_size = shard->max_queue_size_;
+    while (max_queue_size < queue_size
+           && !shard->max_queue_size_.compare_exchange_weak(max_queue_size, queue_size));
+
+    shard->thread_.add([shard, func](Helpz::DB::Base* db)
+    {
+        func(db);
+        --shard->queue_size_;
+        ++shard->done_count_;
+    });
+}
+
+std::vector<Log_Thread_Pool::Stats> Log_Thread_Pool::stats(bool reset_max)
+{
+    std::vector<Stats> stats_list;
+    for (const std::unique_ptr<Shard>& shard: shards_)
+    {
+        const std::size_t queue_size = shard->queue_size_;
+        stats_list.push_back(Stats{queue_size,
+                                   reset_max ? shard->max_queue_size_.exchange(queue_size) : shard->max_queue_size_.load(),
+                                   shard->done_count_});
+    }
+    return stats_list;
+}
+
+} // namespace DB
+} // namespace Das
@@ -0,0 +1,58 @@
+#ifndef DAS_DB_LOG_THREAD_POOL_H
+#define DAS_DB_LOG_THREAD_POOL_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <functional>
+
+#include <Helpz/db_thread.h>
+
+#include "db_log_batch_writer.h"
+
+namespace Das {
+namespace DB {
+
+// Log data of one scheme always goes to the same thread, so order of the scheme packs is preserved
+class Log_Thread_Pool
+{
+public:
+    struct Stats
+    {
+        std::size_t queue_size_;
+        std::size_t max_queue_size_;
+        uint64_t done_count_;
+    };
+
+    Log_Thread_Pool(const Helpz::DB::Connection_Info& info, std::size_t thread_count);
+
+    std::size_t size() const;
+    void add(uint32_t scheme_id, std::function<void(Helpz::DB::Base*)> func);
+
+    // Rows is inserted together with packs of other schemes of the same thread
+    void add_pack(uint32_t scheme_id, const Helpz::DB::Table& table, int row_count, QVariantList&& values,
+                  Log_Batch_Writer::Done_Func done_func);
+
+    // Max queue size is counted from previous call with reset_max
+    std::vector<Stats> stats(bool reset_max = false);
+private:
+    struct Shard
+    {
+        Shard(const Helpz::DB::Connection_Info& info);
+
+        std::atomic<std::size_t> queue_size_, max_queue_size_;
+        std::atomic<uint64_t> done_count_;
+        Log_Batch_Writer batch_writer_;
+        Helpz::DB::Thread thread_;
+    };
+
+    Shard* shard(uint32_t scheme_id);
+    void add(Shard* shard, std::function<void(Helpz::DB::Base*)> func);
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace DB
+} // namespace Das
+
+#endif // DAS_DB_LOG_THREAD_POOL_H
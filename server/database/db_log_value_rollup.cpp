@@ -0,0 +1,247 @@
+#include <map>
+
+#include <QDateTime>
+#include <QRegularExpression>
+#include <QLoggingCategory>
+
+#include <Helpz/db_table.h>
+
+#include "db_log_value_rollup.h"
+
+namespace Das {
+namespace DB {
+
+Q_LOGGING_CATEGORY(Rollup_Log, "rollup")
+
+using namespace Helpz::DB;
+
+namespace {
+
+// Boolean values may be saved as 1/0 or as true/false, both is aggregated as number
+const QString numeric_condition =
+        "(value REGEXP '^[-+]?[0-9]+(\\\\.[0-9]+)?([eE][-+]?[0-9]+)?$' OR value IN ('true', 'false'))";
+const QString numeric_value = "CASE value WHEN 'true' THEN 1 WHEN 'false' THEN 0 ELSE value + 0 END";
+
+QString rollup_field_names(const Table& table)
+{
+    QStringList names = table.field_names();
+    names.removeFirst(); // remove id
+    return names.join(',');
+}
+
+// Same rule as numeric_condition, so live and backfilled buckets is equal
+bool get_numeric_value(const QVariant& value, double& number)
+{
+    static const QRegularExpression number_re("^[-+]?[0-9]+(\\.[0-9]+)?([eE][-+]?[0-9]+)?$");
+
+    const QString text = Device_Item_Value::prepare_value(value).toString();
+    if (text == "true" || text == "false")
+    {
+        number = text == "true" ? 1. : 0.;
+        return true;
+    }
+
+    if (!number_re.match(text).hasMatch())
+        return false;
+    number = text.toDouble();
+    return true;
+}
+
+QString first_in_group(const QString& name, const QString& order)
+{
+    return "SUBSTRING_INDEX(GROUP_CONCAT(" + name + " ORDER BY " + order + " SEPARATOR ';'), ';', 1) + 0";
+}
+
+} // namespace
+
+/*static*/ void Log_Value_Rollup_Manager::update(Base& db, uint32_t scheme_id, const QVector<Log_Value_Item>& pack)
+{
+    update_table<Log_Value_Minute>(db, scheme_id, pack);
+    update_table<Log_Value_Hour>(db, scheme_id, pack);
+    update_table<Log_Value_Day>(db, scheme_id, pack);
+}
+
+template<typename T>
+/*static*/ void Log_Value_Rollup_Manager::update_table(Base& db, uint32_t scheme_id, const QVector<Log_Value_Item>& pack)
+{
+    std::map<std::pair<uint32_t, qint64>, T> buckets;
+    double number;
+    for (const Log_Value_Item& item: pack)
+    {
+        if (!item.need_to_save() || !get_numeric_value(item.value(), number))
+            continue;
+
+        const qint64 bucket_time = item.timestamp_msecs() - (item.timestamp_msecs() % T::interval_msecs);
+        auto it = buckets.find({item.item_id(), bucket_time});
+        if (it == buckets.end())
+        {
+            it = buckets.emplace(std::make_pair(item.item_id(), bucket_time), T{bucket_time, item.item_id()}).first;
+            it->second.set_scheme_id(scheme_id);
+        }
+        it->second.add(item.timestamp_msecs(), number);
+    }
+
+    if (buckets.empty())
+        return;
+
+    QVariantList values, tmp_values;
+    for (const auto& it: buckets)
+    {
+        tmp_values = T::to_variantlist(it.second);
+        tmp_values.removeFirst(); // remove id
+        values += tmp_values;
+    }
+
+    const QString table_name = db_table_name<T>();
+    if (!db.exec(get_merge_sql(table_name, buckets.size()), values).isActive())
+        qCWarning(Rollup_Log) << "Failed update" << table_name << "for scheme" << scheme_id;
+}
+
+/*static*/ QString Log_Value_Rollup_Manager::get_merge_sql(const QString& table_name, int row_count)
+{
+    using T = Log_Value_Rollup;
+    const Table table = db_table<T>();
+    const QStringList& names = table.field_names();
+
+    auto name = [&names](int index) { return names.at(index); };
+    auto value = [&names](int index) { return "VALUES(" + names.at(index) + ')'; };
+
+    // Assignments is applied from left to right and use already updated columns,
+    // so time of minimum, maximum and last value is changed before the value itself.
+    const QString update_sql =
+            name(T::COL_min_timestamp_msecs) + " = IF(" + value(T::COL_min_value) + " < " + name(T::COL_min_value) +
+            " OR (" + value(T::COL_min_value) + " = " + name(T::COL_min_value) + " AND " +
+            value(T::COL_min_timestamp_msecs) + " < " + name(T::COL_min_timestamp_msecs) + "), " +
+            value(T::COL_min_timestamp_msecs) + ", " + name(T::COL_min_timestamp_msecs) + "), " +
+            name(T::COL_min_value) + " = LEAST(" + name(T::COL_min_value) + ", " + value(T::COL_min_value) + "), " +
+
+            name(T::COL_max_timestamp_msecs) + " = IF(" + value(T::COL_max_value) + " > " + name(T::COL_max_value) +
+            " OR (" + value(T::COL_max_value) + " = " + name(T::COL_max_value) + " AND " +
+            value(T::COL_max_timestamp_msecs) + " < " + name(T::COL_max_timestamp_msecs) + "), " +
+            value(T::COL_max_timestamp_msecs) + ", " + name(T::COL_max_timestamp_msecs) + "), " +
+            name(T::COL_max_value) + " = GREATEST(" + name(T::COL_max_value) + ", " + value(T::COL_max_value) + "), " +
+
+            name(T::COL_last_value) + " = IF(" + value(T::COL_last_timestamp_msecs) + " >= " + name(T::COL_last_timestamp_msecs) +
+            ", " + value(T::COL_last_value) + ", " + name(T::COL_last_value) + "), " +
+            name(T::COL_last_timestamp_msecs) + " = GREATEST(" + name(T::COL_last_timestamp_msecs) + ", " +
+            value(T::COL_last_timestamp_msecs) + "), " +
+
+            name(T::COL_value_count) + " = " + name(T::COL_value_count) + " + " + value(T::COL_value_count) + ", " +
+            name(T::COL_sum_value) + " = " + name(T::COL_sum_value) + " + " + value(T::COL_sum_value);
+
+    return "INSERT INTO " + table_name + '(' + rollup_field_names(table) + ") VALUES" +
+            Base::get_q_array(names.size() - 1, row_count) +
+            " ON DUPLICATE KEY UPDATE " + update_sql;
+}
+
+/*static*/ QString Log_Value_Rollup_Manager::get_fill_sql(const QString& table_name, qint64 interval, const QString& where)
+{
+    using T = Log_Value_Rollup;
+    const Table table = db_table<T>();
+
+    QString update_sql;
+    for (int i = T::COL_value_count; i < T::COL_scheme_id; ++i)
+    {
+        if (!update_sql.isEmpty())
+            update_sql += ", ";
+        const QString& name = table.field_names().at(i);
+        update_sql += name + " = VALUES(" + name + ')';
+    }
+
+    const QString interval_str = QString::number(interval);
+    return "INSERT INTO " + table_name + '(' + rollup_field_names(table) + ") "
+            "SELECT bucket, item_id, COUNT(*), MIN(num_value), MAX(num_value), SUM(num_value), "
+            + first_in_group("num_value", "timestamp_msecs DESC") + ", MAX(timestamp_msecs), "
+            + first_in_group("timestamp_msecs", "num_value, timestamp_msecs") + ", "
+            + first_in_group("timestamp_msecs", "num_value DESC, timestamp_msecs") + ", scheme_id FROM "
+            "(SELECT FLOOR(timestamp_msecs / " + interval_str + ") * " + interval_str + " AS bucket, "
+            "timestamp_msecs, item_id, scheme_id, " + numeric_value + " AS num_value FROM " + db_table_name<Log_Value_Item>() +
+            " WHERE " + where + " AND " + numeric_condition + ") lv"
+            " GROUP BY scheme_id, item_id, bucket"
+            " ON DUPLICATE KEY UPDATE " + update_sql;
+}
+
+// ------------------------------------------------------------------------------------------
+
+Log_Value_Rollup_Manager::Log_Value_Rollup_Manager(Thread* db_thread, const Config& config) :
+    in_progress_(false),
+    backfill_cursor_(0), log_begin_time_(0),
+    config_(config),
+    db_thread_(db_thread)
+{
+}
+
+void Log_Value_Rollup_Manager::compact()
+{
+    if (in_progress_)
+        return;
+    in_progress_ = true;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    db_thread_->add([this, now](Base* db)
+    {
+        compact_impl(*db, now);
+        in_progress_ = false;
+    });
+}
+
+void Log_Value_Rollup_Manager::compact_impl(Base& db, qint64 now)
+{
+    const qint64 day_msecs = Log_Value_Day::interval_msecs;
+    const qint64 minute_keep_time = now - config_.minute_keep_days_ * day_msecs;
+
+    delete_old(db, db_table_name<Log_Value_Minute>(), minute_keep_time);
+    delete_old(db, db_table_name<Log_Value_Hour>(), now - config_.hour_keep_days_ * day_msecs);
+
+    // Backfill from raw log going back in time, one hour per step.
+    // The cursor is the begining of the oldest filled hour.
+    if (backfill_cursor_ == 0)
+    {
+        const qint64 hour_msecs = Log_Value_Hour::interval_msecs;
+        QSqlQuery q = db.exec("SELECT MIN(timestamp_msecs) FROM " + db_table_name<Log_Value_Hour>());
+        backfill_cursor_ = q.next() && !q.isNull(0) ? q.value(0).toLongLong() : now;
+        backfill_cursor_ -= backfill_cursor_ % hour_msecs;
+
+        q = db.exec("SELECT MIN(timestamp_msecs) FROM " + db_table_name<Log_Value_Item>());
+        log_begin_time_ = q.next() && !q.isNull(0) ? q.value(0).toLongLong() : backfill_cursor_;
+    }
+
+    for (int i = 0; i < config_.backfill_hours_per_tick_ && backfill_cursor_ > log_begin_time_; ++i)
+    {
+        const qint64 time_to = backfill_cursor_;
+        const qint64 time_from = time_to - Log_Value_Hour::interval_msecs;
+
+        fill_from_log(db, db_table_name<Log_Value_Hour>(), Log_Value_Hour::interval_msecs, time_from, time_to);
+
+        if (time_from >= minute_keep_time)
+            fill_from_log(db, db_table_name<Log_Value_Minute>(), Log_Value_Minute::interval_msecs, time_from, time_to);
+
+        backfill_cursor_ = time_from;
+    }
+}
+
+void Log_Value_Rollup_Manager::delete_old(Base& db, const QString& table_name, qint64 time)
+{
+    const QString sql = "DELETE FROM " + table_name + " WHERE timestamp_msecs < " + QString::number(time)
+            + " LIMIT " + QString::number(config_.delete_limit_);
+    QSqlQuery q = db.exec(sql);
+    if (!q.isActive())
+        qCWarning(Rollup_Log) << "Failed delete old rows from" << table_name;
+}
+
+void Log_Value_Rollup_Manager::fill_from_log(Base& db, const QString& table_name, qint64 interval, qint64 time_from, qint64 time_to)
+{
+    // Only items that have no rollup rows in this window is filled
+    const QString log_table_name = db_table_name<Log_Value_Item>();
+    const QString from_str = QString::number(time_from), to_str = QString::number(time_to);
+    const QString where = "timestamp_msecs >= " + from_str + " AND timestamp_msecs < " + to_str +
+            " AND NOT EXISTS (SELECT 1 FROM " + table_name + " r"
+            " WHERE r.scheme_id = " + log_table_name + ".scheme_id AND r.item_id = " + log_table_name + ".item_id"
+            " AND r.timestamp_msecs >= " + from_str + " AND r.timestamp_msecs < " + to_str + ')';
+
+    if (!db.exec(get_fill_sql(table_name, interval, where)).isActive())
+        qCWarning(Rollup_Log) << "Failed fill" << table_name << "from" << time_from << "to" << time_to;
+}
+
+} // namespace DB
+} // namespace Das
@@ -0,0 +1,59 @@
+#ifndef DAS_DATABASE_LOG_VALUE_ROLLUP_H
+#define DAS_DATABASE_LOG_VALUE_ROLLUP_H
+
+#include <atomic>
+
+#include <QVector>
+
+#include <Helpz/db_base.h>
+#include <Helpz/db_thread.h>
+
+#include <Das/log/log_value_item.h>
+#include <Das/log/log_value_rollup.h>
+
+namespace Das {
+namespace DB {
+
+class Log_Value_Rollup_Manager
+{
+public:
+    struct Config
+    {
+        int minute_keep_days_ = 31;
+        int hour_keep_days_ = 366;
+        int backfill_hours_per_tick_ = 6;
+        int delete_limit_ = 10000;
+    };
+
+    // Called from log thread once after log values pack is inserted.
+    // Numeric values of pack is aggregated in memory and merged to existing buckets.
+    static void update(Helpz::DB::Base& db, uint32_t scheme_id, const QVector<Log_Value_Item>& pack);
+
+    Log_Value_Rollup_Manager(Helpz::DB::Thread* db_thread, const Config& config);
+
+    // Called from main thread by timer
+    void compact();
+private:
+    void compact_impl(Helpz::DB::Base& db, qint64 now);
+    void delete_old(Helpz::DB::Base& db, const QString& table_name, qint64 time);
+    void fill_from_log(Helpz::DB::Base& db, const QString& table_name, qint64 interval, qint64 time_from, qint64 time_to);
+
+    template<typename T>
+    static void update_table(Helpz::DB::Base& db, uint32_t scheme_id, const QVector<Log_Value_Item>& pack);
+
+    // Merge rows of pack aggregates to existing buckets of table_name
+    static QString get_merge_sql(const QString& table_name, int row_count);
+
+    // Aggregate numeric values of log rows matched by where to buckets of table_name
+    static QString get_fill_sql(const QString& table_name, qint64 interval, const QString& where);
+
+    std::atomic<bool> in_progress_;
+    qint64 backfill_cursor_, log_begin_time_;
+    Config config_;
+    Helpz::DB::Thread* db_thread_;
+};
+
+} // namespace DB
+} // namespace Das
+
+#endif // DAS_DATABASE_LOG_VALUE_ROLLUP_H
@@ -3,9 +3,9 @@
 namespace Das {
 namespace DB {
 
-Thread_Manager::Thread_Manager(Helpz::DB::Connection_Info info) :
+Thread_Manager::Thread_Manager(Helpz::DB::Connection_Info info, std::size_t log_thread_count) :
     db_thread_(info, 5, 90),
-    db_log_thread_(info, 1)
+    db_log_pool_(info, log_thread_count)
 {
     std::this_thread::sleep_for(std::chrono::milliseconds(50));
 }
@@ -19,9 +19,9 @@ Helpz::DB::Thread* Thread_Manager::thread()
     return &db_thread_;
 }
 
-Helpz::DB::Thread *Thread_Manager::log_thread()
+Log_Thread_Pool *Thread_Manager::log_pool()
 {
-    return &db_log_thread_;
+    return &db_log_pool_;
 }
 
 std::shared_ptr<global> Thread_Manager::get_db()
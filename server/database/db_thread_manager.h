@@ -5,6 +5,7 @@
 #include <boost/thread/shared_mutex.hpp>
 
 #include "db_scheme.h"
+#include "db_log_thread_pool.h"
 
 namespace Das {
 namespace DB {
@@ -12,18 +13,18 @@ namespace DB {
 class Thread_Manager
 {
 public:
-    Thread_Manager(Helpz::DB::Connection_Info info);
+    Thread_Manager(Helpz::DB::Connection_Info info, std::size_t log_thread_count);
     ~Thread_Manager();
 
     Helpz::DB::Thread* thread();
-    Helpz::DB::Thread* log_thread();
+    Log_Thread_Pool* log_pool();
     std::shared_ptr<global> get_db();
 private:
     boost::shared_mutex mutex_;
     std::map<std::thread::id, std::shared_ptr<global>> db_list_;
 
     Helpz::DB::Thread db_thread_;
-    Helpz::DB::Thread db_log_thread_;
+    Log_Thread_Pool db_log_pool_;
 };
 
 } // namespace DB
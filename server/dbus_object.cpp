@@ -5,6 +5,7 @@
 #include <Das/commands.h>
 
 #include "server_protocol.h"
+#include "scheme_node_index.h"
 #include "dbus_object.h"
 
 namespace Das {
@@ -12,7 +13,8 @@ namespace Server {
 
 Dbus_Object::Dbus_Object(Helpz::DTLS::Server* server, const QString& service_name, const QString& object_path) :
     DBus::Object_Base(service_name, object_path),
-    server_(server)
+    server_(server),
+    node_index_(nullptr)
 {
 }
 
@@ -25,10 +27,19 @@ void Dbus_Object::set_server(Helpz::DTLS::Server *server)
     server_ = server;
 }
 
+void Dbus_Object::set_node_index(const Scheme_Node_Index *node_index)
+{
+    node_index_ = node_index;
+}
+
 std::shared_ptr<Helpz::DTLS::Server_Node> Dbus_Object::find_client(uint32_t scheme_id) const
 {
     if (!server_)
         return {};
+
+    if (node_index_)
+        return node_index_->find(scheme_id);
+
     return server_->find_client([scheme_id](const Helpz::Net::Protocol* protocol) -> bool
     {
         auto p = static_cast<const Protocol_Base*>(protocol);
@@ -43,18 +54,10 @@ bool Dbus_Object::is_connected(uint32_t scheme_id) const
 
 uint8_t Dbus_Object::get_scheme_connection_state(const std::set<uint32_t>& scheme_group_set, uint32_t scheme_id) const
 {
-    if (!server_)
-        return CS_DISCONNECTED;
-
-    std::shared_ptr<Helpz::DTLS::Server_Node> node = server_->find_client([scheme_id, &scheme_group_set](const Helpz::Net::Protocol* protocol) -> bool
-    {
-        auto p = static_cast<const Protocol_Base*>(protocol);
-        return p->id() == scheme_id && p->check_scheme_groups(scheme_group_set);
-    });
-
-    if (node)
+    std::shared_ptr<Helpz::DTLS::Server_Node> node = find_client(scheme_id);
+    std::shared_ptr<Protocol_Base> p = node ? std::static_pointer_cast<Protocol_Base>(node->protocol()) : nullptr;
+    if (p && p->check_scheme_groups(scheme_group_set))
     {
-        std::shared_ptr<Protocol_Base> p = std::static_pointer_cast<Protocol_Base>(node->protocol());
         uint8_t state = p->connection_state();
         if ((state & ~CS_FLAGS) == CS_CONNECTED && (state & CS_CONNECTED_WITH_LOSSES))
         {
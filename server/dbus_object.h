@@ -15,6 +15,8 @@ class Server_Node;
 namespace Das {
 namespace Server {
 
+class Scheme_Node_Index;
+
 class Dbus_Object final : public DBus::Object_Base
 {
     Q_OBJECT
@@ -26,6 +28,7 @@ public:
     ~Dbus_Object();
 
     void set_server(Helpz::DTLS::Server* server);
+    void set_node_index(const Scheme_Node_Index* node_index);
 
     std::shared_ptr<Helpz::DTLS::Server_Node> find_client(uint32_t scheme_id) const;
 
@@ -46,6 +49,7 @@ public slots:
     bool ping();
 private:
     Helpz::DTLS::Server* server_;
+    const Scheme_Node_Index* node_index_;
 };
 
 } // namespace Server
@@ -1,11 +1,16 @@
+#include <QTimer>
+
 #include <Helpz/dtls_server_node.h>
 
 #include <Das/commands.h>
 #include <Das/db/device_item_value.h>
+#include <plus/das/upsert_helper.h>
+#include <Das/log/log_pack_codec.h>
 
 #include "server.h"
 #include "database/db_thread_manager.h"
 #include "database/db_scheme.h"
+#include "database/db_log_value_rollup.h"
 #include "server_protocol.h"
 #include "dbus_object.h"
 
@@ -28,13 +33,32 @@ QString get_custom_q_array(const Table& table, int row_count)
 }
 
 template<typename T>
-void fill_log_data_impl(uint32_t scheme_id, QIODevice &data_dev, QString &sql, QVariantList &values_pack, int &row_count)
+bool parse_log_pack(QIODevice &data_dev, bool is_compressed, QVector<T>& pack)
 {
     const int dsver = Helpz::Net::Protocol::DATASTREAM_VERSION;
 
+    if (is_compressed)
+    {
+        QByteArray data;
+        Helpz::parse_out(dsver, data_dev, data);
+        if (!Log_Pack_Codec::decode(data, pack, dsver))
+        {
+            qCWarning(Sync_Log) << "Bad compressed log pack, size:" << data.size();
+            return false;
+        }
+    }
+    else
+        Helpz::parse_out(dsver, data_dev, pack);
+    return true;
+}
+
+template<typename T>
+QVector<T> fill_log_data_impl(uint32_t scheme_id, bool is_compressed, QIODevice &data_dev, QString &sql, QVariantList &values_pack, int &row_count)
+{
     QVariantList tmp_values;
     QVector<T> data;
-    Helpz::parse_out(dsver, data_dev, data);
+    if (!parse_log_pack<T>(data_dev, is_compressed, data))
+        return data;
     row_count = data.size();
     for (T& item: data)
     {
@@ -47,6 +71,7 @@ void fill_log_data_impl(uint32_t scheme_id, QIODevice &data_dev, QString &sql, Q
     auto table = db_table<T>();
     table.field_names().removeFirst(); // remove id
     sql = get_custom_q_array(table, data.size());
+    return data;
 }
 
 template<typename T> bool can_log_item_save(const T& /*item*/) { return true; }
@@ -57,77 +82,79 @@ template<> void after_process_pack<Log_Param_Item>(Base& db, uint32_t scheme_id,
 {
     // Save current param value
 
-    Table table = db_table<DIG_Param_Value>();
+    std::map<uint32_t, const Log_Param_Item*> last_item_map;
+    for(const Log_Param_Item& item: pack)
+    {
+        const Log_Param_Item*& last_item = last_item_map[item.group_param_id()];
+        if (!last_item || last_item->timestamp_msecs() <= item.timestamp_msecs())
+            last_item = &item;
+    }
 
     using T = DIG_Param_Value;
-    QStringList field_names{
+    Table table = db_table<T>();
+    const QStringList update_field_names{
         table.field_names().at(T::COL_timestamp_msecs),
         table.field_names().at(T::COL_user_id),
         table.field_names().at(T::COL_value)
     };
+    const QStringList key_field_names{
+        table.field_names().at(T::COL_group_param_id),
+        table.field_names().at(T::COL_scheme_id)
+    };
+    table.field_names().removeFirst(); // remove id
 
-    table.field_names() = std::move(field_names);
-
-    const QString where = "scheme_id = " + QString::number(scheme_id) + " AND group_param_id = ";
-    QVariantList values{QVariant(), QVariant(), QVariant()};
-
-    for(const Log_Param_Item& item: pack)
+    QVariantList values;
+    for (const auto& it: last_item_map)
     {
-        values.front() = item.timestamp_msecs();
-        values[1] = item.user_id();
-        values.back() = item.value();
+        const Log_Param_Item& item = *it.second;
+        values += QVariantList{ item.timestamp_msecs(), item.user_id(), item.group_param_id(), item.value(), scheme_id };
+    }
 
-        const QSqlQuery q = db.update(table, values, where + QString::number(item.group_param_id()));
-        if (!q.isActive() || q.numRowsAffected() <= 0)
-        {
-            Table ins_table = db_table<DIG_Param_Value>();
-            ins_table.field_names().removeFirst(); // remove id
+    if (!Upsert_Helper::save(db, table, key_field_names, update_field_names, values, last_item_map.size()))
+        qCWarning(Sync_Log) << "Failed to save current param values for scheme" << scheme_id;
+}
 
-            const QVariantList ins_values{ item.timestamp_msecs(), item.user_id(), item.group_param_id(),
-                                           item.value(), scheme_id };
-            if (!db.insert(ins_table, ins_values))
-            {
-                // TODO: do something
-            }
-        }
-    }
+// Rollups is computed from saved log, so they are updated only when log is inserted
+template<typename T> bool is_after_process_need_insert() { return false; }
+template<> bool is_after_process_need_insert<Log_Value_Item>() { return true; }
+
+template<> void after_process_pack<Log_Value_Item>(Base& db, uint32_t scheme_id, const QVector<Log_Value_Item>& pack)
+{
+    DB::Log_Value_Rollup_Manager::update(db, scheme_id, pack);
 }
 
 template<> void after_process_pack<Log_Mode_Item>(Base& db, uint32_t scheme_id, const QVector<Log_Mode_Item>& pack)
 {
-    Table table = db_table<DIG_Mode>();
+    std::map<uint32_t, const Log_Mode_Item*> last_mode_map;
+    for(const Log_Mode_Item& mode: pack)
+    {
+        const Log_Mode_Item*& last_mode = last_mode_map[mode.group_id()];
+        if (!last_mode || last_mode->timestamp_msecs() <= mode.timestamp_msecs())
+            last_mode = &mode;
+    }
 
     using T = DIG_Mode;
-    QStringList field_names{
+    Table table = db_table<T>();
+    const QStringList update_field_names{
         table.field_names().at(T::COL_timestamp_msecs),
         table.field_names().at(T::COL_user_id),
         table.field_names().at(T::COL_mode_id)
     };
+    const QStringList key_field_names{
+        table.field_names().at(T::COL_group_id),
+        table.field_names().at(T::COL_scheme_id)
+    };
+    table.field_names().removeFirst(); // remove id
 
-    table.field_names() = std::move(field_names);
-
-    const QString where = "scheme_id = " + QString::number(scheme_id) + " AND group_id = ";
-    QVariantList values{QVariant(), QVariant(), QVariant()};
-
-    for(const Log_Mode_Item& mode: pack)
+    QVariantList values;
+    for (const auto& it: last_mode_map)
     {
-        values.front() = mode.timestamp_msecs();
-        values[1] = mode.user_id();
-        values.back() = mode.mode_id();
-
-        const QSqlQuery q = db.update(table, values, where + QString::number(mode.group_id()));
-        if (!q.isActive() || q.numRowsAffected() <= 0)
-        {
-            Table ins_table = db_table<DIG_Mode>();
-            ins_table.field_names().removeFirst(); // remove id
-
-            QVariantList ins_values{ mode.timestamp_msecs(), mode.user_id(), mode.group_id(), mode.mode_id(), scheme_id };
-            if (!db.insert(ins_table, ins_values))
-            {
-                // TODO: do something
-            }
-        }
+        const Log_Mode_Item& mode = *it.second;
+        values += QVariantList{ mode.timestamp_msecs(), mode.user_id(), mode.group_id(), mode.mode_id(), scheme_id };
     }
+
+    if (!Upsert_Helper::save(db, table, key_field_names, update_field_names, values, last_mode_map.size()))
+        qCWarning(Sync_Log) << "Failed to save current modes for scheme" << scheme_id;
 }
 
 // После вызова этой функции нельзя использовать pack_ptr в вызывающей функции
@@ -143,46 +170,50 @@ void process_pack_impl(Server::Protocol_Base* proto, std::shared_ptr<QVector<T>>
 
     uint32_t s_id = proto->id();
 
-    Helpz::DB::Thread* log_thread = proto->work_object()->db_thread_mng_->log_thread();
+    QVariantList values_pack, tmp_values;
+    int row_count = 0;
+    for (T& item: *pack_ptr)
+    {
+        item.set_scheme_id(s_id);
+        if (can_log_item_save<T>(item))
+        {
+            tmp_values = T::to_variantlist(item);
+            tmp_values.removeFirst();
+
+            values_pack += tmp_values;
+            ++row_count;
+        }
+    }
+
+    DB::Log_Thread_Pool* log_pool = proto->work_object()->db_thread_mng_->log_pool();
 
     auto node = std::dynamic_pointer_cast<Helpz::DTLS::Server_Node>(proto->writer());
 
-    log_thread->add([pack_ptr, s_id, node, msg_id](Base* db)
+    if (values_pack.empty())
     {
-        QVariantList values_pack, tmp_values;
-        for (T& item: *pack_ptr)
-        {
-            if (can_log_item_save<T>(item))
-            {
-                item.set_scheme_id(s_id);
-                tmp_values = T::to_variantlist(item);
-                tmp_values.removeFirst();
+        proto->send_answer(Cmd::LOG_PACK, msg_id);
 
-                values_pack += tmp_values;
-            }
-        }
+        log_pool->add(s_id, [pack_ptr, s_id](Base* db)
+        {
+            after_process_pack<T>(*db, s_id, *pack_ptr);
+        });
+        return;
+    }
 
-        auto protocol = node->protocol();
+    auto table = db_table<T>();
+    table.field_names().removeFirst(); // remove id
 
-        if (values_pack.empty())
+    log_pool->add_pack(s_id, table, row_count, std::move(values_pack), [pack_ptr, s_id, node, msg_id](Base& db, bool is_ok)
+    {
+        if (is_ok && node)
         {
+            auto protocol = node->protocol();
             if (protocol)
                 protocol->send_answer(Cmd::LOG_PACK, msg_id);
         }
-        else
-        {
-            auto table = db_table<T>();
-            table.field_names().removeFirst(); // remove id
 
-            const QString sql = get_custom_q_array(table, values_pack.size() / table.field_names().size());
-            if (db->exec(sql, values_pack).isActive() && node)
-            {
-                if (protocol)
-                    protocol->send_answer(Cmd::LOG_PACK, msg_id);
-            }
-        }
-
-        after_process_pack<T>(*db, s_id, *pack_ptr);
+        if (is_ok || !is_after_process_need_insert<T>())
+            after_process_pack<T>(db, s_id, *pack_ptr);
     });
 }
 
@@ -204,9 +235,30 @@ void Log_Sync_Item::check()
     }
 }
 
-Thread *Log_Sync_Item::log_thread()
+void Log_Sync_Item::process_bad_pack()
+{
+    qCWarning(Sync_Log).noquote() << title() << type_.to_string() << "bad pack isn't acknowledged";
+    protocol()->set_connection_state(protocol()->connection_state() | CS_CONNECTED_WITH_LOSSES);
+
+    std::weak_ptr<Helpz::DTLS::Server_Node> node = std::dynamic_pointer_cast<Helpz::DTLS::Server_Node>(protocol()->writer());
+    const Log_Type_Wrapper type = type_;
+    QTimer::singleShot(std::chrono::seconds(15), protocol()->work_object(), [node, type]()
+    {
+        std::shared_ptr<Helpz::DTLS::Server_Node> node_ptr = node.lock();
+        std::shared_ptr<Protocol> scheme = node_ptr ? std::dynamic_pointer_cast<Protocol>(node_ptr->protocol()) : nullptr;
+        if (scheme)
+            scheme->log_sync()->log_sync_item(type.value())->check();
+    });
+}
+
+void Log_Sync_Item::add_to_log_thread(std::function<void(Base*)> func)
+{
+    protocol()->work_object()->db_thread_mng_->log_pool()->add(scheme_id(), std::move(func));
+}
+
+bool Log_Sync_Item::is_pack_compressed() const
 {
-    return protocol()->work_object()->db_thread_mng_->log_thread();
+    return static_cast<const Protocol*>(protocol())->log_pack_compression();
 }
 
 void Log_Sync_Item::request_log_data()
@@ -229,6 +281,7 @@ void Log_Sync_Item::process_log_data(QIODevice& data_dev, uint8_t msg_id)
     QString sql;
     QVariantList values_pack;
     int row_count = 0;
+    after_log_data_ = nullptr;
 
     try
     {
@@ -254,7 +307,8 @@ void Log_Sync_Item::process_log_data(QIODevice& data_dev, uint8_t msg_id)
         }
 
         Log_Type_Wrapper type = type_;
-        log_thread()->add([msg_id, sql, values_pack, node, type](Base* db)
+        std::function<void(Base&)> after_log_data = std::move(after_log_data_);
+        add_to_log_thread([msg_id, sql, values_pack, node, type, after_log_data](Base* db)
         {
             std::shared_ptr<Protocol> scheme = std::dynamic_pointer_cast<Protocol>(node->protocol());
 
@@ -264,6 +318,9 @@ void Log_Sync_Item::process_log_data(QIODevice& data_dev, uint8_t msg_id)
                 {
                     scheme->send_answer(Cmd::LOG_DATA_REQUEST, msg_id);
                 }
+
+                if (after_log_data)
+                    after_log_data(*db);
             }
 
             if (scheme && type.is_valid())
@@ -297,8 +354,11 @@ void Log_Sync_Values::process_pack(QVector<Log_Value_Item> &&pack, uint8_t msg_i
     }
 
     if (!pack_ptr->empty())
+    {
+        static_cast<Protocol*>(protocol())->blob_sync()->check_values(*pack_ptr);
         QMetaObject::invokeMethod(protocol()->work_object()->dbus_, "device_item_values_available", Qt::QueuedConnection,
                               Q_ARG(Scheme_Info, *protocol_), Q_ARG(QVector<Log_Value_Item>, *pack_ptr));
+    }
 
     process_pack_impl(protocol(), pack_ptr, msg_id);
 }
@@ -310,7 +370,14 @@ QString Log_Sync_Values::get_param_name() const
 
 void Log_Sync_Values::fill_log_data(QIODevice& data_dev, QString &sql, QVariantList &values_pack, int &row_count)
 {
-    fill_log_data_impl<Log_Value_Item>(scheme_id(), data_dev, sql, values_pack, row_count);
+    auto data = fill_log_data_impl<Log_Value_Item>(scheme_id(), is_pack_compressed(), data_dev, sql, values_pack, row_count);
+    static_cast<Protocol*>(protocol())->blob_sync()->check_values(data);
+
+    const uint32_t s_id = scheme_id();
+    after_log_data_ = [s_id, data](Base& db)
+    {
+        DB::Log_Value_Rollup_Manager::update(db, s_id, data);
+    };
 }
 
 // ------------------------------------------------------------------------------------------
@@ -338,7 +405,7 @@ QString Log_Sync_Events::get_param_name() const
 
 void Log_Sync_Events::fill_log_data(QIODevice& data_dev, QString &sql, QVariantList &values_pack, int& row_count)
 {
-    fill_log_data_impl<Log_Event_Item>(scheme_id(), data_dev, sql, values_pack, row_count);
+    fill_log_data_impl<Log_Event_Item>(scheme_id(), is_pack_compressed(), data_dev, sql, values_pack, row_count);
 }
 
 // ------------------------------------------------------------------------------------------
@@ -365,7 +432,7 @@ void Log_Sync_Params::process_pack(QVector<Log_Param_Item> &&pack, uint8_t msg_i
 
 void Log_Sync_Params::fill_log_data(QIODevice &data_dev, QString &sql, QVariantList &values_pack, int &row_count)
 {
-    fill_log_data_impl<Log_Param_Item>(scheme_id(), data_dev, sql, values_pack, row_count);
+    fill_log_data_impl<Log_Param_Item>(scheme_id(), is_pack_compressed(), data_dev, sql, values_pack, row_count);
 }
 
 // ------------------------------------------------------------------------------------------
@@ -394,7 +461,7 @@ void Log_Sync_Statuses::process_pack(QVector<Log_Status_Item> &&pack, uint8_t ms
 
 void Log_Sync_Statuses::fill_log_data(QIODevice &data_dev, QString &sql, QVariantList &values_pack, int &row_count)
 {
-    fill_log_data_impl<Log_Status_Item>(scheme_id(), data_dev, sql, values_pack, row_count);
+    fill_log_data_impl<Log_Status_Item>(scheme_id(), is_pack_compressed(), data_dev, sql, values_pack, row_count);
 }
 
 // ------------------------------------------------------------------------------------------
@@ -420,7 +487,7 @@ void Log_Sync_Modes::process_pack(QVector<Log_Mode_Item> &&pack, uint8_t msg_id)
 
 void Log_Sync_Modes::fill_log_data(QIODevice &data_dev, QString &sql, QVariantList &values_pack, int &row_count)
 {
-    fill_log_data_impl<Log_Mode_Item>(scheme_id(), data_dev, sql, values_pack, row_count);
+    fill_log_data_impl<Log_Mode_Item>(scheme_id(), is_pack_compressed(), data_dev, sql, values_pack, row_count);
 }
 
 // ------------------------------------------------------------------------------------------
@@ -459,30 +526,28 @@ void Log_Synchronizer::process_data(Log_Type_Wrapper type_id, QIODevice *data_de
 
 void Log_Synchronizer::process_pack(Log_Type_Wrapper type_id, QIODevice *data_dev, uint8_t msg_id)
 {
-    const int dsver = Helpz::Net::Protocol::DATASTREAM_VERSION;
-
     switch (type_id.value())
     {
-    case LOG_VALUE:
-        Helpz::apply_parse(*data_dev, dsver, &Log_Sync_Values::process_pack, &values_, msg_id);
-        break;
-    case LOG_EVENT:
-        Helpz::apply_parse(*data_dev, dsver, &Log_Sync_Events::process_pack, &events_, msg_id);
-        break;
-    case LOG_PARAM:
-        Helpz::apply_parse(*data_dev, dsver, &Log_Sync_Params::process_pack, &params_, msg_id);
-        break;
-    case LOG_STATUS:
-        Helpz::apply_parse(*data_dev, dsver, &Log_Sync_Statuses::process_pack, &statuses_, msg_id);
-        break;
-    case LOG_MODE:
-        Helpz::apply_parse(*data_dev, dsver, &Log_Sync_Modes::process_pack, &modes_, msg_id);
-        break;
+    case LOG_VALUE:  parse_and_process_pack<Log_Value_Item>(values_, *data_dev, msg_id); break;
+    case LOG_EVENT:  parse_and_process_pack<Log_Event_Item>(events_, *data_dev, msg_id); break;
+    case LOG_PARAM:  parse_and_process_pack<Log_Param_Item>(params_, *data_dev, msg_id); break;
+    case LOG_STATUS: parse_and_process_pack<Log_Status_Item>(statuses_, *data_dev, msg_id); break;
+    case LOG_MODE:   parse_and_process_pack<Log_Mode_Item>(modes_, *data_dev, msg_id); break;
     default:
         break;
     }
 }
 
+template<typename T, typename Sync_T>
+void Log_Synchronizer::parse_and_process_pack(Sync_T& sync_item, QIODevice& data_dev, uint8_t msg_id)
+{
+    QVector<T> pack;
+    if (parse_log_pack<T>(data_dev, sync_item.is_pack_compressed(), pack))
+        sync_item.process_pack(std::move(pack), msg_id);
+    else
+        sync_item.process_bad_pack();
+}
+
 Log_Sync_Item *Log_Synchronizer::log_sync_item(uint8_t type_id)
 {
     switch (type_id)
@@ -4,9 +4,11 @@
 #include <map>
 #include <vector>
 #include <ctime>
+#include <functional>
 
 #include <QIODevice>
 
+#include <Helpz/db_base.h>
 #include <Helpz/db_table.h>
 
 #include <Das/log/log_type.h>
@@ -30,11 +32,20 @@ public:
 
     void check();
     void process_log_data(QIODevice& data_dev, uint8_t msg_id);
+
+    // Pack which can't be decoded isn't acknowledged, so scheme saves it to its log.
+    // Log data is requested again after scheme answer timeout.
+    void process_bad_pack();
+
+    bool is_pack_compressed() const;
 protected:
-    Helpz::DB::Thread* log_thread();
+    void add_to_log_thread(std::function<void(Helpz::DB::Base*)> func);
 
     virtual QString get_param_name() const { return {}; }
     virtual void fill_log_data(QIODevice& data_dev, QString& sql, QVariantList& values_pack, int& row_count) = 0;
+
+    // Called in log thread after log data inserted
+    std::function<void(Helpz::DB::Base&)> after_log_data_;
 private:
     void request_log_range_count();
     void request_log_data();
@@ -102,6 +113,7 @@ public:
 
     void process_data(Log_Type_Wrapper type_id, QIODevice* data_dev, uint8_t msg_id);
     void process_pack(Log_Type_Wrapper type_id, QIODevice* data_dev, uint8_t msg_id);
+
     Log_Sync_Item* log_sync_item(uint8_t type_id);
     void request_log_data(uint8_t type_id);
 
@@ -110,6 +122,9 @@ public:
     Log_Sync_Params params_;
     Log_Sync_Statuses statuses_;
     Log_Sync_Modes modes_;
+private:
+    template<typename T, typename Sync_T>
+    void parse_and_process_pack(Sync_T& sync_item, QIODevice& data_dev, uint8_t msg_id);
 };
 
 } // namespace Server
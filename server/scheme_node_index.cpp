@@ -0,0 +1,50 @@
+#include <mutex>
+
+#include <Helpz/dtls_server_node.h>
+
+#include "scheme_node_index.h"
+
+namespace Das {
+namespace Server {
+
+void Scheme_Node_Index::add(uint32_t scheme_id, const Protocol_Base *protocol, std::shared_ptr<Helpz::DTLS::Server_Node> node)
+{
+    if (!scheme_id || !node)
+        return;
+
+    std::unique_lock lock(mutex_);
+    items_[scheme_id] = Item{protocol, std::move(node)};
+}
+
+void Scheme_Node_Index::remove(uint32_t scheme_id, const Protocol_Base *protocol)
+{
+    std::unique_lock lock(mutex_);
+    auto it = items_.find(scheme_id);
+    // Scheme can be already reconnected, so only own item is removed
+    if (it != items_.end() && it->second.protocol_ == protocol)
+        items_.erase(it);
+}
+
+void Scheme_Node_Index::clear()
+{
+    std::unique_lock lock(mutex_);
+    items_.clear();
+}
+
+std::shared_ptr<Helpz::DTLS::Server_Node> Scheme_Node_Index::find(uint32_t scheme_id) const
+{
+    std::shared_lock lock(mutex_);
+    auto it = items_.find(scheme_id);
+    if (it != items_.end())
+        return it->second.node_.lock();
+    return {};
+}
+
+std::size_t Scheme_Node_Index::size() const
+{
+    std::shared_lock lock(mutex_);
+    return items_.size();
+}
+
+} // namespace Server
+} // namespace Das
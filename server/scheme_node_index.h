@@ -0,0 +1,45 @@
+#ifndef DAS_SERVER_SCHEME_NODE_INDEX_H
+#define DAS_SERVER_SCHEME_NODE_INDEX_H
+
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace Helpz {
+namespace DTLS {
+class Server_Node;
+} // namespace DTLS
+} // namespace Helpz
+
+namespace Das {
+namespace Server {
+
+class Protocol_Base;
+
+// Authenticated scheme connections by scheme id.
+// Filled from server thread, read from DBus and other threads without posting to it.
+class Scheme_Node_Index
+{
+public:
+    void add(uint32_t scheme_id, const Protocol_Base* protocol, std::shared_ptr<Helpz::DTLS::Server_Node> node);
+    void remove(uint32_t scheme_id, const Protocol_Base* protocol);
+    void clear();
+
+    std::shared_ptr<Helpz::DTLS::Server_Node> find(uint32_t scheme_id) const;
+    std::size_t size() const;
+private:
+    struct Item
+    {
+        const Protocol_Base* protocol_;
+        std::weak_ptr<Helpz::DTLS::Server_Node> node_;
+    };
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<uint32_t, Item> items_;
+};
+
+} // namespace Server
+} // namespace Das
+
+#endif // DAS_SERVER_SCHEME_NODE_INDEX_H
@@ -28,11 +28,17 @@ SOURCES += main.cpp \
 #    old/structure_synchronizer_base_2_1.cpp \
     server_protocol.cpp \
     log_synchronizer.cpp \
+    blob_synchronizer.cpp \
     structure_synchronizer.cpp \
     database/db_thread_manager.cpp \
+    database/db_log_thread_pool.cpp \
+    database/db_log_batch_writer.cpp \
+    database/db_log_value_rollup.cpp \
+    database/db_blob_cleaner.cpp \
     base_synchronizer.cpp \
     command_line_parser.cpp \
-    dbus_object.cpp
+    dbus_object.cpp \
+    scheme_node_index.cpp
 
 HEADERS += \
     database/db_scheme.h \
@@ -47,11 +53,17 @@ HEADERS += \
 #    old/structure_synchronizer_base_2_1.h \
     server_protocol.h \
     log_synchronizer.h \
+    blob_synchronizer.h \
     structure_synchronizer.h \
     database/db_thread_manager.h \
+    database/db_log_thread_pool.h \
+    database/db_log_batch_writer.h \
+    database/db_log_value_rollup.h \
+    database/db_blob_cleaner.h \
     base_synchronizer.h \
     command_line_parser.h \
-    dbus_object.h
+    dbus_object.h \
+    scheme_node_index.h
 
 unix {
     target.path = /opt/das
@@ -20,8 +20,10 @@ Protocol::Protocol(Worker *work_object) :
     Protocol_Base{ work_object },
     is_copy_(false),
     disable_sync_(false),
+    log_pack_compression_(false),
     log_sync_(this),
-    structure_sync_(this)
+    structure_sync_(this),
+    blob_sync_(this)
 {
 }
 
@@ -31,6 +33,7 @@ Protocol::~Protocol()
     {
         std::cout << "~Protocol " << id() << " is copy: " << std::boolalpha << is_copy_ << std::endl;
 //        std::cout << "closed " << id() << " is copy: " << is_copy_ << std::endl;
+        work_object()->scheme_nodes_.remove(id(), this);
         work_object()->recently_connected_.disconnected(*this);
         set_connection_state(CS_DISCONNECTED_JUST_NOW);
     }
@@ -41,6 +44,16 @@ void Protocol::disable_sync()
     disable_sync_ = true;
 }
 
+bool Protocol::log_pack_compression() const
+{
+    return log_pack_compression_;
+}
+
+void Protocol::set_log_pack_compression(bool state)
+{
+    log_pack_compression_ = state;
+}
+
 Structure_Synchronizer* Protocol::structure_sync()
 {
     return &structure_sync_;
@@ -51,6 +64,11 @@ Log_Synchronizer *Protocol::log_sync()
     return &log_sync_;
 }
 
+Blob_Synchronizer *Protocol::blob_sync()
+{
+    return &blob_sync_;
+}
+
 int Protocol::protocol_version() const
 {
     return 205;
@@ -100,6 +118,8 @@ void Protocol::set_scheme_name(uint32_t user_id, const QString &name)
 
 void Protocol::closed()
 {
+    if (id())
+        work_object()->scheme_nodes_.remove(id(), this);
 }
 
 void Protocol::before_remove_copy()
@@ -212,6 +232,7 @@ void Protocol::auth(const Authentication_Info &info, bool modified, uint8_t msg_
     if (authenticated)
     {
         work_object()->server_thread_->server()->remove_copy(this);
+        work_object()->scheme_nodes_.add(id(), this, std::dynamic_pointer_cast<Helpz::DTLS::Server_Node>(writer()));
 
         work_object()->save_connection_state_to_log(id(), std::chrono::system_clock::now(), /*state=*/true);
 
@@ -229,6 +250,7 @@ void Protocol::auth(const Authentication_Info &info, bool modified, uint8_t msg_
         {
             structure_sync_.check(modified);
             log_sync_.check();
+            blob_sync_.resume();
         }
 
         if (!work_object()->recently_connected_.remove(id()))
@@ -6,6 +6,7 @@
 #include <plus/das/authentication_info.h>
 
 #include "log_synchronizer.h"
+#include "blob_synchronizer.h"
 #include "structure_synchronizer.h"
 #include "server_protocol_base.h"
 
@@ -23,8 +24,12 @@ public:
 
     void disable_sync();
 
+    bool log_pack_compression() const;
+    void set_log_pack_compression(bool state);
+
     Structure_Synchronizer* structure_sync();
     Log_Synchronizer* log_sync();
+    Blob_Synchronizer* blob_sync();
 
     int protocol_version() const override;
     void send_file(uint32_t user_id, uint32_t dev_item_id, const QString& file_name, const QString& file_path) override;
@@ -50,9 +55,10 @@ private:
     void stream_param(uint32_t dev_item_id, const QByteArray& data);
     void stream_data(uint32_t dev_item_id, const QByteArray& data);
 
-    bool is_copy_, disable_sync_;
+    bool is_copy_, disable_sync_, log_pack_compression_;
     Log_Synchronizer log_sync_;
     Structure_Synchronizer structure_sync_;
+    Blob_Synchronizer blob_sync_;
 
     std::chrono::system_clock::time_point last_sync_time_;
 };
@@ -7,6 +7,7 @@
 #include <Das/db/translation.h>
 
 #include <plus/das/database_delete_info.h>
+#include <plus/das/structure_hash_cache.h>
 
 #include "server.h"
 #include "server_protocol.h"
@@ -687,12 +688,14 @@ void Structure_Synchronizer::process_scheme_data(uint8_t struct_type, QIODevice*
         qWarning(Struct_Log) << "process_scheme_data unknown type: " << int(struct_type) << scheme_info.ids_to_sql();
         return;
     }
+    Ver::Structure_Hash_Cache::instance().invalidate(scheme_info.id(), struct_type);
     set_synchronized(struct_type);
 }
 
 bool Structure_Synchronizer::remove_scheme_rows(Base& db, uint8_t struct_type, const QVector<uint32_t>& delete_vect)
 {
     const Scheme_Info scheme_info = get_scheme_info(struct_type);
+    Ver::Structure_Hash_Cache::instance().invalidate(scheme_info.id(), struct_type);
 
     switch (struct_type)
     {
@@ -16,6 +16,9 @@
 #include <Helpz/settingshelper.h>
 #include <Helpz/dtls_tools.h>
 
+#include <Das/blob_store.h>
+#include <plus/das/structure_hash_cache.h>
+
 //--------
 //#include <Helpz/db_connection_info.h>
 //#include <Helpz/dtls_server_thread.h>
@@ -24,6 +27,8 @@
 //#include "dbus_object.h"
 
 #include "database/db_thread_manager.h"
+#include "database/db_log_value_rollup.h"
+#include "database/db_blob_cleaner.h"
 #include "dbus_object.h"
 #include "worker.h"
 
@@ -40,6 +45,8 @@ Worker::Worker(QObject *parent) :
     cl_parser_(this),
     db_conn_info_(nullptr),
     db_thread_mng_(nullptr),
+    rollup_mng_(nullptr),
+    blob_cleaner_(nullptr),
     server_thread_(nullptr),
     dbus_(nullptr)
 {
@@ -71,6 +78,8 @@ Worker::~Worker()
     server_thread_ = nullptr;
 
     delete db_thread_mng_;
+    delete rollup_mng_;
+    delete blob_cleaner_;
     delete db_conn_info_; db_conn_info = nullptr;
 
     for (const Recently_Connected::Recent_Client& item: recently_connected_.scheme_id_vect_)
@@ -103,6 +112,14 @@ void Worker::init_logging(QSettings *s)
 
 void Worker::on_timer()
 {
+    if (rollup_mng_)
+        rollup_mng_->compact();
+
+    if (blob_cleaner_)
+        blob_cleaner_->clean();
+
+    check_log_queue();
+
     auto now = std::chrono::system_clock::now();
 
     std::lock_guard lock(recently_connected_.mutex_);
@@ -119,22 +136,29 @@ void Worker::on_timer()
     }), recently_connected_.scheme_id_vect_.end());
 }
 
+void Worker::check_log_queue()
+{
+    const std::vector<DB::Log_Thread_Pool::Stats> stats = db_thread_mng_->log_pool()->stats(/*reset_max=*/true);
+    for (std::size_t i = 0; i < stats.size(); ++i)
+    {
+        const DB::Log_Thread_Pool::Stats& item = stats.at(i);
+        if (log_queue_warning_size_ > 0 && item.max_queue_size_ >= static_cast<std::size_t>(log_queue_warning_size_))
+            qWarning() << "Log thread" << i << "queue size" << item.queue_size_ << "max" << item.max_queue_size_
+                       << "done" << item.done_count_;
+    }
+}
+
 std::shared_ptr<Helpz::DTLS::Server_Node> Worker::find_client(uint32_t scheme_id) const
 {
-    return dbus_->find_client(scheme_id);
+    return scheme_nodes_.find(scheme_id);
 }
 
 std::future<std::shared_ptr<Helpz::DTLS::Server_Node>> Worker::find_client_future(uint32_t scheme_id)
 {
-    auto promise = std::make_shared<std::promise<std::shared_ptr<Helpz::DTLS::Server_Node>>>();
-    auto future = promise->get_future();
-
-    server_thread_->io_context()->post([=]()
-    {
-        promise->set_value(dbus_->find_client(scheme_id));
-    });
-
-    return future;
+    // Index is safe to read from any thread, so it isn't posted to server thread anymore
+    std::promise<std::shared_ptr<Helpz::DTLS::Server_Node>> promise;
+    promise.set_value(scheme_nodes_.find(scheme_id));
+    return promise.get_future();
 }
 
 void Worker::save_connection_state_to_log(uint32_t scheme_id, const std::chrono::system_clock::time_point &time_point, bool state)
@@ -148,7 +172,7 @@ void Worker::save_connection_state_to_log(uint32_t scheme_id, const std::chrono:
 
     auto values = Log_Event_Item::to_variantlist(item);
 
-    db_thread_mng_->log_thread()->add([values](Helpz::DB::Base* db)
+    db_thread_mng_->log_pool()->add(scheme_id, [values](Helpz::DB::Base* db)
     {
         db->insert(Helpz::DB::db_table<Log_Event_Item>(), values);
     });
@@ -170,15 +194,49 @@ void Worker::init_database(QSettings* s)
     db_conn_info = db_conn_info_;
     Helpz::DB::Connection_Info::set_common(*db_conn_info_);
 
-    db_thread_mng_ = new DB::Thread_Manager{*db_conn_info_};
+    auto [log_thread_count, log_queue_warning_size] = Helpz::SettingsHelper{s, "LogIngest",
+            Helpz::Param{"ThreadCount", 4},
+            Helpz::Param{"QueueWarningSize", 1000}
+    }();
+    log_queue_warning_size_ = log_queue_warning_size;
+
+    db_thread_mng_ = new DB::Thread_Manager{*db_conn_info_, static_cast<std::size_t>(log_thread_count)};
+
+    auto [is_rollup_enabled, minute_keep_days, hour_keep_days, backfill_hours_per_tick] = Helpz::SettingsHelper{s, "Rollup",
+            Helpz::Param{"Enabled", true},
+            Helpz::Param{"MinuteKeepDays", 31},
+            Helpz::Param{"HourKeepDays", 366},
+            Helpz::Param{"BackfillHoursPerTick", 6}
+    }();
+
+    if (is_rollup_enabled)
+    {
+        DB::Log_Value_Rollup_Manager::Config config;
+        config.minute_keep_days_ = minute_keep_days;
+        config.hour_keep_days_ = hour_keep_days;
+        config.backfill_hours_per_tick_ = backfill_hours_per_tick;
+        rollup_mng_ = new DB::Log_Value_Rollup_Manager{db_thread_mng_->thread(), config};
+    }
 }
 
 void Worker::init_server(QSettings* s)
 {
-    auto [disconnect_event_timeout] = Helpz::SettingsHelper{s, "Server",
-                Helpz::Param{"DisconnectEventTimeoutSeconds", 60}
+    auto [disconnect_event_timeout, structure_hash_cache_seconds] = Helpz::SettingsHelper{s, "Server",
+                Helpz::Param{"DisconnectEventTimeoutSeconds", 60},
+                // Structure tables is also changed by web interface, which doesn't invalidate server cache,
+                // so cache is disabled by default. Enable only if structure is changed through server.
+                Helpz::Param{"StructureHashCacheSeconds", 0}
     }();
     disconnect_event_timeout_ = std::chrono::seconds{disconnect_event_timeout};
+    Ver::Structure_Hash_Cache::instance().set_max_age(std::chrono::seconds{structure_hash_cache_seconds});
+
+    auto [blob_path, blob_keep_days] = Helpz::SettingsHelper{s, "Blob",
+                Helpz::Param<QString>{"Path", QString()}, // Empty path disables blob store
+                Helpz::Param<int>{"KeepDays", 365} // Days after last reference by scheme, 0 disables cleaning
+    }();
+    Blob_Store::instance().set_path(blob_path);
+    if (!blob_path.isEmpty() && blob_keep_days > 0)
+        blob_cleaner_ = new DB::Blob_Cleaner{db_thread_mng_->thread(), blob_keep_days};
 
     Helpz::DTLS::Create_Server_Protocol_Func_T create_protocol = [this](const std::vector<std::string> &client_protos, std::string* choose_out) -> std::shared_ptr<Helpz::Net::Protocol>
     {
@@ -190,10 +248,17 @@ void Worker::init_server(QSettings* s)
 
             const std::string& ver_str = proto_arr.back();
 
-            if (ver_str == "2.6")
+            // Blob references is sent since 2.8, so without blob store scheme must use older version
+            if (ver_str == "2.8" && !Blob_Store::instance().is_enabled())
+                continue;
+
+            if (ver_str == "2.8" || ver_str == "2.7" || ver_str == "2.6")
             {
                 *choose_out = proto;
-                return std::make_shared<Ver::Server::Protocol>(this);
+                auto ptr = std::make_shared<Ver::Server::Protocol>(this);
+                ptr->set_log_pack_compression(ver_str != "2.6"); // Log packs is compressed since 2.7
+                ptr->blob_sync()->set_enabled(ver_str == "2.8");
+                return ptr;
             }
             else if (ver_str == "2.5")
             {
@@ -255,6 +320,7 @@ void Worker::init_dbus(QSettings* s)
                 Helpz::Param{"Service", DAS_DBUS_DEFAULT_SERVICE_SERVER},
                 Helpz::Param{"Object", DAS_DBUS_DEFAULT_OBJECT}
                 ).ptr<Dbus_Object>();
+    dbus_->set_node_index(&scheme_nodes_);
 }
 
 } // namespace Server
@@ -11,6 +11,7 @@
 #include <plus/das/scheme_info.h>
 
 #include "command_line_parser.h"
+#include "scheme_node_index.h"
 //#include "server.h"
 //#include "work_object.h"
 
@@ -32,6 +33,8 @@ namespace Das {
 
 namespace DB {
 class Thread_Manager;
+class Log_Value_Rollup_Manager;
+class Blob_Cleaner;
 } // namespace DB
 
 namespace Server {
@@ -61,12 +64,14 @@ public slots:
 private slots:
     void on_timer();
 private:
+    void check_log_queue();
 
     void init_database(QSettings *s);
     void init_server(QSettings *s);
     void init_dbus(QSettings* s);
 
     std::chrono::seconds disconnect_event_timeout_;
+    int log_queue_warning_size_;
 
     Command_Line_Parser cl_parser_;
 
@@ -76,6 +81,8 @@ public:
     Helpz::DB::Connection_Info* db_conn_info_;
 
     DB::Thread_Manager* db_thread_mng_;
+    DB::Log_Value_Rollup_Manager* rollup_mng_;
+    DB::Blob_Cleaner* blob_cleaner_;
 
     Helpz::DTLS::Server_Thread* server_thread_;
 
@@ -114,6 +121,8 @@ public:
 
     } recently_connected_;
 
+    Scheme_Node_Index scheme_nodes_;
+
     Dbus_Object* dbus_;
 };
 
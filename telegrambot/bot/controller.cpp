@@ -28,6 +28,7 @@
 #include "db/tg_user.h"
 #include "db/tg_chat.h"
 #include "db/tg_subscriber.h"
+#include "informer_cache.h"
 
 #include "user_menu/connection_state.h"
 #include "elements.h"
@@ -259,6 +260,8 @@ void Controller::anyMessage(TgBot::Message::Ptr message)
 
                 field_name = db_table<DB::Tg_Chat>().field_names().at(DB::Tg_Chat::COL_id);
                 db.del(db_table_name<DB::Tg_Chat>(), field_name + '=' + QString::number(message->chat->id));
+
+                Informer_Cache::instance().invalidate_subscribers();
             }
         }
     }
@@ -467,6 +470,7 @@ string Controller::process_directory(uint32_t user_id, TgBot::Message::Ptr messa
             if (!db.del(Tg_Subscriber::table_name(), "id=" + q.value(1).toString()).isActive())
                 throw std::runtime_error("Failed remove subscriber");
         }
+        Informer_Cache::instance().invalidate_subscribers();
 
         inform_onoff(user_id, message->chat, message);
     }
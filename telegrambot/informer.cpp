@@ -4,9 +4,7 @@
 
 #include <Helpz/db_builder.h>
 
-#include <Das/db/disabled_status.h>
-
-#include "db/tg_subscriber.h"
+#include "informer_cache.h"
 #include "informer.h"
 
 namespace Das {
@@ -32,11 +30,13 @@ Informer::Status::Status(const Scheme_Info &scheme, std::chrono::time_point<std:
 
 // ---------------------------------------------------------------------------
 
-Informer::Informer(bool skip_connected_event, int event_timeout_secs) :
+Informer::Informer(bool skip_connected_event, int event_timeout_secs, int cache_timeout_secs) :
     break_flag_(false),
     skip_connected_event_(skip_connected_event),
     event_timeout_(event_timeout_secs)
 {
+    Informer_Cache::instance().set_max_age(std::chrono::seconds{cache_timeout_secs});
+
     thread_ = new std::thread(&Informer::run, this);
 }
 
@@ -132,26 +132,22 @@ void Informer::send_event_messages(const Scheme_Info &scheme, const QVector<Log_
     if (text.isEmpty())
         return;
 
-    const std::string scheme_title = get_scheme_title(scheme.id());
+    Informer_Cache& cache = Informer_Cache::instance();
+    const std::string scheme_title = cache.get_scheme_title(scheme.id());
     if (scheme_title.empty())
     {
         qCCritical(Inf_log) << "Can't get scheme name for id:" << scheme.id() << "events lost:" << qPrintable(text);
         return;
     }
 
-    Base& db = Base::get_thread_local_instance();
-    QVector<Tg_Subscriber> subscribers = db_build_list<Tg_Subscriber>(db, scheme.scheme_groups(), {},
-                                                                      Tg_Subscriber::COL_group_id);
-    if (subscribers.empty())
+    const std::set<int64_t> chat_set = cache.get_subscriber_chats(scheme);
+    if (chat_set.empty())
         return;
 
     const std::string data = '*' + scheme_title + "*\n" + text.toStdString();
 
-    for (Tg_Subscriber subscriber: subscribers)
-    {
-        if (subscriber.chat_id())
-            send_message_signal_(subscriber.chat_id(), data);
-    }
+    for (int64_t chat_id: chat_set)
+        send_message_signal_(chat_id, data);
 }
 
 void Informer::add_connection_state(std::shared_ptr<Informer::Connection_State_Item> &&item_ptr)
@@ -367,36 +363,9 @@ std::shared_ptr<Informer::Item> Informer::pop_data()
 
 std::set<int64_t> Informer::get_disabled_chats(uint32_t status_type_id, uint32_t dig_id, const Scheme_Info &scheme)
 {
-    Base& db = Base::get_thread_local_instance();
-
-    const QString where_tpl = "WHERE status_id = %1 AND %2 AND (dig_id IS NULL OR dig_id = %3)";
-    QString sql = where_tpl.arg(status_type_id).arg(scheme.ids_to_sql()).arg(dig_id);
-    auto disabled_statuses = db_build_list<Das::DB::Disabled_Status>(db, sql);
-    if (disabled_statuses.empty())
-        return {};
-
-    sql = R"sql(
-SELECT tgc.id FROM das_tg_chat tgc
-LEFT JOIN das_tg_user tgu ON tgu.id = tgc.admin_id
-LEFT JOIN das_user_groups ug ON ug.user_id = tgu.user_id
-WHERE ug.group_id IN ()sql";
-
-    for (const Das::DB::Disabled_Status& disabled: disabled_statuses)
-    {
-        if (!disabled.group_id())
-            throw 0; // Disabled for all chats
-
-        sql += QString::number(disabled.group_id());
-        sql += ',';
-    }
-
-    sql.replace(sql.size() - 1, 1, QChar(')'));
-
-    QSqlQuery q = db.exec(sql.arg(status_type_id));
-
     std::set<int64_t> disabled_chats;
-    while (q.next())
-        disabled_chats.insert(q.value(0).toLongLong());
+    if (!Informer_Cache::instance().get_disabled_chats(status_type_id, dig_id, scheme, disabled_chats))
+        throw 0; // Disabled for all chats
     return disabled_chats;
 }
 
@@ -475,20 +444,14 @@ Informer::Prepared_Data &Informer::get_prepared_data(const Scheme_Info &scheme)
     auto it = prepared_data_map_.find(scheme.id());
     if (it == prepared_data_map_.end())
     {
-        Base& db = Base::get_thread_local_instance();
-        QVector<Tg_Subscriber> subscribers = db_build_list<Tg_Subscriber>(db, scheme.scheme_groups(), {},
-                                                                          Tg_Subscriber::COL_group_id);
-        if (subscribers.empty())
-            throw 0;
+        Informer_Cache& cache = Informer_Cache::instance();
 
         Prepared_Data p_data;
-        for (const Tg_Subscriber& ts: subscribers)
-            if (ts.chat_id())
-                p_data.chat_set_.insert(ts.chat_id());
+        p_data.chat_set_ = cache.get_subscriber_chats(scheme);
         if (p_data.chat_set_.empty())
             throw 0;
 
-        const std::string scheme_title = get_scheme_title(scheme.id());
+        const std::string scheme_title = cache.get_scheme_title(scheme.id());
         if (scheme_title.empty())
             throw std::runtime_error("Can't get scheme name for id: " + std::to_string(scheme.id()));
         p_data.title_ = '*' + scheme_title + '*';
@@ -499,20 +462,6 @@ Informer::Prepared_Data &Informer::get_prepared_data(const Scheme_Info &scheme)
     return it->second;
 }
 
-std::string Informer::get_scheme_title(uint32_t scheme_id)
-{
-    QString title;
-    Base& db = Base::get_thread_local_instance();
-    QSqlQuery q = db.select({"das_scheme", {}, {"title", "name"}}, "WHERE id=" + QString::number(scheme_id));
-    if (q.next())
-    {
-        title = q.value(0).toString();
-        if (title.isEmpty())
-            title = q.value(1).toString();
-    }
-    return title.toStdString();
-}
-
 std::vector<Informer::Prepared_Status> Informer::get_prepared_statuses(Status *data) const
 {
     if (data->add_vect_.empty()
@@ -26,7 +26,7 @@ Q_DECLARE_LOGGING_CATEGORY(Inf_Detail_log)
 class Informer : public Status_Helper
 {
 public:
-    Informer(bool skip_connected_event, int event_timeout_secs);
+    Informer(bool skip_connected_event, int event_timeout_secs, int cache_timeout_secs);
     ~Informer();
 
     boost::signals2::signal<void (int64_t, const std::string&)> send_message_signal_;
@@ -98,7 +98,6 @@ private:
     void process_data(Item* data);
     void add_prepared_status_data(Status* data);
     Prepared_Data& get_prepared_data(const Scheme_Info& scheme);
-    std::string get_scheme_title(uint32_t scheme_id);
     std::vector<Prepared_Status> get_prepared_statuses(Status* data) const;
     void send_message(const std::map<uint32_t, Prepared_Data>& prepared_data_map);
 
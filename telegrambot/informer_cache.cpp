@@ -0,0 +1,238 @@
+#include <QSqlQuery>
+
+#include <Helpz/db_builder.h>
+
+#include "db/tg_subscriber.h"
+#include "informer_cache.h"
+
+namespace Das {
+
+using namespace Helpz::DB;
+
+/*static*/ Informer_Cache &Informer_Cache::instance()
+{
+    static Informer_Cache cache;
+    return cache;
+}
+
+Informer_Cache::Informer_Cache() :
+    max_age_(0),
+    is_group_chats_loaded_(false),
+    subscribers_version_(0)
+{
+}
+
+void Informer_Cache::set_max_age(std::chrono::seconds max_age)
+{
+    std::lock_guard lock(mutex_);
+    max_age_ = max_age;
+    if (max_age_.count() <= 0)
+    {
+        title_map_.clear();
+        subscriber_map_.clear();
+        disabled_status_map_.clear();
+        is_group_chats_loaded_ = false;
+    }
+}
+
+std::string Informer_Cache::get_scheme_title(uint32_t scheme_id)
+{
+    std::string title;
+    {
+        std::lock_guard lock(mutex_);
+        if (get_actual(title_map_, scheme_id, title) && !title.empty())
+            return title;
+    }
+
+    if (load_scheme_title(scheme_id, title) && !title.empty())
+    {
+        std::lock_guard lock(mutex_);
+        set_entry(title_map_, scheme_id, title);
+    }
+    return title;
+}
+
+std::set<int64_t> Informer_Cache::get_subscriber_chats(const Scheme_Info &scheme)
+{
+    std::set<int64_t> chat_set;
+    uint64_t version;
+    {
+        std::lock_guard lock(mutex_);
+        if (get_actual(subscriber_map_, scheme.scheme_groups(), chat_set))
+            return chat_set;
+        version = subscribers_version_;
+    }
+
+    if (load_subscriber_chats(scheme, chat_set))
+    {
+        std::lock_guard lock(mutex_);
+        if (version == subscribers_version_)
+            set_entry(subscriber_map_, scheme.scheme_groups(), chat_set);
+    }
+    return chat_set;
+}
+
+bool Informer_Cache::get_disabled_chats(uint32_t status_type_id, uint32_t dig_id, const Scheme_Info &scheme, std::set<int64_t> &disabled_chats)
+{
+    QVector<DB::Disabled_Status> disabled_statuses;
+    bool is_cached;
+    {
+        std::lock_guard lock(mutex_);
+        is_cached = get_actual(disabled_status_map_, scheme.ids_to_sql(), disabled_statuses);
+    }
+
+    if (!is_cached && load_disabled_statuses(scheme, disabled_statuses))
+    {
+        std::lock_guard lock(mutex_);
+        set_entry(disabled_status_map_, scheme.ids_to_sql(), disabled_statuses);
+    }
+
+    std::set<uint32_t> group_set;
+    for (const DB::Disabled_Status& disabled: disabled_statuses)
+    {
+        if (disabled.status_id() != status_type_id
+            || (disabled.dig_id() && disabled.dig_id() != dig_id))
+            continue;
+
+        if (!disabled.group_id())
+            return false;
+        group_set.insert(disabled.group_id());
+    }
+
+    if (group_set.empty())
+        return true;
+
+    const std::map<uint32_t, std::set<int64_t>> group_chats = get_group_chats();
+    for (uint32_t group_id: group_set)
+    {
+        auto it = group_chats.find(group_id);
+        if (it != group_chats.cend())
+            disabled_chats.insert(it->second.cbegin(), it->second.cend());
+    }
+    return true;
+}
+
+void Informer_Cache::invalidate_subscribers()
+{
+    std::lock_guard lock(mutex_);
+    subscriber_map_.clear();
+    is_group_chats_loaded_ = false;
+    ++subscribers_version_;
+}
+
+template<typename Map, typename Key, typename T>
+bool Informer_Cache::get_actual(const Map &map, const Key &key, T &data) const
+{
+    if (max_age_.count() <= 0)
+        return false;
+
+    auto it = map.find(key);
+    if (it == map.cend() || !is_actual(it->second.time_))
+        return false;
+
+    data = it->second.data_;
+    return true;
+}
+
+template<typename Map, typename Key, typename T>
+void Informer_Cache::set_entry(Map &map, const Key &key, const T &data)
+{
+    if (max_age_.count() > 0)
+        map[key] = typename Map::mapped_type{data, Clock::now()};
+}
+
+bool Informer_Cache::is_actual(Clock::time_point time) const
+{
+    return time != Clock::time_point{} && Clock::now() - time < max_age_;
+}
+
+std::map<uint32_t, std::set<int64_t>> Informer_Cache::get_group_chats()
+{
+    uint64_t version;
+    {
+        std::lock_guard lock(mutex_);
+        if (max_age_.count() > 0 && is_group_chats_loaded_ && is_actual(group_chats_.time_))
+            return group_chats_.data_;
+        version = subscribers_version_;
+    }
+
+    std::map<uint32_t, std::set<int64_t>> group_chats;
+    if (load_group_chats(group_chats))
+    {
+        std::lock_guard lock(mutex_);
+        if (max_age_.count() > 0 && version == subscribers_version_)
+        {
+            group_chats_.data_ = group_chats;
+            group_chats_.time_ = Clock::now();
+            is_group_chats_loaded_ = true;
+        }
+    }
+    return group_chats;
+}
+
+bool Informer_Cache::load_scheme_title(uint32_t scheme_id, std::string& title) const
+{
+    Base& db = Base::get_thread_local_instance();
+    QSqlQuery q = db.select({"das_scheme", {}, {"title", "name"}}, "WHERE id=" + QString::number(scheme_id));
+    if (!q.isActive())
+        return false;
+
+    if (q.next())
+    {
+        QString text = q.value(0).toString();
+        if (text.isEmpty())
+            text = q.value(1).toString();
+        title = text.toStdString();
+    }
+    return true;
+}
+
+bool Informer_Cache::load_subscriber_chats(const Scheme_Info &scheme, std::set<int64_t>& chat_set) const
+{
+    if (scheme.scheme_groups().empty())
+        return true;
+
+    Base& db = Base::get_thread_local_instance();
+    QSqlQuery q = db.select({db_table_name<Tg_Subscriber>(), {}, {"chat_id"}},
+                            "WHERE " + get_db_field_in_sql("group_id", scheme.scheme_groups()));
+    if (!q.isActive())
+        return false;
+
+    while (q.next())
+        if (q.value(0).toLongLong())
+            chat_set.insert(q.value(0).toLongLong());
+    return true;
+}
+
+bool Informer_Cache::load_disabled_statuses(const Scheme_Info &scheme, QVector<DB::Disabled_Status>& statuses) const
+{
+    Base& db = Base::get_thread_local_instance();
+    QSqlQuery q = db.select({db_table_name<DB::Disabled_Status>(), {}, {"group_id", "dig_id", "status_id"}},
+                            "WHERE " + scheme.ids_to_sql());
+    if (!q.isActive())
+        return false;
+
+    while (q.next())
+        statuses.push_back(DB::Disabled_Status(0, q.value(0).toUInt(), q.value(1).toUInt(), q.value(2).toUInt()));
+    return true;
+}
+
+bool Informer_Cache::load_group_chats(std::map<uint32_t, std::set<int64_t>>& group_chats) const
+{
+    const QString sql = R"sql(
+SELECT ug.group_id, tgc.id FROM das_tg_chat tgc
+LEFT JOIN das_tg_user tgu ON tgu.id = tgc.admin_id
+LEFT JOIN das_user_groups ug ON ug.user_id = tgu.user_id
+WHERE ug.group_id IS NOT NULL)sql";
+
+    Base& db = Base::get_thread_local_instance();
+    QSqlQuery q = db.exec(sql);
+    if (!q.isActive())
+        return false;
+
+    while (q.next())
+        group_chats[q.value(0).toUInt()].insert(q.value(1).toLongLong());
+    return true;
+}
+
+} // namespace Das
@@ -0,0 +1,78 @@
+#ifndef DAS_INFORMER_CACHE_H
+#define DAS_INFORMER_CACHE_H
+
+#include <map>
+#include <set>
+#include <mutex>
+#include <chrono>
+#include <string>
+
+#include <QVector>
+
+#include <Das/db/disabled_status.h>
+#include <plus/das/scheme_info.h>
+
+namespace Das {
+
+// Keeps data used by informer to choose message recipients,
+// so status changes of many schemes don't request same rows from database.
+// Each entry is reloaded separately when it's older than max age.
+// Database is queried without lock and only successful results is cached.
+class Informer_Cache
+{
+public:
+    static Informer_Cache& instance();
+
+    // Zero max age disables cache
+    void set_max_age(std::chrono::seconds max_age);
+
+    std::string get_scheme_title(uint32_t scheme_id);
+    std::set<int64_t> get_subscriber_chats(const Scheme_Info& scheme);
+
+    // Return false if status is disabled for all chats
+    bool get_disabled_chats(uint32_t status_type_id, uint32_t dig_id, const Scheme_Info& scheme, std::set<int64_t>& disabled_chats);
+
+    void invalidate_subscribers();
+private:
+    Informer_Cache();
+
+    using Clock = std::chrono::steady_clock;
+
+    template<typename T>
+    struct Entry
+    {
+        T data_;
+        Clock::time_point time_;
+    };
+
+    // Must be called with locked mutex
+    template<typename Map, typename Key, typename T>
+    bool get_actual(const Map& map, const Key& key, T& data) const;
+    template<typename Map, typename Key, typename T>
+    void set_entry(Map& map, const Key& key, const T& data);
+    bool is_actual(Clock::time_point time) const;
+
+    std::map<uint32_t, std::set<int64_t>> get_group_chats();
+
+    bool load_scheme_title(uint32_t scheme_id, std::string& title) const;
+    bool load_subscriber_chats(const Scheme_Info& scheme, std::set<int64_t>& chat_set) const;
+    bool load_disabled_statuses(const Scheme_Info& scheme, QVector<DB::Disabled_Status>& statuses) const;
+    bool load_group_chats(std::map<uint32_t, std::set<int64_t>>& group_chats) const;
+
+    std::chrono::seconds max_age_;
+
+    std::map<uint32_t, Entry<std::string>> title_map_;
+    std::map<std::set<uint32_t>, Entry<std::set<int64_t>>> subscriber_map_; // By scheme groups
+    std::map<QString, Entry<QVector<DB::Disabled_Status>>> disabled_status_map_; // By scheme ids sql
+    Entry<std::map<uint32_t, std::set<int64_t>>> group_chats_; // User group to chats which admin is in it
+    bool is_group_chats_loaded_;
+
+    // Incremented by invalidate, so result loaded before it isn't cached
+    uint64_t subscribers_version_;
+
+    std::mutex mutex_;
+};
+
+} // namespace Das
+
+#endif // DAS_INFORMER_CACHE_H
@@ -37,6 +37,7 @@ SOURCES += main.cpp \
     db/tg_user.cpp \
     worker.cpp \
     informer.cpp \
+    informer_cache.cpp \
     smtp_client.cpp \
     dbus_handler.cpp \
     bot/scheme_item.cpp \
@@ -62,6 +63,7 @@ HEADERS += \
     db/tg_user.h \
     worker.h \
     informer.h \
+    informer_cache.h \
     smtp_client.h \
     dbus_handler.h \
     bot/scheme_item.h \
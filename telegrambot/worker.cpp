@@ -120,7 +120,8 @@ void Worker::init_informer(QSettings* s)
     informer_ = Helpz::SettingsHelper(
         s, "Informer",
         Helpz::Param<bool>{"SkipConnectedEvent", false},
-        Helpz::Param<int>{"EventTimeoutSecons", 10 * 60}
+        Helpz::Param<int>{"EventTimeoutSecons", 10 * 60},
+        Helpz::Param<int>{"CacheTimeoutSeconds", 5 * 60}
         ).ptr<Informer>();
 
     using namespace boost::placeholders;
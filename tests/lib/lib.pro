@@ -9,6 +9,7 @@ CONFIG -= app_bundle
 TEMPLATE = app
 
 SOURCES += tst_libtest.cpp
+INCLUDEPATH += $$PWD/../../webapi
 DEFINES += SRCDIR=\\\"$$PWD/\\\"
 
 DESTDIR = $${OUT_PWD}/../..
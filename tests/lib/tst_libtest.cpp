@@ -4,8 +4,13 @@
 #include <QSignalSpy>
 
 #include "Das/proto_scheme.h"
+#include "Das/scheme.h"
+#include "Das/device.h"
+#include "Das/db/device_item_value.h"
+#include "Das/log/log_pack_codec.h"
 #include <plus/das/database_delete_info.h>
 #include <plus/das/structure_synchronizer_base.h>
+#include <rest/rest_chart_downsampler.h>
 
 namespace Das
 {
@@ -40,6 +45,140 @@ private Q_SLOTS:
         QCOMPARE(DB::has_scheme_id<Auth_Group_Permission>(), false);
     }
 
+    void variant_from_string_test()
+    {
+        using T = Device_Item_Value;
+        QCOMPARE(T::variant_from_string(QString()), QVariant());
+        QCOMPARE(T::variant_from_string("42"), QVariant(42));
+        QCOMPARE(T::variant_from_string("-7"), QVariant(-7));
+        QCOMPARE(T::variant_from_string("042"), QVariant(42.));
+        QCOMPARE(T::variant_from_string("+5"), QVariant(5.));
+        QCOMPARE(T::variant_from_string("2147483648"), QVariant(2147483648.));
+        QCOMPARE(T::variant_from_string("1.5"), QVariant(1.5));
+        QCOMPARE(T::variant_from_string("1,5"), QVariant(1.5));
+        QCOMPARE(T::variant_from_string("True"), QVariant(true));
+        QCOMPARE(T::variant_from_string("false"), QVariant(false));
+        QCOMPARE(T::variant_from_string("[1,2]"), QVariant(QVariantList{1., 2.}));
+        QCOMPARE(T::variant_from_string("[1,2"), QVariant("[1,2"));
+        QCOMPARE(T::variant_from_string("base64:AQI="), QVariant(QByteArray("\x01\x02")));
+        QCOMPARE(T::variant_from_string("text"), QVariant("text"));
+        QCOMPARE(T::prepare_value(true), QVariant(true)); // Driver saves it as 1
+        QCOMPARE(T::variant_from_string("1"), QVariant(1));
+    }
+
+    void log_pack_codec_test()
+    {
+        const int dsver = QDataStream::Qt_5_12;
+        const QVector<Log_Value_Item> pack{
+            {1600000000500, 3, 17, 5, 5, true},
+            {1600000000400, 0, 12, QVariant(), 2.5, false},
+            {1600000000900, 0, 100000, "text", QVariant(true), true},
+            {1600000001000, 1, 1, QByteArray("\x01\x02"), QVariant(-7), false},
+        };
+
+        QVector<Log_Value_Item> decoded;
+        QVERIFY(Log_Pack_Codec::decode(Log_Pack_Codec::encode(pack, dsver), decoded, dsver));
+        QCOMPARE(decoded.size(), pack.size());
+        for (int i = 0; i < pack.size(); ++i)
+        {
+            QCOMPARE(decoded.at(i).timestamp_msecs(), pack.at(i).timestamp_msecs());
+            QCOMPARE(decoded.at(i).flag(), pack.at(i).flag());
+            QCOMPARE(decoded.at(i).user_id(), pack.at(i).user_id());
+            QCOMPARE(decoded.at(i).item_id(), pack.at(i).item_id());
+            QCOMPARE(decoded.at(i).raw_value(), pack.at(i).raw_value());
+            QCOMPARE(decoded.at(i).value(), pack.at(i).value());
+        }
+
+        QVERIFY(!Log_Pack_Codec::decode(QByteArray("broken"), decoded, dsver));
+    }
+
+    // ---------- Chart_Downsampler ----------
+    using Downsampler = Rest::Chart_Downsampler<int>;
+
+    static std::vector<Downsampler::Point> downsample(Downsampler::Mode mode, const std::vector<std::pair<int64_t, double>>& points)
+    {
+        std::vector<Downsampler::Point> result;
+        Downsampler downsampler(mode, 0, 10, [&result](Downsampler::Point&& point) { result.push_back(std::move(point)); });
+        for (const std::pair<int64_t, double>& point: points)
+            downsampler.add(Downsampler::Point{point.first, point.second, true, false, 0});
+        downsampler.finish();
+        return result;
+    }
+
+    static std::vector<int64_t> times(const std::vector<Downsampler::Point>& points)
+    {
+        std::vector<int64_t> result;
+        for (const Downsampler::Point& point: points)
+            result.push_back(point._time);
+        return result;
+    }
+
+    void downsampler_mode_test()
+    {
+        Downsampler::Mode mode = Downsampler::M_LAST;
+        QVERIFY(Downsampler::mode_from_string("", mode));
+        QCOMPARE(mode, Downsampler::M_LTTB);
+        QVERIFY(Downsampler::mode_from_string("minmax", mode));
+        QCOMPARE(mode, Downsampler::M_MIN_MAX);
+        QVERIFY(!Downsampler::mode_from_string("median", mode));
+    }
+
+    void downsampler_lttb_test()
+    {
+        const auto result = downsample(Downsampler::M_LTTB, {
+            {0, 0}, {1, 1}, {2, 0},
+            {10, 0}, {11, 5}, {12, 0},
+            {20, 0}, {21, 0}
+        });
+        QCOMPARE(times(result), (std::vector<int64_t>{0, 1, 11, 20, 21}));
+    }
+
+    void downsampler_min_max_test()
+    {
+        const auto result = downsample(Downsampler::M_MIN_MAX, {
+            {0, 5}, {1, 1}, {2, 9}, {3, 4},
+            {10, 2}, {11, 2}
+        });
+        QCOMPARE(times(result), (std::vector<int64_t>{1, 2, 10}));
+        QCOMPARE(result.at(0)._value, 1.);
+        QCOMPARE(result.at(1)._value, 9.);
+    }
+
+    void downsampler_avg_test()
+    {
+        const auto result = downsample(Downsampler::M_AVG, {
+            {1, 5}, {2, 1}, {3, 9}, {4, 5},
+            {12, 2}
+        });
+        QCOMPARE(times(result), (std::vector<int64_t>{0, 10}));
+        QCOMPARE(result.at(0)._value, 5.);
+        QVERIFY(result.at(0)._is_aggregated);
+        QCOMPARE(result.at(1)._value, 2.);
+    }
+
+    void downsampler_last_test()
+    {
+        const auto result = downsample(Downsampler::M_LAST, {
+            {0, 5}, {1, 1}, {3, 4},
+            {10, 2}, {11, 7}
+        });
+        QCOMPARE(times(result), (std::vector<int64_t>{3, 11}));
+        QCOMPARE(result.at(1)._value, 7.);
+    }
+
+    void downsampler_not_number_order_test()
+    {
+        std::vector<Downsampler::Point> result;
+        Downsampler downsampler(Downsampler::M_LAST, 0, 10, [&result](Downsampler::Point&& point) { result.push_back(std::move(point)); });
+        downsampler.add(Downsampler::Point{1, 1, true, false, 0});
+        downsampler.add(Downsampler::Point{3, 0, false, false, 0});
+        downsampler.add(Downsampler::Point{5, 2, true, false, 0});
+        downsampler.add(Downsampler::Point{13, 0, false, false, 0});
+        downsampler.add(Downsampler::Point{15, 3, true, false, 0});
+        downsampler.finish();
+        QCOMPARE(times(result), (std::vector<int64_t>{3, 5, 13, 15}));
+    }
+
     // ---------- Proto_Scheme ----------
     void Proto_SchemeInit() {
 /*
@@ -144,6 +283,22 @@ private Q_SLOTS:
     // ---------- Group ----------
     // ---------- Group ----------
 
+    // ---------- Scheme ----------
+    void SchemeItemById() {
+        Scheme scheme;
+        Device* dev = scheme.add_device(Device{1});
+        dev->create_item(Device_Item{10});
+        dev->create_item(Device_Item{11});
+
+        QCOMPARE(scheme.dev_by_id(1), dev);
+        QCOMPARE(scheme.item_by_id(11), dev->items().at(1));
+        QVERIFY(scheme.item_by_id(12) == nullptr);
+
+        scheme.clear_devices();
+        QVERIFY(scheme.item_by_id(10) == nullptr);
+    }
+    // ---------- Scheme ----------
+
     // ---------- Section ----------
     void SectionIsAuto() {
 
@@ -5,6 +5,7 @@
 #include <QDBusReply>
 #include <QLoggingCategory>
 
+#include "rest/device_item_value_cache.h"
 #include "worker.h"
 
 #include "dbus_handler.h"
@@ -24,6 +25,22 @@ void Dbus_Handler::set_stream_param(const Scheme_Info& scheme, uint32_t dev_item
     worker_->stream_server_->set_param(scheme.id(), dev_item_id, data);
 }
 
+void Dbus_Handler::update_device_item_values(const Scheme_Info& scheme, const QVector<Log_Value_Item>& pack)
+{
+    Rest::Device_Item_Value_Cache::instance().update(scheme.id(), pack);
+}
+
+void Dbus_Handler::reset_device_item_values(const Scheme_Info& scheme, uint8_t /*connection_state*/)
+{
+    // After reconnect values is synchronized without value signals
+    Rest::Device_Item_Value_Cache::instance().invalidate(scheme.id());
+}
+
+void Dbus_Handler::reset_device_item_values_on_structure(const Scheme_Info& scheme, const QByteArray& /*data*/)
+{
+    Rest::Device_Item_Value_Cache::instance().invalidate(scheme.id());
+}
+
 void Dbus_Handler::connect_to(QDBusInterface *iface)
 {
 #define CONNECT_TO_(a,b,x,y,...) \
@@ -44,10 +61,19 @@ void Dbus_Handler::connect_to(QDBusInterface *iface)
     CONNECT_TO_WEBSOCK(stream_toggled, send_stream_toggled, uint32_t, uint32_t, bool);
     CONNECT_TO_WEBSOCK(stream_data, send_stream_data, uint32_t, QByteArray);
     CONNECT_TO_THIS(stream_param, set_stream_param, uint32_t, QByteArray);
+
+    CONNECT_TO_THIS(device_item_values_available, update_device_item_values, QVector<Log_Value_Item>);
+    CONNECT_TO_THIS(connection_state_changed, reset_device_item_values, uint8_t);
+    CONNECT_TO_THIS(structure_changed, reset_device_item_values_on_structure, QByteArray);
+
+    // Signals could be lost while server was unavailable
+    Rest::Device_Item_Value_Cache::instance().clear();
 }
 
 void Dbus_Handler::server_down()
 {
+    Rest::Device_Item_Value_Cache::instance().clear();
+
     QMetaObject::invokeMethod(worker_->websock_th_->ptr(), "send_connection_state", Qt::QueuedConnection,
                               Q_ARG(Scheme_Info, {}), Q_ARG(uint8_t, CS_SERVER_DOWN));
     // TODO: send CS_SERVER_DOWN state for all web sock
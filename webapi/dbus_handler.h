@@ -24,6 +24,10 @@ public:
 public slots:
 private slots:
     void set_stream_param(const Scheme_Info& scheme, uint32_t dev_item_id, const QByteArray& data);
+
+    void update_device_item_values(const Scheme_Info& scheme, const QVector<Log_Value_Item>& pack);
+    void reset_device_item_values(const Scheme_Info& scheme, uint8_t connection_state);
+    void reset_device_item_values_on_structure(const Scheme_Info& scheme, const QByteArray& data);
 private:
     void connect_to(QDBusInterface* iface) override;
     void server_down() override;
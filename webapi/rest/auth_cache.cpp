@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <mutex>
+
+#include "auth_cache.h"
+
+namespace Das {
+namespace Rest {
+
+namespace {
+
+template<typename Map, typename Key, typename T>
+bool find_entry(const Map& map, const Key& key, T& data)
+{
+    auto it = map.find(key);
+    if (it == map.cend() || it->second.expire_time_ <= std::chrono::system_clock::now())
+        return false;
+
+    data = it->second.data_;
+    return true;
+}
+
+template<typename Map, typename Pred>
+void remove_if(Map& map, Pred pred)
+{
+    for (auto it = map.begin(); it != map.end();)
+    {
+        if (pred(*it))
+            it = map.erase(it);
+        else
+            ++it;
+    }
+}
+
+} // namespace
+
+/*static*/ Auth_Cache &Auth_Cache::instance()
+{
+    static Auth_Cache cache;
+    return cache;
+}
+
+Auth_Cache::Auth_Cache() :
+    max_age_(0)
+{
+}
+
+void Auth_Cache::set_max_age(std::chrono::seconds max_age)
+{
+    std::unique_lock lock(mutex_);
+    max_age_ = max_age;
+    if (max_age_.count() <= 0)
+    {
+        token_map_.clear();
+        permission_map_.clear();
+        scheme_map_.clear();
+    }
+}
+
+bool Auth_Cache::get_token(const std::string &token, User &user) const
+{
+    std::shared_lock lock(mutex_);
+    return find_entry(token_map_, token, user);
+}
+
+void Auth_Cache::set_token(const std::string &token, const User &user, int64_t expire_time)
+{
+    const Clock::time_point now = Clock::now();
+
+    std::unique_lock lock(mutex_);
+    if (max_age_.count() <= 0)
+        return;
+
+    remove_expired(now);
+
+    const Clock::time_point token_expire_time = Clock::time_point{std::chrono::seconds{expire_time}};
+    const Clock::time_point max_time = now + max_age_;
+    token_map_[token] = Entry<User>{user, std::min(token_expire_time, max_time)};
+}
+
+bool Auth_Cache::get_permission(uint32_t user_id, const std::string &permission, bool &is_allowed) const
+{
+    std::shared_lock lock(mutex_);
+    return find_entry(permission_map_, std::make_pair(user_id, permission), is_allowed);
+}
+
+void Auth_Cache::set_permission(uint32_t user_id, const std::string &permission, bool is_allowed)
+{
+    const Clock::time_point now = Clock::now();
+
+    std::unique_lock lock(mutex_);
+    if (max_age_.count() <= 0)
+        return;
+
+    remove_expired(now);
+    permission_map_[std::make_pair(user_id, permission)] = Entry<bool>{is_allowed, now + max_age_};
+}
+
+bool Auth_Cache::get_scheme(uint32_t user_id, uint32_t scheme_id, Scheme_Info &scheme) const
+{
+    std::shared_lock lock(mutex_);
+    return find_entry(scheme_map_, std::make_pair(user_id, scheme_id), scheme);
+}
+
+void Auth_Cache::set_scheme(uint32_t user_id, uint32_t scheme_id, const Scheme_Info &scheme)
+{
+    const Clock::time_point now = Clock::now();
+
+    std::unique_lock lock(mutex_);
+    if (max_age_.count() <= 0)
+        return;
+
+    remove_expired(now);
+    scheme_map_[std::make_pair(user_id, scheme_id)] = Entry<Scheme_Info>{scheme, now + max_age_};
+}
+
+void Auth_Cache::invalidate_scheme(uint32_t scheme_id)
+{
+    std::unique_lock lock(mutex_);
+    remove_if(scheme_map_, [scheme_id](const auto& it) { return it.first.second == scheme_id; });
+}
+
+void Auth_Cache::check_version(Helpz::DB::Base& db)
+{
+    // Tables hasn't modification time, so version is count and checksum of rows which access depends on
+    auto table_version = [](const QString& table_name, const QString& field_names)
+    {
+        return "(SELECT CONCAT(COUNT(*), ':', COALESCE(SUM(CRC32(CONCAT_WS(':', " + field_names + "))), 0)) FROM "
+                + table_name + ')';
+    };
+
+    const QString sql = "SELECT CONCAT_WS(';', "
+            + table_version("das_user_groups", "user_id, group_id") + ", "
+            + table_version("auth_group_permissions", "group_id, permission_id") + ", "
+            + table_version("das_scheme_groups", "scheme_id, scheme_group_id") + ", "
+            + table_version("das_scheme_group_user", "group_id, user_id") + ", "
+            + table_version("das_scheme", "id, parent_id") + ')';
+
+    QSqlQuery q = db.exec(sql);
+    if (!q.next())
+        return;
+
+    const QString version = q.value(0).toString();
+
+    std::unique_lock lock(mutex_);
+    if (version_ == version)
+        return;
+
+    if (!version_.isEmpty())
+    {
+        permission_map_.clear();
+        scheme_map_.clear();
+    }
+    version_ = version;
+}
+
+void Auth_Cache::remove_expired(Clock::time_point now)
+{
+    if (now - last_clean_time_ < max_age_)
+        return;
+    last_clean_time_ = now;
+
+    auto is_expired = [now](const auto& it) { return it.second.expire_time_ <= now; };
+    remove_if(token_map_, is_expired);
+    remove_if(permission_map_, is_expired);
+    remove_if(scheme_map_, is_expired);
+}
+
+} // namespace Rest
+} // namespace Das
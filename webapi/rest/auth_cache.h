@@ -0,0 +1,75 @@
+#ifndef DAS_REST_AUTH_CACHE_H
+#define DAS_REST_AUTH_CACHE_H
+
+#include <map>
+#include <string>
+#include <chrono>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include <Helpz/db_base.h>
+
+#include <plus/das/scheme_info.h>
+
+#include "auth_middleware.h"
+
+namespace Das {
+namespace Rest {
+
+// Keeps verified tokens, user permissions and scheme access checks,
+// so they aren't requested from database on every REST call.
+// Entry is removed when it's older than max age. Scheme entries is also removed when scheme groups
+// is changed by REST. Users, groups and permissions is changed by site, so their tables is polled
+// by check_version and permission and scheme entries is removed when any of them is changed.
+// Tokens is kept: user groups of token is taken from the token itself.
+class Auth_Cache
+{
+public:
+    static Auth_Cache& instance();
+
+    // Zero max age disables cache
+    void set_max_age(std::chrono::seconds max_age);
+
+    bool get_token(const std::string& token, User& user) const;
+    // Token is kept not longer than it's expire time in seconds since epoch
+    void set_token(const std::string& token, const User& user, int64_t expire_time);
+
+    bool get_permission(uint32_t user_id, const std::string& permission, bool& is_allowed) const;
+    void set_permission(uint32_t user_id, const std::string& permission, bool is_allowed);
+
+    // Empty scheme info means user hasn't access to scheme
+    bool get_scheme(uint32_t user_id, uint32_t scheme_id, Scheme_Info& scheme) const;
+    void set_scheme(uint32_t user_id, uint32_t scheme_id, const Scheme_Info& scheme);
+
+    void invalidate_scheme(uint32_t scheme_id);
+
+    // Called periodically from database thread
+    void check_version(Helpz::DB::Base& db);
+private:
+    Auth_Cache();
+
+    using Clock = std::chrono::system_clock;
+
+    template<typename T>
+    struct Entry
+    {
+        T data_;
+        Clock::time_point expire_time_;
+    };
+
+    void remove_expired(Clock::time_point now);
+
+    std::chrono::seconds max_age_;
+    Clock::time_point last_clean_time_;
+    QString version_;
+
+    std::unordered_map<std::string, Entry<User>> token_map_;
+    std::map<std::pair<uint32_t, std::string>, Entry<bool>> permission_map_;
+    std::map<std::pair<uint32_t, uint32_t>, Entry<Scheme_Info>> scheme_map_;
+    mutable std::shared_mutex mutex_;
+};
+
+} // namespace Rest
+} // namespace Das
+
+#endif // DAS_REST_AUTH_CACHE_H
@@ -9,6 +9,7 @@
 
 #include <Helpz/db_base.h>
 
+#include "auth_cache.h"
 #include "auth_middleware.h"
 
 namespace Das {
@@ -19,6 +20,21 @@ thread_local User thread_local_user;
 /*static*/ const User& Auth_Middleware::get_thread_local_user() { return thread_local_user; }
 
 void Auth_Middleware::check_permission(const std::string &permission)
+{
+    const uint32_t user_id = get_thread_local_user().id_;
+
+    bool is_allowed = false;
+    if (!Auth_Cache::instance().get_permission(user_id, permission, is_allowed)
+        && load_permission(user_id, permission, is_allowed))
+    {
+        Auth_Cache::instance().set_permission(user_id, permission, is_allowed);
+    }
+
+    if (!is_allowed)
+        throw served::request_error(served::status_4XX::FORBIDDEN, "You don't have permission for this");
+}
+
+/*static*/ bool Auth_Middleware::load_permission(uint32_t user_id, const std::string &permission, bool &is_allowed)
 {
     const std::string sql =
             "SELECT COUNT(*) FROM das_user u "
@@ -27,13 +43,14 @@ void Auth_Middleware::check_permission(const std::string &permission)
             "LEFT JOIN auth_permission p ON p.id = gp.permission_id "
             "WHERE u.id = ? AND p.codename = ?";
 
-    const uint32_t user_id = get_thread_local_user().id_;
-
     using namespace Helpz::DB;
     Base& db = Base::get_thread_local_instance();
     QSqlQuery q = db.exec(QString::fromStdString(sql), {user_id, QString::fromStdString(permission)});
-    if (!q.next() || q.value(0).toUInt() == 0)
-        throw served::request_error(served::status_4XX::FORBIDDEN, "You don't have permission for this");
+    if (!q.isActive())
+        return false;
+
+    is_allowed = q.next() && q.value(0).toUInt() != 0;
+    return true;
 }
 
 Auth_Middleware::Auth_Middleware(std::shared_ptr<JWT_Helper> jwt_helper, const std::vector<std::string>& exclude_path) :
@@ -70,6 +87,9 @@ void Auth_Middleware::check_token(const served::request &req)
 
     token.replace(0, 4, std::string());
 
+    if (Auth_Cache::instance().get_token(token, thread_local_user))
+        return;
+
     try
     {
         const std::string json_raw = jwt_helper_->decode_and_verify(token);
@@ -84,6 +104,10 @@ void Auth_Middleware::check_token(const served::request &req)
         const picojson::array scheme_groups = obj.at("groups").get<picojson::array>();
         for (const picojson::value& scheme_group_id: scheme_groups)
             thread_local_user.scheme_group_set_.insert(scheme_group_id.get<int64_t>());
+
+        auto exp_it = obj.find("exp");
+        if (exp_it != obj.cend() && exp_it->second.is<int64_t>())
+            Auth_Cache::instance().set_token(token, thread_local_user, exp_it->second.get<int64_t>());
     }
     catch(const std::exception& e)
     {
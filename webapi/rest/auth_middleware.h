@@ -35,6 +35,9 @@ public:
     Auth_Middleware(std::shared_ptr<JWT_Helper> jwt_helper, const std::vector<std::string>& exclude_path = {});
     void operator ()(served::response &, const served::request & req);
 private:
+    // Return false if database request is failed
+    static bool load_permission(uint32_t user_id, const std::string& permission, bool& is_allowed);
+
     bool is_exclude(const std::string& url_path);
     void check_token(const served::request& req);
 
@@ -0,0 +1,104 @@
+#include <mutex>
+
+#include "device_item_value_cache.h"
+
+namespace Das {
+namespace Rest {
+
+/*static*/ Device_Item_Value_Cache &Device_Item_Value_Cache::instance()
+{
+    static Device_Item_Value_Cache cache;
+    return cache;
+}
+
+bool Device_Item_Value_Cache::get(uint32_t scheme_id, QVector<Device_Item_Value> &values, uint64_t &load_token)
+{
+    {
+        std::shared_lock lock(mutex_);
+        auto it = entry_map_.find(scheme_id);
+        if (it != entry_map_.cend() && it->second.is_loaded_)
+        {
+            values.clear();
+            values.reserve(it->second.value_map_.size());
+            for (const auto& value_it: it->second.value_map_)
+                values.push_back(value_it.second);
+            return true;
+        }
+    }
+
+    std::unique_lock lock(mutex_);
+    Entry& entry = entry_map_[scheme_id]; // Start to collect values while loading
+    if (!entry.load_token_)
+        entry.load_token_ = ++last_load_token_;
+    load_token = entry.load_token_;
+    return false;
+}
+
+void Device_Item_Value_Cache::set(uint32_t scheme_id, uint64_t load_token, const QVector<Device_Item_Value> &values)
+{
+    std::unique_lock lock(mutex_);
+    auto it = entry_map_.find(scheme_id);
+    if (it == entry_map_.end() || it->second.load_token_ != load_token || it->second.is_loaded_)
+        return;
+
+    Entry& entry = it->second;
+    std::map<uint32_t, Device_Item_Value> collected_map = std::move(entry.value_map_);
+    entry.value_map_.clear();
+    for (const Device_Item_Value& value: values)
+        entry.value_map_.emplace(value.item_id(), value);
+
+    // Values from signals received while loading is newer than loaded ones
+    for (const auto& value_it: collected_map)
+        if (entry.value_map_.find(value_it.first) != entry.value_map_.end())
+            set_value(entry, value_it.second);
+    entry.is_loaded_ = true;
+}
+
+void Device_Item_Value_Cache::update(uint32_t scheme_id, const QVector<Log_Value_Item> &pack)
+{
+    std::unique_lock lock(mutex_);
+    auto it = entry_map_.find(scheme_id);
+    if (it == entry_map_.end())
+        return;
+
+    for (const Log_Value_Item& item: pack)
+    {
+        if (item.raw_value().isValid() || !item.value().isValid())
+            set_value(it->second, item);
+        else
+        {
+            // Server drops raw value of saved item when it's equal to display value
+            Device_Item_Value value = item;
+            value.set_raw_value(item.value());
+            set_value(it->second, value);
+        }
+    }
+}
+
+void Device_Item_Value_Cache::invalidate(uint32_t scheme_id)
+{
+    std::unique_lock lock(mutex_);
+    entry_map_.erase(scheme_id);
+}
+
+void Device_Item_Value_Cache::clear()
+{
+    std::unique_lock lock(mutex_);
+    entry_map_.clear();
+}
+
+/*static*/ void Device_Item_Value_Cache::set_value(Entry &entry, const Device_Item_Value &value)
+{
+    auto it = entry.value_map_.find(value.item_id());
+    if (it == entry.value_map_.end())
+    {
+        // Unknown item is skipped, while loading items isn't known yet
+        if (!entry.is_loaded_)
+            entry.value_map_.emplace(value.item_id(), value);
+    }
+    else if (it->second.timestamp_msecs() <= value.timestamp_msecs())
+        it->second = value;
+}
+
+} // namespace Rest
+} // namespace Das
@@ -0,0 +1,53 @@
+#ifndef DAS_REST_DEVICE_ITEM_VALUE_CACHE_H
+#define DAS_REST_DEVICE_ITEM_VALUE_CACHE_H
+
+#include <map>
+#include <shared_mutex>
+
+#include <QVector>
+
+#include <Das/log/log_value_item.h>
+
+namespace Das {
+namespace Rest {
+
+// Latest device item values of schemes requested by REST.
+// Scheme is loaded once from database and server snapshot,
+// then kept up to date by value signals from server.
+class Device_Item_Value_Cache
+{
+public:
+    static Device_Item_Value_Cache& instance();
+
+    // Return false if scheme isn't loaded yet, then caller should load it and call set with load_token.
+    // Values received after that call are kept until set.
+    bool get(uint32_t scheme_id, QVector<Device_Item_Value>& values, uint64_t& load_token);
+    // Ignored if scheme is invalidated after load is started
+    void set(uint32_t scheme_id, uint64_t load_token, const QVector<Device_Item_Value>& values);
+
+    // Only items of loaded scheme is updated
+    void update(uint32_t scheme_id, const QVector<Log_Value_Item>& pack);
+
+    void invalidate(uint32_t scheme_id);
+    void clear();
+private:
+    Device_Item_Value_Cache() = default;
+
+    struct Entry
+    {
+        uint64_t load_token_ = 0;
+        bool is_loaded_ = false;
+        std::map<uint32_t, Device_Item_Value> value_map_; // By item id
+    };
+
+    static void set_value(Entry& entry, const Device_Item_Value& value);
+
+    uint64_t last_load_token_ = 0;
+    std::map<uint32_t, Entry> entry_map_;
+    mutable std::shared_mutex mutex_;
+};
+
+} // namespace Rest
+} // namespace Das
+
+#endif // DAS_REST_DEVICE_ITEM_VALUE_CACHE_H
@@ -0,0 +1,176 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include <QJsonValue>
+
+#include "json_writer.h"
+
+namespace Das {
+namespace Rest {
+
+Json_Writer::Json_Writer(std::string &out) :
+    _after_key(false),
+    _out(out)
+{
+}
+
+void Json_Writer::begin_object()
+{
+    separate();
+    _out += '{';
+    _is_first.push_back(true);
+}
+
+void Json_Writer::end_object()
+{
+    _is_first.pop_back();
+    _out += '}';
+}
+
+void Json_Writer::begin_array()
+{
+    separate();
+    _out += '[';
+    _is_first.push_back(true);
+}
+
+void Json_Writer::end_array()
+{
+    _is_first.pop_back();
+    _out += ']';
+}
+
+void Json_Writer::key(const char *name)
+{
+    separate();
+    write_string(name, std::strlen(name));
+    _out += ':';
+    _after_key = true;
+}
+
+void Json_Writer::null()
+{
+    separate();
+    _out += "null";
+}
+
+void Json_Writer::value(bool data)
+{
+    separate();
+    _out += data ? "true" : "false";
+}
+
+void Json_Writer::value(int64_t data)
+{
+    separate();
+    _out += std::to_string(data);
+}
+
+void Json_Writer::value(double data)
+{
+    if (!std::isfinite(data))
+    {
+        null();
+        return;
+    }
+
+    separate();
+
+    char buf[64];
+    const int size = std::snprintf(buf, sizeof(buf), "%.17g", data);
+    if (size > 0)
+        _out.append(buf, static_cast<std::size_t>(size));
+}
+
+void Json_Writer::value(const char *data)
+{
+    separate();
+    write_string(data, std::strlen(data));
+}
+
+void Json_Writer::value(const std::string &data)
+{
+    separate();
+    write_string(data.c_str(), data.size());
+}
+
+void Json_Writer::value(const QVariant &data)
+{
+    const QJsonValue json_value = QJsonValue::fromVariant(data);
+    switch (json_value.type())
+    {
+    case QJsonValue::Null:
+    case QJsonValue::Undefined:
+        null();
+        break;
+
+    case QJsonValue::Bool:
+        value(json_value.toBool());
+        break;
+
+    case QJsonValue::Double:
+        value(json_value.toDouble());
+        break;
+
+    case QJsonValue::String:
+        value(json_value.toString().toStdString());
+        break;
+
+    default:
+        value(data.toString().toStdString());
+        break;
+    }
+}
+
+void Json_Writer::raw(const std::string &json)
+{
+    separate();
+    _out += json;
+}
+
+void Json_Writer::separate()
+{
+    if (_after_key)
+        _after_key = false;
+    else if (!_is_first.empty())
+    {
+        if (_is_first.back())
+            _is_first.back() = false;
+        else
+            _out += ',';
+    }
+}
+
+void Json_Writer::write_string(const char *data, std::size_t size)
+{
+    _out += '"';
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        const char c = data[i];
+        switch (c)
+        {
+        case '"':  _out += "\\\""; break;
+        case '\\': _out += "\\\\"; break;
+        case '\b': _out += "\\b"; break;
+        case '\f': _out += "\\f"; break;
+        case '\n': _out += "\\n"; break;
+        case '\r': _out += "\\r"; break;
+        case '\t': _out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+                _out += buf;
+            }
+            else
+                _out += c;
+            break;
+        }
+    }
+    _out += '"';
+}
+
+} // namespace Rest
+} // namespace Das
@@ -0,0 +1,48 @@
+#ifndef DAS_REST_JSON_WRITER_H
+#define DAS_REST_JSON_WRITER_H
+
+#include <string>
+#include <vector>
+
+#include <QVariant>
+
+namespace Das {
+namespace Rest {
+
+// Writes JSON text directly into the string without building a value tree
+class Json_Writer
+{
+public:
+    explicit Json_Writer(std::string& out);
+
+    void begin_object();
+    void end_object();
+    void begin_array();
+    void end_array();
+
+    void key(const char* name);
+
+    void null();
+    void value(bool data);
+    void value(int64_t data);
+    void value(double data);
+    void value(const char* data);
+    void value(const std::string& data);
+    void value(const QVariant& data);
+
+    // Already serialized JSON value
+    void raw(const std::string& json);
+
+private:
+    void separate();
+    void write_string(const char* data, std::size_t size);
+
+    bool _after_key;
+    std::vector<bool> _is_first;
+    std::string& _out;
+};
+
+} // namespace Rest
+} // namespace Das
+
+#endif // DAS_REST_JSON_WRITER_H
@@ -0,0 +1,263 @@
+#ifndef DAS_REST_CHART_DOWNSAMPLER_H
+#define DAS_REST_CHART_DOWNSAMPLER_H
+
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Das {
+namespace Rest {
+
+// Reduces time ordered points of one item to a few points per time bucket.
+// Points that have no numeric value are passed through as is, output is kept in time order.
+template<typename T>
+class Chart_Downsampler
+{
+public:
+    enum Mode
+    {
+        M_LTTB,     // Largest-Triangle-Three-Buckets
+        M_MIN_MAX,
+        M_AVG,
+        M_LAST
+    };
+
+    // Empty name is LTTB, false for unknown name
+    static bool mode_from_string(const std::string& name, Mode& mode)
+    {
+        if (name.empty() || name == "lttb") mode = M_LTTB;
+        else if (name == "minmax")          mode = M_MIN_MAX;
+        else if (name == "avg")             mode = M_AVG;
+        else if (name == "last")            mode = M_LAST;
+        else
+            return false;
+        return true;
+    }
+
+    // How many points are left from one bucket
+    static int64_t points_per_bucket(Mode mode)
+    {
+        return mode == M_MIN_MAX ? 2 : 1;
+    }
+
+    struct Point
+    {
+        int64_t _time;
+        double _value;
+        bool _is_number;
+        bool _is_aggregated; // _value is calculated, _data isn't used
+        T _data;
+    };
+
+    using Output_Func = std::function<void(Point&&)>;
+
+    Chart_Downsampler(Mode mode, int64_t time_from, int64_t bucket_ms, Output_Func output) :
+        _is_first(true),
+        _mode(mode),
+        _time_from(time_from),
+        _bucket_ms(bucket_ms > 0 ? bucket_ms : 1),
+        _bucket_index(-1),
+        _output(std::move(output))
+    {
+    }
+
+    Chart_Downsampler(Chart_Downsampler&&) = default;
+
+    void add(Point&& point)
+    {
+        if (!point._is_number || !std::isfinite(point._value))
+        {
+            // Numeric points before it may be still in bucket
+            point._is_number = false;
+            _pending.push_back(std::move(point));
+            return;
+        }
+
+        const int64_t index = (point._time - _time_from) / _bucket_ms;
+        if (index != _bucket_index)
+        {
+            close_bucket();
+            _bucket_index = index;
+        }
+
+        if (_mode == M_LTTB && _is_first)
+        {
+            // LTTB always keeps the first point
+            _is_first = false;
+            _selected_time = point._time;
+            _selected_value = point._value;
+            output(std::move(point));
+            return;
+        }
+
+        _bucket.push_back(std::move(point));
+    }
+
+    void finish()
+    {
+        if (_mode == M_LTTB)
+        {
+            if (!_prev_bucket.empty())
+            {
+                if (_bucket.empty())
+                {
+                    // Last point of data is kept, so it is third point for previous bucket
+                    Point last = std::move(_prev_bucket.back());
+                    _prev_bucket.pop_back();
+                    if (!_prev_bucket.empty())
+                        select_lttb(last._time, last._value);
+                    output(std::move(last));
+                }
+                else
+                    select_lttb(average_time(_bucket), average_value(_bucket));
+            }
+
+            if (!_bucket.empty())
+            {
+                Point last = std::move(_bucket.back());
+                _bucket.pop_back();
+                if (!_bucket.empty())
+                {
+                    _prev_bucket = std::move(_bucket);
+                    _bucket.clear();
+                    select_lttb(last._time, last._value);
+                }
+                output(std::move(last));
+            }
+        }
+        else
+            close_bucket();
+
+        for (Point& point: _pending)
+            _output(std::move(point));
+
+        _pending.clear();
+        _bucket.clear();
+        _prev_bucket.clear();
+        _bucket_index = -1;
+    }
+
+private:
+    // Selected points is always in time order, so pending points before it can be written
+    void output(Point&& point)
+    {
+        while (!_pending.empty() && _pending.front()._time <= point._time)
+        {
+            _output(std::move(_pending.front()));
+            _pending.pop_front();
+        }
+        _output(std::move(point));
+    }
+
+    void close_bucket()
+    {
+        if (_bucket.empty())
+            return;
+
+        switch (_mode)
+        {
+        case M_LTTB:
+            if (!_prev_bucket.empty())
+                select_lttb(average_time(_bucket), average_value(_bucket));
+            _prev_bucket = std::move(_bucket);
+            break;
+
+        case M_MIN_MAX:
+        {
+            auto min_it = _bucket.begin(), max_it = _bucket.begin();
+            for (auto it = _bucket.begin(); it != _bucket.end(); ++it)
+            {
+                if (it->_value < min_it->_value)
+                    min_it = it;
+                if (it->_value > max_it->_value)
+                    max_it = it;
+            }
+
+            if (min_it == max_it)
+                output(std::move(*min_it));
+            else if (min_it->_time < max_it->_time)
+            {
+                output(std::move(*min_it));
+                output(std::move(*max_it));
+            }
+            else
+            {
+                output(std::move(*max_it));
+                output(std::move(*min_it));
+            }
+            break;
+        }
+
+        case M_AVG:
+        {
+            Point point = std::move(_bucket.back());
+            point._time = _time_from + _bucket_index * _bucket_ms;
+            point._value = average_value(_bucket);
+            point._is_aggregated = true;
+            output(std::move(point));
+            break;
+        }
+
+        case M_LAST:
+            output(std::move(_bucket.back()));
+            break;
+        }
+
+        _bucket.clear();
+    }
+
+    // Select point of previous bucket which forms the largest triangle
+    // with last selected point and the average point of next bucket
+    void select_lttb(double next_time, double next_value)
+    {
+        auto selected_it = _prev_bucket.begin();
+        double area, max_area = -1.;
+        for (auto it = _prev_bucket.begin(); it != _prev_bucket.end(); ++it)
+        {
+            area = std::abs((_selected_time - next_time) * (it->_value - _selected_value)
+                            - (_selected_time - it->_time) * (next_value - _selected_value));
+            if (area > max_area)
+            {
+                max_area = area;
+                selected_it = it;
+            }
+        }
+
+        _selected_time = selected_it->_time;
+        _selected_value = selected_it->_value;
+        output(std::move(*selected_it));
+        _prev_bucket.clear();
+    }
+
+    static double average_time(const std::vector<Point>& bucket)
+    {
+        double sum = 0.;
+        for (const Point& point: bucket)
+            sum += point._time;
+        return sum / bucket.size();
+    }
+
+    static double average_value(const std::vector<Point>& bucket)
+    {
+        double sum = 0.;
+        for (const Point& point: bucket)
+            sum += point._value;
+        return sum / bucket.size();
+    }
+
+    bool _is_first;
+    Mode _mode;
+    int64_t _time_from, _bucket_ms, _bucket_index;
+    double _selected_time = 0., _selected_value = 0.;
+
+    std::vector<Point> _bucket, _prev_bucket;
+    std::deque<Point> _pending; // Not numeric points
+    Output_Func _output;
+};
+
+} // namespace Rest
+} // namespace Das
+
+#endif // DAS_REST_CHART_DOWNSAMPLER_H
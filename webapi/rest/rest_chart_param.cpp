@@ -33,7 +33,12 @@ QString Chart_Param::get_field_name(Chart_Value::Field_Type field_type) const
 }
 
 QString Chart_Param::get_additional_field_names() const { return {}; }
-void Chart_Param::fill_additional_fields(picojson::object &, const QSqlQuery &, const QVariant &) const {}
+void Chart_Param::write_additional_fields(Json_Writer &, const QVariant &, const QVariant &) const {}
+
+bool Chart_Param::has_rollups() const
+{
+    return false;
+}
 
 } // namespace Rest
 } // namespace Das
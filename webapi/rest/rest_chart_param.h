@@ -14,7 +14,8 @@ private:
     QString get_table_name() const override;
     QString get_field_name(Field_Type field_type) const override;
     QString get_additional_field_names() const override;
-    void fill_additional_fields(picojson::object&, const QSqlQuery&, const QVariant&) const override;
+    void write_additional_fields(Json_Writer&, const QVariant&, const QVariant&) const override;
+    bool has_rollups() const override;
 };
 
 } // namespace Rest
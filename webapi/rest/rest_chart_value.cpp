@@ -5,9 +5,8 @@
 #include <served/status.hpp>
 #include <served/request_error.hpp>
 
-#include <QJsonValue>
-
 #include <Das/log/log_value_item.h>
+#include <Das/log/log_value_rollup.h>
 
 #include "json_helper.h"
 #include "auth_middleware.h"
@@ -20,6 +19,9 @@ namespace Rest {
 using namespace Helpz::DB;
 
 Chart_Value::Chart_Value() :
+    _bucket_ms(0),
+    _downsample_mode(Downsampler::M_LTTB),
+    _rollup_interval(0),
     _db(Base::get_thread_local_instance())
 {
 }
@@ -30,15 +32,23 @@ std::string Chart_Value::operator()(const served::request &req)
 
     Auth_Middleware::check_permission(permission_name());
 
-    int64_t count = fill_datamap();
-
-    picojson::array results;
-    fill_results(results);
-
-    picojson::object json;
-    json.emplace("count", count);
-    json.emplace("results", std::move(results));
-    return picojson::value(std::move(json)).serialize();
+    fill_range_points();
+
+    const bool use_rollup = _bucket_ms && has_rollups() && select_rollup();
+
+    std::string data;
+    Json_Writer json(data);
+    json.begin_object();
+    json.key("results");
+    json.begin_array();
+    int64_t count = use_rollup ? write_rollup_results(json) : 0;
+    if (!_data_in_list.isEmpty())
+        count += write_results(json);
+    json.end_array();
+    json.key("count");
+    json.value(count);
+    json.end_object();
+    return data;
 }
 
 std::string Chart_Value::permission_name() const
@@ -73,12 +83,20 @@ QString Chart_Value::get_additional_field_names() const
     return Log_Value_Item::table_column_names().at(Log_Value_Item::COL_raw_value);
 }
 
-void Chart_Value::fill_additional_fields(picojson::object &obj, const QSqlQuery &q, const QVariant &value) const
+void Chart_Value::write_additional_fields(Json_Writer &json, const QVariant &additional_value, const QVariant &value) const
 {
-    const QVariant raw_value = Device_Item_Value::variant_from_string(q.value(FT_VALUE + 1));
+    const QVariant raw_value = Device_Item_Value::variant_from_string(additional_value);
 
     if (value != raw_value)
-        obj.emplace("raw_value", variant_to_json(raw_value));
+    {
+        json.key("raw_value");
+        json.value(raw_value);
+    }
+}
+
+bool Chart_Value::has_rollups() const
+{
+    return true;
 }
 
 void Chart_Value::parse_params(const served::request &req)
@@ -90,6 +108,7 @@ void Chart_Value::parse_params(const served::request &req)
     _where = get_where();
 
     parse_limits(req.query["offset"], req.query["limit"]);
+    parse_downsampling(req.query["points"], req.query["bucket_ms"], req.query["agg"]);
 
     _range_in_past = _time_range._to < DB::Log_Base_Item::current_timestamp();
 }
@@ -141,7 +160,12 @@ void Chart_Value::parse_data_in(const std::string &param)
 
 QString Chart_Value::get_data_in_where() const
 {
-    return get_field_name(FT_ITEM_ID) + " IN (" + _data_in_list.join(',') + ')';
+    return get_data_in_where(_data_in_list);
+}
+
+QString Chart_Value::get_data_in_where(const QStringList& data_in_list) const
+{
+    return get_field_name(FT_ITEM_ID) + " IN (" + data_in_list.join(',') + ')';
 }
 
 void Chart_Value::parse_limits(const std::string &offset_str, const std::string &limit_str)
@@ -152,53 +176,278 @@ void Chart_Value::parse_limits(const std::string &offset_str, const std::string
         _limit = 1000000;
 }
 
+void Chart_Value::parse_downsampling(const std::string &points_str, const std::string &bucket_ms_str, const std::string &agg_str)
+{
+    if (!Downsampler::mode_from_string(agg_str, _downsample_mode))
+        throw served::request_error(served::status_4XX::BAD_REQUEST, "Invalid agg mode");
+
+    _bucket_ms = stoa_or<long long>(bucket_ms_str, 0LL, std::stoll);
+
+    const uint32_t points = stoa_or(points_str);
+    if (_bucket_ms <= 0 && points)
+    {
+        const int64_t range = _time_range._to - _time_range._from;
+        const int64_t bucket_count = std::max<int64_t>(1, points / Downsampler::points_per_bucket(_downsample_mode));
+        _bucket_ms = (range + bucket_count - 1) / bucket_count;
+    }
+
+    if (_bucket_ms < 0)
+        _bucket_ms = 0;
+}
+
 QString Chart_Value::get_limit_suffix(uint32_t offset, uint32_t limit) const
 {
     return "LIMIT " + QString::number(offset) + ',' + QString::number(limit);
 }
 
-int64_t Chart_Value::fill_datamap()
+void Chart_Value::fill_range_points()
 {
-    int64_t count = 0, timestamp;
+    int64_t timestamp;
     uint32_t item_id;
 
-    const QString sql = get_full_sql();
-    QSqlQuery q = _db.exec(sql);
+    QSqlQuery q = _db.exec(get_range_points_sql());
+    while (q.next())
+    {
+        timestamp = q.value(FT_TIME).toLongLong();
+        item_id = q.value(FT_ITEM_ID).toUInt();
+
+        if (timestamp <= _time_range._from)
+            _before_range_point_map.emplace(item_id, get_data_item(get_row_data(q), _time_range._from));
+        else // if (timestamp >= _time_range._to)
+            _after_range_point_map.emplace(item_id, get_data_item(get_row_data(q), _time_range._to));
+    }
+}
 
-    enum Step_Type { DATA_STEP, ONE_POINTS_STEP };
-    int step = DATA_STEP;
-    do
+int64_t Chart_Value::write_results(Json_Writer &json)
+{
+    int64_t count = 0, timestamp, last_timestamp = 0;
+    uint32_t item_id, last_item_id = 0;
+
+    // Rows are ordered by item and time, so every item is written in one pass
+    QSqlQuery q = _db.exec(get_data_sql());
+    while (q.next())
     {
+        timestamp = q.value(FT_TIME).toLongLong();
+        item_id = q.value(FT_ITEM_ID).toUInt();
+        ++count;
+
+        if (item_id != last_item_id)
+        {
+            if (last_item_id)
+                end_item(json, last_item_id, last_timestamp);
+            begin_item(json, item_id, timestamp);
+            last_item_id = item_id;
+        }
+        else if (timestamp == last_timestamp)
+            continue;
+
+        if (_downsampler)
+            add_downsampled_point(q, timestamp);
+        else
+            write_data_item(json, get_row_data(q), timestamp);
+
+        last_timestamp = timestamp;
+    }
+
+    if (last_item_id)
+        end_item(json, last_item_id, last_timestamp);
+
+    return count;
+}
+
+bool Chart_Value::select_rollup()
+{
+    const std::vector<std::pair<QString, int64_t>> rollups{
+        { DB::Log_Value_Day::table_name(), DB::Log_Value_Day::interval_msecs },
+        { DB::Log_Value_Hour::table_name(), DB::Log_Value_Hour::interval_msecs },
+        { DB::Log_Value_Minute::table_name(), DB::Log_Value_Minute::interval_msecs }
+    };
+
+    using T = DB::Log_Value_Rollup;
+    const QString time_name = T::table_column_names().at(T::COL_timestamp_msecs);
+    const QString item_id_name = T::table_column_names().at(T::COL_item_id);
+    const QString where = " WHERE " + _scheme_where + " AND " + get_data_in_where() + " GROUP BY " + item_id_name;
+    for (const auto& rollup: rollups)
+    {
+        if (rollup.second > _bucket_ms)
+            continue;
+
+        // Table must contain whole range of item, older rows may be already removed or not filled yet.
+        // Non-numeric items hasn't rollup rows, so they and not covered items is read from raw log.
+        QStringList covered_list;
+        QSqlQuery q = _db.exec("SELECT " + item_id_name + ", MIN(" + time_name + ") FROM " + rollup.first + where);
         while (q.next())
+            if (!q.isNull(1) && q.value(1).toLongLong() <= _time_range._from)
+                covered_list.push_back(QString::number(q.value(0).toUInt()));
+
+        if (!covered_list.isEmpty())
         {
-            timestamp = q.value(FT_TIME).toLongLong();
-            item_id = q.value(FT_ITEM_ID).toUInt();
+            for (const QString& item_id: covered_list)
+                _data_in_list.removeOne(item_id);
+            _rollup_data_in_list = std::move(covered_list);
+            _where = get_where();
+
+            _rollup_table_name = rollup.first;
+            _rollup_interval = rollup.second;
+            return true;
+        }
+    }
 
-            if (step == DATA_STEP)
-            {
-                std::map<int64_t, picojson::object>& item_data = _data_map[item_id];
-                item_data.emplace(timestamp, get_data_item(q, timestamp));
+    return false;
+}
 
-                ++count;
-            }
-            else if (timestamp <= _time_range._from)
-            {
-                _before_range_point_map.emplace(item_id, get_data_item(q, _time_range._from));
-            }
-            else // if (timestamp >= _time_range._to)
-            {
-                _after_range_point_map.emplace(item_id, get_data_item(q, _time_range._to));
-            }
+int64_t Chart_Value::write_rollup_results(Json_Writer &json)
+{
+    using T = DB::Log_Value_Rollup;
+    const QStringList names = T::table_column_names();
+    const QStringList field_names{
+        names.at(T::COL_timestamp_msecs), names.at(T::COL_item_id), names.at(T::COL_value_count),
+        names.at(T::COL_min_value), names.at(T::COL_max_value), names.at(T::COL_sum_value),
+        names.at(T::COL_last_value), names.at(T::COL_last_timestamp_msecs),
+        names.at(T::COL_min_timestamp_msecs), names.at(T::COL_max_timestamp_msecs)
+    };
+
+    const QString& time_name = field_names.front();
+    const QString time_from = QString::number(_time_range._from - _time_range._from % _rollup_interval);
+    const QString page_sql = "SELECT " + field_names.join(", ") + " FROM " + _rollup_table_name +
+            " WHERE " + _scheme_where + " AND " + get_data_in_where(_rollup_data_in_list) +
+            " AND " + time_name + " >= " + time_from + " AND " + time_name + " <= " + QString::number(_time_range._to) +
+            " ORDER BY " + time_name + ", " + field_names.at(1) + ' ' + get_limit_suffix(_offset, _limit);
+    const QString sql = "SELECT * FROM (" + page_sql + ") page ORDER BY " + field_names.at(1) + ", " + time_name;
+
+    int64_t count = 0, timestamp, last_timestamp = 0;
+    uint32_t item_id, last_item_id = 0;
+
+    QSqlQuery q = _db.exec(sql);
+    while (q.next())
+    {
+        timestamp = q.value(0).toLongLong();
+        item_id = q.value(1).toUInt();
+        ++count;
+
+        if (item_id != last_item_id)
+        {
+            if (last_item_id)
+                end_item(json, last_item_id, last_timestamp);
+            begin_item(json, item_id, timestamp);
+            last_item_id = item_id;
         }
 
-        ++step;
+        add_rollup_point(q);
+        last_timestamp = q.value(7).toLongLong();
     }
-    while (q.nextResult());
+
+    if (last_item_id)
+        end_item(json, last_item_id, last_timestamp);
 
     return count;
 }
 
-QString Chart_Value::get_full_sql() const
+void Chart_Value::add_rollup_point(const QSqlQuery &query)
+{
+    const int64_t timestamp = query.value(0).toLongLong();
+
+    switch (_downsample_mode)
+    {
+    case Downsampler::M_MIN_MAX:
+    {
+        // Extremes is added in time order
+        Downsampler::Point min_point{query.value(8).toLongLong(), query.value(3).toDouble(), true, true, {}};
+        Downsampler::Point max_point{query.value(9).toLongLong(), query.value(4).toDouble(), true, true, {}};
+        if (min_point._time > max_point._time)
+            std::swap(min_point, max_point);
+        _downsampler->add(std::move(min_point));
+        _downsampler->add(std::move(max_point));
+        break;
+    }
+
+    case Downsampler::M_LAST:
+        _downsampler->add(Downsampler::Point{query.value(7).toLongLong(), query.value(6).toDouble(), true, true, {}});
+        break;
+
+    default:
+    {
+        const double value_count = query.value(2).toDouble();
+        const double value = value_count > 0. ? query.value(5).toDouble() / value_count : 0.;
+        _downsampler->add(Downsampler::Point{timestamp, value, true, true, {}});
+        break;
+    }
+    }
+}
+
+void Chart_Value::begin_item(Json_Writer &json, uint32_t item_id, int64_t first_timestamp)
+{
+    json.begin_object();
+    json.key("item_id");
+    json.value(static_cast<int64_t>(item_id));
+    json.key("data");
+    json.begin_array();
+
+    if (first_timestamp > _time_range._from)
+    {
+        const auto point_it = _before_range_point_map.find(item_id);
+        if (point_it != _before_range_point_map.cend())
+            json.raw(point_it->second);
+    }
+
+    if (_bucket_ms)
+    {
+        auto output = [this, &json](Downsampler::Point&& point)
+        {
+            if (point._is_aggregated)
+            {
+                json.begin_object();
+                json.key("value");
+                json.value(point._value);
+                json.key("time");
+                json.value(point._time);
+                json.end_object();
+            }
+            else
+                write_data_item(json, point._data, point._time);
+        };
+
+        _downsampler.reset(new Downsampler{_downsample_mode, _time_range._from, _bucket_ms, std::move(output)});
+    }
+}
+
+void Chart_Value::end_item(Json_Writer &json, uint32_t item_id, int64_t last_timestamp)
+{
+    if (_downsampler)
+    {
+        _downsampler->finish();
+        _downsampler.reset();
+    }
+
+    if (_range_in_past && last_timestamp < _time_range._to)
+    {
+        const auto point_it = _after_range_point_map.find(item_id);
+        if (point_it != _after_range_point_map.cend())
+            json.raw(point_it->second);
+    }
+
+    json.end_array();
+    json.end_object();
+}
+
+void Chart_Value::add_downsampled_point(const QSqlQuery &query, int64_t timestamp)
+{
+    Row_Data row = get_row_data(query);
+    bool is_number = false;
+    const double value = row._value.toDouble(&is_number);
+    _downsampler->add(Downsampler::Point{timestamp, value, is_number, false, std::move(row)});
+}
+
+QString Chart_Value::get_data_sql() const
+{
+    // Page of rows is taken in time order like before, then it's ordered by item to write every item in one pass
+    const QString time_name = get_field_name(FT_TIME), item_id_name = get_field_name(FT_ITEM_ID);
+    const QString page_sql = get_base_sql() + ' ' + _where + " ORDER BY " + time_name + ", " + item_id_name
+            + ' ' + get_limit_suffix(_offset, _limit);
+    return "SELECT * FROM (" + page_sql + ") page ORDER BY " + item_id_name + ", " + time_name;
+}
+
+QString Chart_Value::get_range_points_sql() const
 {
     QStringList one_point_sql_list;
     for (const QString& item_id: _data_in_list)
@@ -208,9 +457,7 @@ QString Chart_Value::get_full_sql() const
             one_point_sql_list.push_back(get_one_point_sql(_time_range._to, item_id, false));
     }
 
-    return get_base_sql() + ' ' + _where + ' ' + get_limit_suffix(_offset, _limit)
-//            + ';' + get_base_sql("COUNT(*)") + ' ' + _where
-            + ";(" + one_point_sql_list.join(") UNION (") + ')';
+    return '(' + one_point_sql_list.join(") UNION (") + ')';
 }
 
 QString Chart_Value::get_base_sql(const QString& what) const
@@ -242,82 +489,41 @@ QString Chart_Value::get_base_sql(const QString& what) const
     return sql;
 }
 
-picojson::object Chart_Value::get_data_item(const QSqlQuery& query, int64_t timestamp) const
-{
-    picojson::object obj;
-    fill_object(obj, query);
-    obj.emplace("time", static_cast<int64_t>(timestamp));
-    return obj;
-}
-
-picojson::value Chart_Value::variant_to_json(const QVariant& value) const
+Chart_Value::Row_Data Chart_Value::get_row_data(const QSqlQuery &query) const
 {
-    const QJsonValue data = QJsonValue::fromVariant(value);
-    switch (data.type())
-    {
-    case QJsonValue::Null:
-    case QJsonValue::Undefined:
-        return picojson::value();
-
-    case QJsonValue::Bool:
-        return picojson::value(data.toBool());
-
-    case QJsonValue::Double:
-        return picojson::value(data.toDouble());
-
-    case QJsonValue::String:
-        return picojson::value(data.toString().toStdString());
-    default:
-        break;
-    }
-
-    return picojson::value(value.toString().toStdString());
+    return Row_Data{
+        query.value(FT_USER_ID).toLongLong(),
+        Device_Item_Value::variant_from_string(query.value(FT_VALUE)),
+        query.value(FT_VALUE + 1)
+    };
 }
 
-void Chart_Value::fill_object(picojson::object &obj, const QSqlQuery &q) const
+std::string Chart_Value::get_data_item(const Row_Data &row, int64_t timestamp) const
 {
-    const int64_t user_id = q.value(FT_USER_ID).toLongLong();
-    if (user_id)
-        obj.emplace("user_id", user_id);
-
-    const QVariant value     = Device_Item_Value::variant_from_string(q.value(FT_VALUE));
-    obj.emplace("value", variant_to_json(value));
-
-    fill_additional_fields(obj, q, value);
+    std::string data;
+    Json_Writer json(data);
+    write_data_item(json, row, timestamp);
+    return data;
 }
 
-void Chart_Value::fill_results(picojson::array &results) const
+void Chart_Value::write_data_item(Json_Writer &json, const Row_Data &row, int64_t timestamp) const
 {
-//    const qint64 now = DB::Log_Base_Item::current_timestamp();
+    json.begin_object();
 
-    for (const auto& it: _data_map)
+    if (row._user_id)
     {
-        picojson::array data_arr;
-
-        if (it.second.empty() || it.second.cbegin()->first > _time_range._from)
-        {
-            const auto point_it = _before_range_point_map.find(it.first);
-            if (point_it != _before_range_point_map.cend())
-                data_arr.push_back(picojson::value(point_it->second));
-        }
+        json.key("user_id");
+        json.value(row._user_id);
+    }
 
-        for (auto&& data_it: it.second)
-            data_arr.push_back(picojson::value(std::move(data_it.second)));
+    json.key("value");
+    json.value(row._value);
 
-        if (_range_in_past
-            && (it.second.empty() || it.second.crbegin()->first < _time_range._to))
-        {
-            const auto point_it = _after_range_point_map.find(it.first);
-            if (point_it != _after_range_point_map.cend())
-                data_arr.push_back(picojson::value(point_it->second));
-        }
-
-        picojson::object obj;
-        obj.emplace("item_id", static_cast<int64_t>(it.first));
-        obj.emplace("data", std::move(data_arr));
+    write_additional_fields(json, row._additional_value, row._value);
 
-        results.push_back(picojson::value(std::move(obj)));
-    }
+    json.key("time");
+    json.value(timestamp);
+    json.end_object();
 }
 
 QString Chart_Value::get_one_point_sql(int64_t timestamp, const QString& item_id, bool is_before_range_point) const
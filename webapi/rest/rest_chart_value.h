@@ -1,8 +1,7 @@
 #ifndef DAS_REST_CHART_VALUE_H
 #define DAS_REST_CHART_VALUE_H
 
-#define PICOJSON_USE_INT64
-#include <picojson/picojson.h>
+#include <memory>
 
 #include <QSqlQuery>
 
@@ -10,6 +9,9 @@
 
 #include <Helpz/db_base.h>
 
+#include "json_writer.h"
+#include "rest_chart_downsampler.h"
+
 namespace Das {
 namespace Rest {
 
@@ -34,8 +36,17 @@ protected:
     virtual QString get_table_name() const;
     virtual QString get_field_name(Field_Type field_type) const;
     virtual QString get_additional_field_names() const;
-    virtual void fill_additional_fields(picojson::object& obj, const QSqlQuery& q, const QVariant& value) const;
+    virtual void write_additional_fields(Json_Writer& json, const QVariant& additional_value, const QVariant& value) const;
+    virtual bool has_rollups() const;
 private:
+    // Fields of one row, it is written to JSON only if point is left after downsampling
+    struct Row_Data
+    {
+        int64_t _user_id;
+        QVariant _value;
+        QVariant _additional_value;
+    };
+
     void parse_params(const served::request& req);
 
     struct Time_Range {
@@ -49,25 +60,44 @@ private:
     QString get_scheme_where(const served::request &req) const;
     void parse_data_in(const std::string& param);
     QString get_data_in_where() const;
+    QString get_data_in_where(const QStringList& data_in_list) const;
     void parse_limits(const std::string& offset_str, const std::string& limit_str);
+    void parse_downsampling(const std::string& points_str, const std::string& bucket_ms_str, const std::string& agg_str);
     QString get_limit_suffix(uint32_t offset, uint32_t limit) const;
-    int64_t fill_datamap();
-    QString get_full_sql() const;
+    void fill_range_points();
+    int64_t write_results(Json_Writer& json);
+    bool select_rollup();
+    int64_t write_rollup_results(Json_Writer& json);
+    void add_rollup_point(const QSqlQuery& query);
+    void begin_item(Json_Writer& json, uint32_t item_id, int64_t first_timestamp);
+    void end_item(Json_Writer& json, uint32_t item_id, int64_t last_timestamp);
+    void add_downsampled_point(const QSqlQuery& query, int64_t timestamp);
+    QString get_data_sql() const;
+    QString get_range_points_sql() const;
     QString get_base_sql(const QString &what = QString()) const;
-    picojson::object get_data_item(const QSqlQuery& query, int64_t timestamp) const;
-    picojson::value variant_to_json(const QVariant& value) const;
-    void fill_object(picojson::object& obj, const QSqlQuery& q) const;
-    void fill_results(picojson::array& results) const;
+    Row_Data get_row_data(const QSqlQuery& query) const;
+    std::string get_data_item(const Row_Data& row, int64_t timestamp) const;
+    void write_data_item(Json_Writer& json, const Row_Data& row, int64_t timestamp) const;
     QString get_one_point_sql(int64_t timestamp, const QString &item_id, bool is_before_range_point) const;
 
+    using Downsampler = Chart_Downsampler<Row_Data>;
+
     bool _range_in_past;
     uint32_t _offset, _limit;
+    int64_t _bucket_ms;
+    Downsampler::Mode _downsample_mode;
     Time_Range _time_range;
     QString _scheme_where, _where;
     QStringList _data_in_list;
 
-    std::map<uint32_t/*item_id*/, std::map<int64_t/*timestamp*/, picojson::object>> _data_map;
-    std::map<uint32_t/*item_id*/, picojson::object> _before_range_point_map, _after_range_point_map;
+    std::map<uint32_t/*item_id*/, std::string> _before_range_point_map, _after_range_point_map;
+    std::unique_ptr<Downsampler> _downsampler;
+
+    // Pre-aggregated table which is used instead of raw log if bucket is big enough.
+    // Items covered by it is moved from _data_in_list to _rollup_data_in_list.
+    QStringList _rollup_data_in_list;
+    QString _rollup_table_name;
+    int64_t _rollup_interval;
 
     Helpz::DB::Base& _db;
 };
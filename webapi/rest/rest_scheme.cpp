@@ -4,6 +4,8 @@
 
 #include <QSqlError>
 #include <QUuid>
+#include <QFile>
+#include <QMimeDatabase>
 
 #include <Helpz/db_base.h>
 
@@ -11,6 +13,8 @@
 #include <Das/db/scheme.h>
 #include <Das/db/dig_status_type.h>
 #include <Das/db/disabled_status.h>
+#include <Das/blob_store.h>
+#include <Das/db/blob_scheme.h>
 //#include <Das/db/dig_status.h>
 //#include <Das/db/device_item_value.h>
 //#include <Das/db/chart.h>
@@ -21,9 +25,11 @@
 #include "filter.h"
 #include "csrf_middleware.h"
 #include "auth_middleware.h"
+#include "auth_cache.h"
 #include "scheme_copier.h"
 #include "rest_chart.h"
 #include "rest_chart_data_controller.h"
+#include "device_item_value_cache.h"
 #include "rest_scheme.h"
 
 namespace Das {
@@ -49,6 +55,7 @@ Scheme::Scheme(served::multiplexer& mux, DBus::Interface* dbus_iface) :
     mux.handle(scheme_path + "/dig_status").get([this](served::response& res, const served::request& req) { get_dig_status(res, req); });
     mux.handle(scheme_path + "/dig_status_type").get([this](served::response& res, const served::request& req) { get_dig_status_type(res, req); });
     mux.handle(scheme_path + "/device_item_value").get([this](served::response& res, const served::request& req) { get_device_item_value(res, req); });
+    mux.handle(scheme_path + "/blob/{hash:[0-9a-f]+}").get([this](served::response& res, const served::request& req) { get_blob(res, req); });
     mux.handle(scheme_path + "/disabled_status")
             .get([this](served::response& res, const served::request& req) { get_disabled_status(res, req); })
             .method(served::method::PATCH, [this](served::response& res, const served::request& req) { del_disabled_status(res, req); })
@@ -88,21 +95,36 @@ Scheme::Scheme(served::multiplexer& mux, DBus::Interface* dbus_iface) :
     uint32_t user_id = Auth_Middleware::get_thread_local_user().id_;
     if (user_id != 0 && scheme_id != 0)
     {
-        const QString sql =
-                "SELECT s.id, s.parent_id FROM das_scheme s "
-                "LEFT JOIN das_scheme_groups sg ON sg.scheme_id = s.id "
-                "LEFT JOIN das_scheme_group_user sgu ON sgu.group_id = sg.scheme_group_id "
-                "WHERE s.id = %1 AND sgu.user_id = %2";
-
-        Base& db = Base::get_thread_local_instance();
-        QSqlQuery q = db.exec(sql.arg(scheme_id).arg(user_id));
-        if (q.next())
-            return {q.value(0).toUInt(), {q.value(1).toUInt()}}; // TODO: get array from specific table for extending ids
+        Scheme_Info scheme;
+        if (!Auth_Cache::instance().get_scheme(user_id, scheme_id, scheme)
+            && load_info(user_id, scheme_id, scheme))
+        {
+            Auth_Cache::instance().set_scheme(user_id, scheme_id, scheme);
+        }
+        return scheme;
     }
 
     return {};
 }
 
+/*static*/ bool Scheme::load_info(uint32_t user_id, uint32_t scheme_id, Scheme_Info& scheme)
+{
+    const QString sql =
+            "SELECT s.id, s.parent_id FROM das_scheme s "
+            "LEFT JOIN das_scheme_groups sg ON sg.scheme_id = s.id "
+            "LEFT JOIN das_scheme_group_user sgu ON sgu.group_id = sg.scheme_group_id "
+            "WHERE s.id = %1 AND sgu.user_id = %2";
+
+    Base& db = Base::get_thread_local_instance();
+    QSqlQuery q = db.exec(sql.arg(scheme_id).arg(user_id));
+    if (!q.isActive())
+        return false;
+
+    if (q.next())
+        scheme = Scheme_Info{q.value(0).toUInt(), {q.value(1).toUInt()}}; // TODO: get array from specific table for extending ids
+    return true;
+}
+
 void Scheme::get_dig_status(served::response &res, const served::request &req)
 {
     const Scheme_Info scheme = get_info(req);
@@ -204,18 +226,14 @@ void Scheme::get_device_item_value(served::response &res, const served::request
 {
     const Scheme_Info scheme = get_info(req);
 
-    QVector<Device_Item_Value> unsaved_values;
-
-    std::future<void> unsaved_values_task = std::async(std::launch::async, [this, &scheme, &unsaved_values]() -> void
+    QVector<Device_Item_Value> values;
+    uint64_t load_token;
+    Device_Item_Value_Cache& cache = Device_Item_Value_Cache::instance();
+    if (!cache.get(scheme.id(), values, load_token))
     {
-        QMetaObject::invokeMethod(dbus_iface_, "get_device_item_values", Qt::BlockingQueuedConnection,
-            Q_RETURN_ARG(QVector<Device_Item_Value>, unsaved_values),
-            Q_ARG(uint32_t, scheme.id()));
-    });
-
-    Base& db = Base::get_thread_local_instance();
-    QVector<Device_Item_Value> values = db_build_list<Device_Item_Value>(
-                db, "WHERE scheme_id=" + QString::number(scheme.id()));
+        values = load_device_item_values(scheme.id());
+        cache.set(scheme.id(), load_token, values);
+    }
 
     auto fill_obj = [](QJsonObject& obj, const Device_Item_Value& value)
     {
@@ -236,34 +254,11 @@ void Scheme::get_device_item_value(served::response &res, const served::request
     };
 
     QJsonArray j_array;
-    unsaved_values_task.get();
-    QVector<Device_Item_Value>::iterator unsaved_it;
-
     for (const Device_Item_Value& value: values)
     {
         QJsonObject j_obj;
         j_obj.insert("id", static_cast<int>(value.item_id()));
-
-        unsaved_it = unsaved_values.begin();
-        while (true)
-        {
-            if (unsaved_it == unsaved_values.end())
-            {
-                fill_obj(j_obj, value);
-                break;
-            }
-            else if (unsaved_it->item_id() == value.item_id())
-            {
-                fill_obj(j_obj, *unsaved_it);
-                unsaved_values.erase(unsaved_it);
-                break;
-            }
-            else
-            {
-                ++unsaved_it;
-            }
-        }
-
+        fill_obj(j_obj, value);
         j_array.push_back(j_obj);
     }
 
@@ -271,6 +266,67 @@ void Scheme::get_device_item_value(served::response &res, const served::request
     res << QJsonDocument(j_array).toJson().toStdString();
 }
 
+QVector<Device_Item_Value> Scheme::load_device_item_values(uint32_t scheme_id)
+{
+    QVector<Device_Item_Value> unsaved_values;
+
+    std::future<void> unsaved_values_task = std::async(std::launch::async, [this, scheme_id, &unsaved_values]() -> void
+    {
+        QMetaObject::invokeMethod(dbus_iface_, "get_device_item_values", Qt::BlockingQueuedConnection,
+            Q_RETURN_ARG(QVector<Device_Item_Value>, unsaved_values),
+            Q_ARG(uint32_t, scheme_id));
+    });
+
+    Base& db = Base::get_thread_local_instance();
+    QVector<Device_Item_Value> values = db_build_list<Device_Item_Value>(
+                db, "WHERE scheme_id=" + QString::number(scheme_id));
+
+    unsaved_values_task.get();
+
+    // Values of connected scheme is newer than saved in database
+    std::map<uint32_t, int> index_map;
+    for (int i = 0; i < values.size(); ++i)
+        index_map.emplace(values.at(i).item_id(), i);
+
+    for (const Device_Item_Value& value: unsaved_values)
+    {
+        auto it = index_map.find(value.item_id());
+        if (it != index_map.cend())
+            values[it->second] = value;
+    }
+    return values;
+}
+
+// Blob is shared between schemes with same data, so access is checked by blob scheme rows written by server
+bool is_scheme_blob(uint32_t scheme_id, const QByteArray& hash)
+{
+    const QString sql = "SELECT 1 FROM " + db_table_name<Blob_Scheme>() + " WHERE hash = ? AND scheme_id = ? LIMIT 1";
+    QSqlQuery q = Base::get_thread_local_instance().exec(sql, {QString::fromLatin1(hash.toHex()), scheme_id});
+    return q.next();
+}
+
+void Scheme::get_blob(served::response &res, const served::request &req)
+{
+    const Scheme_Info scheme = get_info(req);
+    if (!scheme.id())
+        throw served::request_error(served::status_4XX::NOT_FOUND, "Scheme not found");
+
+    const QByteArray hash = QByteArray::fromHex(QByteArray::fromStdString(req.params["hash"]));
+    if (!Blob_Store::is_valid_hash(hash) || !is_scheme_blob(scheme.id(), hash))
+        throw served::request_error(served::status_4XX::NOT_FOUND, "Blob not found");
+
+    QFile file(Blob_Store::instance().file_path(hash));
+    if (!file.open(QIODevice::ReadOnly))
+        throw served::request_error(served::status_4XX::NOT_FOUND, "Blob not found");
+
+    const QByteArray data = file.readAll();
+
+    // Blob never changes, because it's named by its hash
+    res.set_header("Content-Type", QMimeDatabase().mimeTypeForData(data).name().toStdString());
+    res.set_header("Cache-Control", "private, max-age=31536000, immutable");
+    res << data.toStdString();
+}
+
 void Scheme::get_disabled_status(served::response &res, const served::request &req)
 {
     Auth_Middleware::check_permission("view_disabled_status");
@@ -529,6 +585,10 @@ void Scheme::create(served::response &res, const served::request &req)
     }
     sql.replace(sql.size()-1, 1, ';');
     q = db.exec(sql);
+
+    // Access to new scheme could be checked and cached before its groups is added
+    Auth_Cache::instance().invalidate_scheme(new_id.toUInt());
+
     if (!q.isActive())
     {
         db.exec("DELETE FROM das_scheme_groups WHERE scheme_id = " + new_id_str);
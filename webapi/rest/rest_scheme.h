@@ -3,6 +3,7 @@
 
 #include <served/served.hpp>
 
+#include <Das/db/device_item_value.h>
 #include <plus/das/scheme_info.h>
 
 namespace Das {
@@ -23,9 +24,14 @@ public:
     static Scheme_Info get_info(const served::request& req);
     static Scheme_Info get_info(uint32_t scheme_id);
 private:
+    // Return false if database request is failed
+    static bool load_info(uint32_t user_id, uint32_t scheme_id, Scheme_Info& scheme);
+
     void get_dig_status(served::response& res, const served::request& req);
     void get_dig_status_type(served::response& res, const served::request& req);
     void get_device_item_value(served::response& res, const served::request& req);
+    QVector<Device_Item_Value> load_device_item_values(uint32_t scheme_id);
+    void get_blob(served::response& res, const served::request& req);
     void get_disabled_status(served::response& res, const served::request& req);
     void del_disabled_status(served::response& res, const served::request& req);
     void add_disabled_status(served::response& res, const served::request& req);
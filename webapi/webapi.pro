@@ -20,8 +20,11 @@ LIBS += -L/usr/local/lib -lserved
 
 SOURCES += main.cpp \
     rest/csrf_middleware.cpp \
+    rest/device_item_value_cache.cpp \
+    rest/auth_cache.cpp \
     rest/auth_middleware.cpp \
     rest/filter.cpp \
+    rest/json_writer.cpp \
     rest/multipart_form_data_parser.cpp \
     rest/rest.cpp \
     rest/rest_chart.cpp \
@@ -42,13 +45,17 @@ SOURCES += main.cpp \
 
 HEADERS += \
     rest/csrf_middleware.h \
+    rest/device_item_value_cache.h \
+    rest/auth_cache.h \
     rest/auth_middleware.h \
     rest/filter.h \
     rest/json_helper.h \
+    rest/json_writer.h \
     rest/multipart_form_data_parser.h \
     rest/rest.h \
     rest/rest_chart.h \
     rest/rest_chart_data_controller.h \
+    rest/rest_chart_downsampler.h \
     rest/rest_chart_param.h \
     rest/rest_chart_value.h \
     rest/rest_scheme.h \
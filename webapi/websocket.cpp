@@ -107,10 +107,13 @@ bool WebSocket::Stream_Item::operator<(const WebSocket::Stream_Item &o) const
 // --------------------------------------------------------------------------------
 
 WebSocket::WebSocket(std::shared_ptr<JWT_Helper> jwt_helper, const QString& address, quint16 port,
-                     const QString& certFilePath, const QString& keyFilePath, QObject *parent) :
+                     const QString& certFilePath, const QString& keyFilePath,
+                     int value_frame_interval_ms, qint64 max_pending_bytes, QObject *parent) :
     QObject(parent),
     server_(new QWebSocketServer(QStringLiteral("Device Access Control"),
                                             certFilePath.isEmpty() || keyFilePath.isEmpty() ? QWebSocketServer::NonSecureMode : QWebSocketServer::SecureMode, this)),
+    value_frame_interval_ms_(value_frame_interval_ms),
+    max_pending_bytes_(max_pending_bytes),
     jwt_helper_(std::move(jwt_helper))
 {
     if (!certFilePath.isEmpty() && !certFilePath.isEmpty())
@@ -143,6 +146,10 @@ WebSocket::WebSocket(std::shared_ptr<JWT_Helper> jwt_helper, const QString& addr
     connect(server_, &QWebSocketServer::acceptError, this, &WebSocket::acceptError);
     connect(server_, &QWebSocketServer::serverError, this, &WebSocket::serverError);
 
+    value_frame_timer_.setSingleShot(true);
+    value_frame_timer_.setInterval(std::max(value_frame_interval_ms_, 50));
+    connect(&value_frame_timer_, &QTimer::timeout, this, &WebSocket::send_value_frames);
+
 //    while ((!worker->n_mng_th && (QThread::msleep(5), true)) ||
 //           (!worker->n_mng_th->ptr() && !worker->n_mng_th->wait(5)));
 //    connect(worker->n_mng_th->ptr(), &Manager::devItemsChanged,
@@ -192,9 +199,14 @@ void WebSocket::onNewConnection()
 //    socket->moveToThread();
     connect(socket, &QWebSocket::binaryMessageReceived, this, &WebSocket::processBinaryMessage);
     connect(socket, &QWebSocket::disconnected, this, &WebSocket::socketDisconnected);
+    connect(socket, &QWebSocket::bytesWritten, this, &WebSocket::socket_bytes_written);
+
+    std::shared_ptr<Websocket_Client> client = std::make_shared<Websocket_Client>();
+    client->socket_ = socket;
 
     QMutexLocker lock(&clients_mutex_);
-    client_map_.insert(socket, std::make_shared<Websocket_Client>());
+    client_map_.insert(socket, std::move(client));
+    unauthorized_clients_.insert(socket);
     socket->sendBinaryMessage(QByteArray(1, WS_AUTH));
 }
 
@@ -217,7 +229,7 @@ void WebSocket::processBinaryMessage(const QByteArray& message)
     ds >> cmd >> scheme_id;
 
     if (scheme_id && client.last_scheme_id_queried_ != scheme_id)
-        client.last_scheme_id_queried_ = scheme_id;
+        set_client_scheme(socket, client, scheme_id);
 //    qDebug(WebSockLog) << pClient->peerAddress().toString() << pClient->peerPort() << "CMD:" << (WebSockCmd)cmd << "SCHEME" << scheme_id << "MSG" << message.size();
 
     if (cmd == WS_AUTH)
@@ -229,6 +241,10 @@ void WebSocket::processBinaryMessage(const QByteArray& message)
 
             if (auth(token, client))
             {
+                {
+                    QMutexLocker lock(&clients_mutex_);
+                    unauthorized_clients_.erase(socket);
+                }
                 socket->sendBinaryMessage(QByteArray(1, WS_WELCOME));
                 return;
             }
@@ -365,11 +381,52 @@ void WebSocket::socketDisconnected()
                 ++cl_it;
         }
 
-        client_map_.erase(it);
+        if (it != client_map_.end())
+        {
+            if (*it && it->get()->last_scheme_id_queried_)
+            {
+                auto sc_it = scheme_clients_.find(it->get()->last_scheme_id_queried_);
+                if (sc_it != scheme_clients_.end())
+                {
+                    sc_it->second.erase(socket);
+                    if (sc_it->second.empty())
+                        scheme_clients_.erase(sc_it);
+                }
+            }
+            client_map_.erase(it);
+        }
+        unauthorized_clients_.erase(socket);
         socket->deleteLater();
     }
 }
 
+void WebSocket::socket_bytes_written(qint64 bytes)
+{
+    QWebSocket *socket = qobject_cast<QWebSocket *>(sender());
+    if (!socket)
+        return;
+
+    QMutexLocker lock(&clients_mutex_);
+    auto it = client_map_.find(socket);
+    if (it != client_map_.end() && *it)
+    {
+        // Written bytes contain frame headers, so it can be more than counted
+        Websocket_Client& client = *it.value();
+        client.pending_bytes_ = std::max<qint64>(0, client.pending_bytes_ - bytes);
+    }
+}
+
+void WebSocket::send_value_frames()
+{
+    std::map<uint32_t, Value_Buffer> value_buffer_map;
+    value_buffer_map.swap(value_buffer_map_);
+
+    for (const auto& it: value_buffer_map)
+        send_values(it.second.scheme_, it.second.pack_);
+
+    send_skipped_values();
+}
+
 bool WebSocket::auth(const QByteArray& token, Websocket_Client& client)
 {
     try
@@ -417,6 +474,25 @@ bool WebSocket::auth(const QByteArray& token, Websocket_Client& client)
     return false;
 }
 
+void WebSocket::set_client_scheme(QWebSocket* socket, Websocket_Client& client, uint32_t scheme_id)
+{
+    QMutexLocker lock(&clients_mutex_);
+
+    if (client.last_scheme_id_queried_)
+    {
+        auto it = scheme_clients_.find(client.last_scheme_id_queried_);
+        if (it != scheme_clients_.end())
+        {
+            it->second.erase(socket);
+            if (it->second.empty())
+                scheme_clients_.erase(it);
+        }
+    }
+
+    client.last_scheme_id_queried_ = scheme_id;
+    scheme_clients_[scheme_id].insert(socket);
+}
+
 bool WebSocket::stream_toggle(uint32_t dev_item_id, bool state, QWebSocket *socket, uint32_t scheme_id)
 {
     const Stream_Item stream_item{scheme_id, dev_item_id};
@@ -453,12 +529,138 @@ void WebSocket::stream_stop(uint32_t scheme_id, uint32_t dev_item_id, uint32_t u
 }
 
 void WebSocket::sendDevice_ItemValues(const Scheme_Info &scheme, const QVector<Log_Value_Item> &pack)
+{
+    if (value_frame_interval_ms_ > 0)
+    {
+        add_to_value_buffer(scheme, pack);
+        if (!value_frame_timer_.isActive())
+            value_frame_timer_.start();
+    }
+    else
+        send_values(scheme, pack);
+}
+
+void WebSocket::add_to_value_buffer(const Scheme_Info &scheme, const QVector<Log_Value_Item> &pack)
+{
+    Value_Buffer& buffer = value_buffer_map_[scheme.id()];
+    buffer.scheme_ = scheme;
+
+    for (const Log_Value_Item& item: pack)
+    {
+        if (item.is_big_value())
+            continue;
+
+        auto pos_it = buffer.replaceable_pos_map_.find(item.item_id());
+        if (item.need_to_save())
+        {
+            // Value which is saved to log is never dropped,
+            // and previous value of the item must stay before it.
+            if (pos_it != buffer.replaceable_pos_map_.end())
+                buffer.replaceable_pos_map_.erase(pos_it);
+            buffer.pack_.push_back(item);
+        }
+        else if (pos_it != buffer.replaceable_pos_map_.end())
+            buffer.pack_[pos_it->second] = item;
+        else
+        {
+            buffer.replaceable_pos_map_.emplace(item.item_id(), buffer.pack_.size());
+            buffer.pack_.push_back(item);
+        }
+    }
+}
+
+void WebSocket::send_values(const Scheme_Info &scheme, const QVector<Log_Value_Item> &pack)
+{
+    const QByteArray message = prepare_values_message(scheme.id(), pack);
+    if (message.isEmpty())
+        return;
+
+    send_auth_request();
+
+    QMutexLocker lock(&clients_mutex_);
+
+    auto sc_it = scheme_clients_.find(scheme.id());
+    if (sc_it == scheme_clients_.cend())
+        return;
+
+    bool is_skipped = false;
+    for (QWebSocket* socket: sc_it->second)
+    {
+        auto it = client_map_.find(socket);
+        if (it == client_map_.cend() || it.value()->id_ == 0
+            || !scheme.check_scheme_groups(it.value()->scheme_group_id_set_))
+            continue;
+
+        Websocket_Client& client = *it.value();
+        if (max_pending_bytes_ > 0 && client.pending_bytes_ > max_pending_bytes_)
+        {
+            // Socket can't send so fast, keep only latest values for it
+            if (client.skipped_scheme_.id() != scheme.id())
+            {
+                client.skipped_scheme_ = scheme;
+                client.skipped_values_.clear();
+            }
+
+            for (const Log_Value_Item& item: pack)
+                if (!item.is_big_value())
+                    client.skipped_values_[item.item_id()] = item;
+            is_skipped = true;
+        }
+        else
+            send_message(socket, client, message);
+    }
+
+    if (is_skipped && !value_frame_timer_.isActive())
+        value_frame_timer_.start();
+}
+
+void WebSocket::send_skipped_values()
+{
+    bool is_skipped = false;
+    std::vector<std::shared_ptr<Websocket_Client>> ready_clients;
+    {
+        QMutexLocker lock(&clients_mutex_);
+        for (auto it = client_map_.begin(); it != client_map_.end(); ++it)
+        {
+            Websocket_Client& client = *it.value();
+            if (client.skipped_values_.empty())
+                continue;
+
+            if (client.last_scheme_id_queried_ != client.skipped_scheme_.id())
+                client.skipped_values_.clear();
+            else if (client.pending_bytes_ <= max_pending_bytes_)
+                ready_clients.push_back(it.value());
+            else
+                is_skipped = true;
+        }
+    }
+
+    for (const std::shared_ptr<Websocket_Client>& client: ready_clients)
+    {
+        QVector<Log_Value_Item> pack;
+        pack.reserve(client->skipped_values_.size());
+        for (const auto& it: client->skipped_values_)
+            pack.push_back(it.second);
+        client->skipped_values_.clear();
+
+        const QByteArray message = prepare_values_message(client->skipped_scheme_.id(), pack);
+
+        QMutexLocker lock(&clients_mutex_);
+        if (!message.isEmpty() && client_map_.contains(client->socket_))
+            send_message(client->socket_, *client, message);
+    }
+
+    if (is_skipped && !value_frame_timer_.isActive())
+        value_frame_timer_.start();
+}
+
+QByteArray WebSocket::prepare_values_message(uint32_t scheme_id, const QVector<Log_Value_Item> &pack) const
 {
     QByteArray message;
     QDataStream ds(&message, QIODevice::WriteOnly);
     ds.setVersion(Helpz::Net::Protocol::DATASTREAM_VERSION);
 
-    ds << (uint8_t)WS_DEV_ITEM_VALUES << scheme.id() << (uint32_t)pack.size();
+    ds << (uint8_t)WS_DEV_ITEM_VALUES << scheme_id << (uint32_t)pack.size();
 
     int size = 0;
     for (const Log_Value_Item& item: pack)
@@ -473,12 +675,12 @@ void WebSocket::sendDevice_ItemValues(const Scheme_Info &scheme, const QVector<L
     if (size != pack.size())
     {
         if (!size)
-            return;
+            return {};
 
         ds.device()->seek(1 + 4); // uint8_t + uint32_t
         ds << size;
     }
-    send(scheme, message);
+    return message;
 }
 
 void WebSocket::send_dig_mode_pack(const Scheme_Info &scheme, const QVector<DIG_Mode> &pack)
@@ -660,42 +862,69 @@ QByteArray WebSocket::prepare_connection_state_message(uint32_t scheme_id, uint8
     return message;
 }
 
-void WebSocket::send(const Scheme_Info &scheme, const QByteArray &data) const
+void WebSocket::send_auth_request() const
 {
     QMutexLocker lock(&clients_mutex_);
 
-    qint64 curr_time = QDateTime::currentMSecsSinceEpoch();
+    if (unauthorized_clients_.empty())
+        return;
 
-    for (auto it = client_map_.cbegin(); it != client_map_.cend(); ++it)
+    const qint64 curr_time = QDateTime::currentMSecsSinceEpoch();
+    for (QWebSocket* socket: unauthorized_clients_)
     {
-        if (it.value()->id_ == 0)
-        {
-            if ((curr_time - it.value()->auth_sended_time_) >= 500)
-            {
-                it.value()->auth_sended_time_ = curr_time;
-                it.key()->sendBinaryMessage(QByteArray(1, WS_AUTH));
-            }
-        }
-        else if (scheme.id() == 0 || (it.value()->last_scheme_id_queried_ == scheme.id() && scheme.check_scheme_groups(it.value()->scheme_group_id_set_)))
+        auto it = client_map_.find(socket);
+        if (it != client_map_.cend() && (curr_time - it.value()->auth_sended_time_) >= 500)
         {
-            it.key()->sendBinaryMessage(data);
+            it.value()->auth_sended_time_ = curr_time;
+            socket->sendBinaryMessage(QByteArray(1, WS_AUTH));
         }
     }
 }
 
-void WebSocket::send_to_client(std::shared_ptr<Websocket_Client> client, const QByteArray& data) const
+void WebSocket::send_message(QWebSocket* socket, Websocket_Client& client, const QByteArray& data) const
+{
+    client.pending_bytes_ += socket->sendBinaryMessage(data);
+}
+
+void WebSocket::send(const Scheme_Info &scheme, const QByteArray &data) const
 {
+    send_auth_request();
+
     QMutexLocker lock(&clients_mutex_);
 
-    for (auto it = client_map_.cbegin(); it != client_map_.cend(); ++it)
+    if (scheme.id() == 0)
     {
-        if (it.value() == client)
-        {
-            it.key()->sendBinaryMessage(data);
-            return;
-        }
+        for (auto it = client_map_.cbegin(); it != client_map_.cend(); ++it)
+            if (it.value()->id_ != 0)
+                send_message(it.key(), *it.value(), data);
+        return;
+    }
+
+    auto sc_it = scheme_clients_.find(scheme.id());
+    if (sc_it == scheme_clients_.cend())
+        return;
+
+    // QByteArray is shared, so message is serialized once for all sockets
+    for (QWebSocket* socket: sc_it->second)
+    {
+        auto it = client_map_.find(socket);
+        if (it != client_map_.cend() && it.value()->id_ != 0
+            && scheme.check_scheme_groups(it.value()->scheme_group_id_set_))
+            send_message(socket, *it.value(), data);
     }
 }
 
+void WebSocket::send_to_client(std::shared_ptr<Websocket_Client> client, const QByteArray& data) const
+{
+    if (!client || !client->socket_)
+        return;
+
+    QMutexLocker lock(&clients_mutex_);
+
+    auto it = client_map_.find(client->socket_);
+    if (it != client_map_.cend() && it.value() == client)
+        it.key()->sendBinaryMessage(data);
+}
+
 } // namespace Net
 } // namespace Das
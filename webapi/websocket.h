@@ -2,12 +2,14 @@
 #define DAS_NETWORK_WEBSOCKET_H
 
 #include <set>
+#include <map>
 
 #include <QtWebSockets/QWebSocketServer>
 #include <QLoggingCategory>
 #include <QSslError>
 #include <QJsonValue>
 #include <QMutex>
+#include <QTimer>
 
 #include <Das/device_item.h>
 #include <Das/param/paramgroup.h>
@@ -35,10 +37,18 @@ struct Websocket_Client
 //        bool isStaff = false;
 
     uint32_t id_ = 0, last_scheme_id_queried_ = 0;
+    QWebSocket* socket_ = nullptr;
 //        uint32_t group_id = 0;
     std::set<uint32_t> scheme_group_id_set_;
     mutable qint64 auth_sended_time_ = 0;
 
+    // Size of sended messages which is not written to socket yet
+    qint64 pending_bytes_ = 0;
+
+    // Latest values which isn't sent while socket buffer is full
+    Scheme_Info skipped_scheme_;
+    std::map<uint32_t, Log_Value_Item> skipped_values_;
+
 //        std::vector<uint32_t> accepted;
 //        bool operator ==(const WebClient& other) const { return sock == other.sock; }
 };
@@ -49,6 +59,7 @@ class WebSocket : public QObject
 public:
     explicit WebSocket(std::shared_ptr<JWT_Helper> jwt_helper, const QString &address, quint16 port,
                        const QString &certFilePath = QString(), const QString &keyFilePath = QString(),
+                       int value_frame_interval_ms = 0, qint64 max_pending_bytes = 0,
                        QObject *parent = nullptr);
     ~WebSocket();
 
@@ -90,9 +101,19 @@ private slots:
     void processBinaryMessage(const QByteArray &message);
     void onSslErrors(const QList<QSslError> &errors);
     void socketDisconnected();
+    void socket_bytes_written(qint64 bytes);
+    void send_value_frames();
 
 private:
     bool auth(const QByteArray& token, Websocket_Client& client);
+    void set_client_scheme(QWebSocket* socket, Websocket_Client& client, uint32_t scheme_id);
+
+    void add_to_value_buffer(const Scheme_Info& scheme, const QVector<Log_Value_Item>& pack);
+    void send_values(const Scheme_Info& scheme, const QVector<Log_Value_Item>& pack);
+    void send_skipped_values();
+    QByteArray prepare_values_message(uint32_t scheme_id, const QVector<Log_Value_Item>& pack) const;
+    void send_auth_request() const;
+    void send_message(QWebSocket* socket, Websocket_Client& client, const QByteArray& data) const;
 
     bool stream_toggle(uint32_t dev_item_id, bool state, QWebSocket *socket, uint32_t scheme_id);
     void stream_stop(uint32_t scheme_id, uint32_t dev_item_id, uint32_t user_id = 0);
@@ -109,8 +130,26 @@ private:
 
     std::map<Stream_Item, std::set<QWebSocket*>> client_uses_stream_;
     QMap<QWebSocket*, std::shared_ptr<Websocket_Client>> client_map_;
+
+    // Index of clients by last queried scheme, so scheme message is sent only to its viewers
+    std::map<uint32_t, std::set<QWebSocket*>> scheme_clients_;
+    std::set<QWebSocket*> unauthorized_clients_;
     mutable QMutex clients_mutex_;
 
+    // Values is collected for frame interval and only latest value of item is sent,
+    // except values which must be saved to log.
+    struct Value_Buffer
+    {
+        Scheme_Info scheme_;
+        QVector<Log_Value_Item> pack_;
+        std::map<uint32_t, int> replaceable_pos_map_;
+    };
+
+    std::map<uint32_t, Value_Buffer> value_buffer_map_;
+    QTimer value_frame_timer_;
+    int value_frame_interval_ms_;
+    qint64 max_pending_bytes_;
+
     std::shared_ptr<JWT_Helper> jwt_helper_;
 };
 
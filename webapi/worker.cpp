@@ -6,6 +6,7 @@
 #include <botan-2/botan/tls_server.h>
 #include <botan-2/botan/tls_callbacks.h>
 
+#include <QCoreApplication>
 #include <QDir>
 
 #include <Helpz/dtls_server.h>
@@ -14,9 +15,11 @@
 #include <Helpz/dtls_tools.h>
 
 //--------
+#include <Das/blob_store.h>
 #include <plus/das/jwt_helper.h>
 
 #include "rest/rest.h"
+#include "rest/auth_cache.h"
 
 #include "dbus_handler.h"
 #include "worker.h"
@@ -45,6 +48,8 @@ Worker::Worker(QObject *parent) :
 
 Worker::~Worker()
 {
+    auth_cache_timer_.stop();
+
     delete stream_server_;
     delete restful_;
 
@@ -131,7 +136,9 @@ void Worker::init_websocket_manager(QSettings* s)
                 Helpz::Param{"Address", QString()},
                 Helpz::Param<quint16>{"Port", 25589},
                 Helpz::Param{"CertPath", QString()},
-                Helpz::Param{"KeyPath", QString()});
+                Helpz::Param{"KeyPath", QString()},
+                Helpz::Param{"ValueFrameIntervalMs", 250},
+                Helpz::Param<qint64>{"MaxPendingBytes", 1024 * 1024});
     websock_th_->start();
 //    connect(websock_th_->ptr(), &Net::WebSocket::closed, []() {});
     connect(websock_th_->ptr(), &Net::WebSocket::stream_stoped, [this](uint32_t scheme_id, uint32_t dev_item_id) {
@@ -159,6 +166,31 @@ void Worker::init_restful(QSettings* s)
         Helpz::Param<std::string>{"BasePath", ""}
     ).obj<Rest::Config>();
 
+    auto [blob_path] = Helpz::SettingsHelper(
+        s, "Blob",
+        Helpz::Param<QString>{"Path", QString()} // Empty path disables blob store
+    )();
+    Blob_Store::instance().set_path(blob_path);
+
+    auto [auth_cache_seconds, auth_cache_check_seconds] = Helpz::SettingsHelper(
+        s, "Rest",
+        Helpz::Param{"AuthCacheSeconds", 60},
+        Helpz::Param{"AuthCacheCheckSeconds", 10} // How often permission tables is checked for changes
+    )();
+    Rest::Auth_Cache::instance().set_max_age(std::chrono::seconds{auth_cache_seconds});
+
+    if (auth_cache_seconds > 0 && auth_cache_check_seconds > 0)
+    {
+        connect(&auth_cache_timer_, &QTimer::timeout, this, [this]()
+        {
+            db_pending_thread_->add([](Helpz::DB::Base* db)
+            {
+                Rest::Auth_Cache::instance().check_version(*db);
+            });
+        });
+        auth_cache_timer_.start(std::chrono::seconds{auth_cache_check_seconds});
+    }
+
     restful_ = new Rest::Restful{dbus_, jwt_helper_, rest_config};
 }
 
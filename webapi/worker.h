@@ -52,7 +52,7 @@ private:
     DBus::Interface* dbus_;
     friend class Dbus_Handler;
 
-    using Websocket_Thread = Helpz::SettingsThreadHelper<Net::WebSocket, std::shared_ptr<JWT_Helper>, QString, quint16, QString, QString>;
+    using Websocket_Thread = Helpz::SettingsThreadHelper<Net::WebSocket, std::shared_ptr<JWT_Helper>, QString, quint16, QString, QString, int, qint64>;
     Websocket_Thread::Type* websock_th_;
 
     using WebCommandThread = Helpz::ParamThread<Net::WebCommand, Net::WebSocket*>;
@@ -63,6 +63,8 @@ private:
     std::shared_ptr<JWT_Helper> jwt_helper_;
 
     Stream_Server_Thread* stream_server_;
+
+    QTimer auth_cache_timer_;
 };
 
 typedef Helpz::Service::Impl<Worker> Service;